@@ -20,16 +20,26 @@
 
 #include <assert.h>
 #include <boost/program_options.hpp>
+#include <chrono>
 #include <filesystem>
 #include <iostream>
-#include <map>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// Each stream is assembled into bytes as the input is read, so the full token list is never held in memory. All that
+// is kept on the side are the places where a label is defined or referenced, so references can be filled in once the
+// position of every stream is known.
+
 enum TokenType : int8_t
 {
     TOK_LABEL,
@@ -39,22 +49,38 @@ enum TokenType : int8_t
     TOK_U32
 };
 
+// Only recorded with --debug, to print an annotated listing of the output
+struct DebugToken
+{
+    TokenType type;
+    uint32_t offset;
+    uint32_t value;
+    std::string comment;
+};
+
 struct Stream
 {
     std::string name;
-    std::vector<TokenType> tokenTypes;
-    std::vector<uint32_t> tokenValues;
-    std::vector<std::string> tokenComments;
+    std::vector<uint8_t> data;
+    // (offset in stream, label index)
+    std::vector<std::pair<uint32_t, int>> labelDefs;
+    std::vector<std::pair<uint32_t, int>> refs;
+    // What the stream's start position must be modulo 4 (or 2), for its u32 (or u16) values to be aligned
+    int phase4 = -1, phase2 = -1;
+    std::vector<DebugToken> debugTokens;
 };
 
+bool debug = false;
+bool bigEndian;
+
 Stream stringStream;
 std::vector<Stream> streams;
-std::map<std::string, int> streamIndex;
+std::unordered_map<std::string, int> streamIndex;
 std::vector<int> streamStack;
 
 std::vector<int> labels;
 std::vector<std::string> labelNames;
-std::map<std::string, int> labelIndex;
+std::unordered_map<std::string, int> labelIndex;
 
 std::vector<std::string> preText, postText;
 
@@ -67,14 +93,137 @@ const char *skipWhitespace(const char *p)
     return p;
 }
 
+int getLabel(const std::string &label)
+{
+    auto found = labelIndex.emplace(label, int(labels.size()));
+    if (found.second) {
+        if (debug)
+            labelNames.push_back(label);
+        labels.push_back(-1);
+    }
+    return found.first->second;
+}
+
+void writeValue(uint8_t *p, uint32_t value, int numBytes)
+{
+    for (int i = 0; i < numBytes; i++) {
+        int shift = 8 * (bigEndian ? (numBytes - 1 - i) : i);
+        p[i] = uint8_t(value >> shift);
+    }
+}
+
+void checkAlignment(int &phase, uint32_t offset, int align)
+{
+    int required = (align - int(offset % align)) % align;
+    assert(phase == -1 || phase == required);
+    phase = required;
+}
+
+void addToken(Stream &s, TokenType type, uint32_t value, const char *comment)
+{
+    uint32_t offset = s.data.size();
+    switch (type) {
+    case TOK_LABEL:
+        s.labelDefs.emplace_back(offset, int(value));
+        break;
+    case TOK_REF:
+        s.refs.emplace_back(offset, int(value));
+        s.data.resize(offset + 4);
+        break;
+    case TOK_U8:
+        s.data.push_back(uint8_t(value));
+        break;
+    case TOK_U16:
+        checkAlignment(s.phase2, offset, 2);
+        s.data.resize(offset + 2);
+        writeValue(&s.data[offset], value, 2);
+        break;
+    case TOK_U32:
+        checkAlignment(s.phase4, offset, 4);
+        s.data.resize(offset + 4);
+        writeValue(&s.data[offset], value, 4);
+        break;
+    default:
+        assert(0);
+    }
+    if (debug)
+        s.debugTokens.push_back(DebugToken{type, offset, value, comment});
+}
+
+void printDebugToken(const DebugToken &t, uint32_t start, const std::vector<uint8_t> &data)
+{
+    int numBytes = (t.type == TOK_LABEL) ? 0 : (t.type == TOK_U8) ? 1 : (t.type == TOK_U16) ? 2 : 4;
+    uint32_t pos = start + t.offset;
+    printf("%08x ", pos);
+    for (int k = 0; k < numBytes; k++)
+        printf("%02x ", data[pos + k]);
+    for (int k = numBytes; k < 4; k++)
+        printf("   ");
+
+    unsigned long long v = t.value;
+    const char *c = t.comment.c_str();
+    bool noComment = t.comment.empty();
+
+    switch (t.type) {
+    case TOK_LABEL:
+        if (noComment)
+            printf("label %s\n", labelNames[v].c_str());
+        else
+            printf("label %-24s %s\n", labelNames[v].c_str(), c);
+        break;
+    case TOK_REF:
+        if (noComment)
+            printf("ref %s\n", labelNames[v].c_str());
+        else
+            printf("ref %-26s %s\n", labelNames[v].c_str(), c);
+        break;
+    case TOK_U8:
+        if (noComment)
+            printf("u8 %llu\n", v);
+        else
+            printf("u8 %-27llu %s\n", v, c);
+        break;
+    case TOK_U16:
+        if (noComment)
+            printf("u16 %-26llu\n", v);
+        else
+            printf("u16 %-26llu %s\n", v, c);
+        break;
+    case TOK_U32:
+        if (noComment)
+            printf("u32 %-26llu\n", v);
+        else
+            printf("u32 %-26llu %s\n", v, c);
+        break;
+    default:
+        assert(0);
+    }
+}
+
+// Peak resident memory of this process in MB, or -1 where that isn't available
+double peakMemoryMB()
+{
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#ifdef __APPLE__
+    return double(usage.ru_maxrss) / (1024 * 1024);
+#else
+    return double(usage.ru_maxrss) / 1024;
+#endif
+#else
+    return -1;
+#endif
+}
+
 int main(int argc, char **argv)
 {
-    bool debug = false;
     bool verbose = false;
-    bool bigEndian;
     bool writeC = false;
     bool writeE = false;
-    char buffer[512];
+    char buffer[4096];
+    auto startTime = std::chrono::steady_clock::now();
 
     namespace po = boost::program_options;
     po::positional_options_description pos;
@@ -135,13 +284,14 @@ int main(int argc, char **argv)
         exit(-1);
     }
 
-    FILE *fileIn = fopen(files.at(0).c_str(), "rt");
+    // "-" reads from standard input, so a generator can be piped straight in without writing a .bba file first
+    FILE *fileIn = (files.at(0) == "-") ? stdin : fopen(files.at(0).c_str(), "rt");
     assert(fileIn != nullptr);
 
     FILE *fileOut = fopen(files.at(1).c_str(), writeC ? "wt" : "wb");
     assert(fileOut != nullptr);
 
-    while (fgets(buffer, 512, fileIn) != nullptr) {
+    while (fgets(buffer, sizeof(buffer), fileIn) != nullptr) {
         std::string cmd = strtok(buffer, " \t\r\n");
 
         if (cmd == "pre") {
@@ -158,12 +308,12 @@ int main(int argc, char **argv)
 
         if (cmd == "push") {
             const char *p = strtok(nullptr, " \t\r\n");
-            if (streamIndex.count(p) == 0) {
-                streamIndex[p] = streams.size();
+            auto found = streamIndex.emplace(p, int(streams.size()));
+            if (found.second) {
                 streams.resize(streams.size() + 1);
                 streams.back().name = p;
             }
-            streamStack.push_back(streamIndex.at(p));
+            streamStack.push_back(found.first->second);
             continue;
         }
 
@@ -176,16 +326,7 @@ int main(int argc, char **argv)
             const char *label = strtok(nullptr, " \t\r\n");
             const char *comment = skipWhitespace(strtok(nullptr, "\r\n"));
             Stream &s = streams.at(streamStack.back());
-            if (labelIndex.count(label) == 0) {
-                labelIndex[label] = labels.size();
-                if (debug)
-                    labelNames.push_back(label);
-                labels.push_back(-1);
-            }
-            s.tokenTypes.push_back(cmd == "label" ? TOK_LABEL : TOK_REF);
-            s.tokenValues.push_back(labelIndex.at(label));
-            if (debug)
-                s.tokenComments.push_back(comment);
+            addToken(s, cmd == "label" ? TOK_LABEL : TOK_REF, getLabel(label), comment);
             continue;
         }
 
@@ -193,10 +334,7 @@ int main(int argc, char **argv)
             const char *value = strtok(nullptr, " \t\r\n");
             const char *comment = skipWhitespace(strtok(nullptr, "\r\n"));
             Stream &s = streams.at(streamStack.back());
-            s.tokenTypes.push_back(cmd == "u8" ? TOK_U8 : cmd == "u16" ? TOK_U16 : TOK_U32);
-            s.tokenValues.push_back(atoll(value));
-            if (debug)
-                s.tokenComments.push_back(comment);
+            addToken(s, cmd == "u8" ? TOK_U8 : cmd == "u16" ? TOK_U16 : TOK_U32, atoll(value), comment);
             continue;
         }
 
@@ -208,30 +346,14 @@ int main(int argc, char **argv)
             *end = 0;
             value += 1;
             const char *comment = skipWhitespace(strtok(end + 1, "\r\n"));
-            std::string label = std::string("str:") + value;
-            Stream &s = streams.at(streamStack.back());
-            if (labelIndex.count(label) == 0) {
-                labelIndex[label] = labels.size();
-                if (debug)
-                    labelNames.push_back(label);
-                labels.push_back(-1);
-            }
-            s.tokenTypes.push_back(TOK_REF);
-            s.tokenValues.push_back(labelIndex.at(label));
-            if (debug)
-                s.tokenComments.push_back(comment);
-            stringStream.tokenTypes.push_back(TOK_LABEL);
-            stringStream.tokenValues.push_back(labelIndex.at(label));
-            stringStream.tokenComments.push_back("");
+            int label = getLabel(std::string("str:") + value);
+            addToken(streams.at(streamStack.back()), TOK_REF, label, comment);
+            addToken(stringStream, TOK_LABEL, label, "");
             while (1) {
-                stringStream.tokenTypes.push_back(TOK_U8);
-                stringStream.tokenValues.push_back(*value);
-                if (debug) {
-                    char char_comment[4] = {'\'', *value, '\'', 0};
-                    if (*value < 32 || *value >= 127)
-                        char_comment[0] = 0;
-                    stringStream.tokenComments.push_back(char_comment);
-                }
+                char char_comment[4] = {'\'', *value, '\'', 0};
+                if (*value < 32 || *value >= 127)
+                    char_comment[0] = 0;
+                addToken(stringStream, TOK_U8, uint8_t(*value), char_comment);
                 if (*value == 0)
                     break;
                 value++;
@@ -242,45 +364,31 @@ int main(int argc, char **argv)
         assert(0);
     }
 
+    if (fileIn != stdin)
+        fclose(fileIn);
+
     if (verbose) {
         printf("Constructed %d streams:\n", int(streams.size()));
         for (auto &s : streams)
-            printf("    stream '%s' with %d tokens\n", s.name.c_str(), int(s.tokenTypes.size()));
+            printf("    stream '%s' with %d bytes\n", s.name.c_str(), int(s.data.size()));
     }
 
     assert(!streams.empty());
     assert(streamStack.empty());
-    streams.push_back(Stream());
+    streams.push_back(std::move(stringStream));
     streams.back().name = "strings";
-    streams.back().tokenTypes.swap(stringStream.tokenTypes);
-    streams.back().tokenValues.swap(stringStream.tokenValues);
-    streams.back().tokenComments.swap(stringStream.tokenComments);
 
-    int cursor = 0;
+    // Lay the streams out one after another, which fixes the position of every label. A label defined more than once
+    // ends up at its last definition
+    std::vector<uint32_t> streamStart;
+    uint32_t cursor = 0;
     for (auto &s : streams) {
-        for (int i = 0; i < int(s.tokenTypes.size()); i++) {
-            switch (s.tokenTypes[i]) {
-            case TOK_LABEL:
-                labels[s.tokenValues[i]] = cursor;
-                break;
-            case TOK_REF:
-                cursor += 4;
-                break;
-            case TOK_U8:
-                cursor += 1;
-                break;
-            case TOK_U16:
-                assert(cursor % 2 == 0);
-                cursor += 2;
-                break;
-            case TOK_U32:
-                assert(cursor % 4 == 0);
-                cursor += 4;
-                break;
-            default:
-                assert(0);
-            }
-        }
+        assert(s.phase4 == -1 || int(cursor % 4) == s.phase4);
+        assert(s.phase2 == -1 || int(cursor % 2) == s.phase2);
+        streamStart.push_back(cursor);
+        for (auto &def : s.labelDefs)
+            labels[def.second] = cursor + def.first;
+        cursor += s.data.size();
     }
 
     if (verbose) {
@@ -288,122 +396,30 @@ int main(int argc, char **argv)
         printf("total data (including strings): %.2f MB\n", double(cursor) / (1024 * 1024));
     }
 
-    std::vector<uint8_t> data(cursor);
-
-    cursor = 0;
-    for (auto &s : streams) {
-        if (debug)
-            printf("-- %s --\n", s.name.c_str());
-
-        for (int i = 0; i < int(s.tokenTypes.size()); i++) {
-            uint32_t value = s.tokenValues[i];
-            int numBytes = 0;
-
-            switch (s.tokenTypes[i]) {
-            case TOK_LABEL:
-                break;
-            case TOK_REF:
-                value = labels[value] - cursor;
-                numBytes = 4;
-                break;
-            case TOK_U8:
-                numBytes = 1;
-                break;
-            case TOK_U16:
-                numBytes = 2;
-                break;
-            case TOK_U32:
-                numBytes = 4;
-                break;
-            default:
-                assert(0);
-            }
-
-            if (bigEndian) {
-                switch (numBytes) {
-                case 4:
-                    data[cursor++] = value >> 24;
-                    data[cursor++] = value >> 16;
-                /* fall-through */
-                case 2:
-                    data[cursor++] = value >> 8;
-                /* fall-through */
-                case 1:
-                    data[cursor++] = value;
-                /* fall-through */
-                case 0:
-                    break;
-                default:
-                    assert(0);
-                }
-            } else {
-                switch (numBytes) {
-                case 4:
-                    data[cursor + 3] = value >> 24;
-                    data[cursor + 2] = value >> 16;
-                /* fall-through */
-                case 2:
-                    data[cursor + 1] = value >> 8;
-                /* fall-through */
-                case 1:
-                    data[cursor] = value;
-                /* fall-through */
-                case 0:
-                    break;
-                default:
-                    assert(0);
-                }
-                cursor += numBytes;
-            }
-
-            if (debug) {
-                printf("%08x ", cursor - numBytes);
-                for (int k = cursor - numBytes; k < cursor; k++)
-                    printf("%02x ", data[k]);
-                for (int k = numBytes; k < 4; k++)
-                    printf("   ");
-
-                unsigned long long v = s.tokenValues[i];
-
-                switch (s.tokenTypes[i]) {
-                case TOK_LABEL:
-                    if (s.tokenComments[i].empty())
-                        printf("label %s\n", labelNames[v].c_str());
-                    else
-                        printf("label %-24s %s\n", labelNames[v].c_str(), s.tokenComments[i].c_str());
-                    break;
-                case TOK_REF:
-                    if (s.tokenComments[i].empty())
-                        printf("ref %s\n", labelNames[v].c_str());
-                    else
-                        printf("ref %-26s %s\n", labelNames[v].c_str(), s.tokenComments[i].c_str());
-                    break;
-                case TOK_U8:
-                    if (s.tokenComments[i].empty())
-                        printf("u8 %llu\n", v);
-                    else
-                        printf("u8 %-27llu %s\n", v, s.tokenComments[i].c_str());
-                    break;
-                case TOK_U16:
-                    if (s.tokenComments[i].empty())
-                        printf("u16 %-26llu\n", v);
-                    else
-                        printf("u16 %-26llu %s\n", v, s.tokenComments[i].c_str());
-                    break;
-                case TOK_U32:
-                    if (s.tokenComments[i].empty())
-                        printf("u32 %-26llu\n", v);
-                    else
-                        printf("u32 %-26llu %s\n", v, s.tokenComments[i].c_str());
-                    break;
-                default:
-                    assert(0);
-                }
+    // Fill in references, which are relative to their own position, and join the streams together. Each stream's
+    // memory is released as soon as it has been copied over
+    std::vector<uint8_t> data;
+    data.reserve(cursor);
+    for (int i = 0; i < int(streams.size()); i++) {
+        Stream &s = streams[i];
+        uint32_t start = streamStart[i];
+        for (auto &ref : s.refs) {
+            if (labels[ref.second] == -1) {
+                printf("Undefined label referenced from stream '%s'\n", s.name.c_str());
+                exit(-1);
             }
+            writeValue(&s.data[ref.first], uint32_t(labels[ref.second]) - (start + ref.first), 4);
+        }
+        data.insert(data.end(), s.data.begin(), s.data.end());
+        std::vector<uint8_t>().swap(s.data);
+        if (debug) {
+            printf("-- %s --\n", s.name.c_str());
+            for (auto &t : s.debugTokens)
+                printDebugToken(t, start, data);
         }
     }
 
-    assert(cursor == int(data.size()));
+    assert(data.size() == cursor);
 
     if (writeC) {
         for (auto &s : preText)
@@ -460,6 +476,17 @@ int main(int argc, char **argv)
     } else {
         fwrite(data.data(), int(data.size()), 1, fileOut);
     }
+    fclose(fileOut);
+
+    if (verbose) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        double peakMB = peakMemoryMB();
+        if (peakMB >= 0)
+            printf("bbasm: wrote %.2f MB in %.2fs, peak memory %.1f MB\n", double(data.size()) / (1024 * 1024),
+                   elapsed, peakMB);
+        else
+            printf("bbasm: wrote %.2f MB in %.2fs\n", double(data.size()) / (1024 * 1024), elapsed);
+    }
 
     return 0;
 }
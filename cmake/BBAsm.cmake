@@ -110,6 +110,9 @@ endfunction()
 #       MODE    binary
 #   )
 #
+# In `binary` and `resource` modes, an INPUT ending in `.bin` is taken to be already assembled (for example by
+# `Chip.write_bin` in himbaechel_dbgen) and is copied as is, without running bbasm.
+#
 # Paths must be absolute.
 #
 function(add_bba_compile_command)
@@ -123,18 +126,36 @@ function(add_bba_compile_command)
 
     if (arg_MODE STREQUAL "binary" OR arg_MODE STREQUAL "resource")
 
-        add_custom_command(
-            OUTPUT
-                ${CMAKE_CURRENT_BINARY_DIR}/${arg_OUTPUT_NAME}
-            COMMAND
-                bbasm ${BBASM_ENDIAN_FLAG}
-                ${arg_INPUT}
-                ${CMAKE_CURRENT_BINARY_DIR}/${arg_OUTPUT_NAME}
-            DEPENDS
-                bbasm
-                ${arg_INPUT}
-            VERBATIM
-        )
+        if (arg_INPUT MATCHES "\\.bin$")
+
+            add_custom_command(
+                OUTPUT
+                    ${CMAKE_CURRENT_BINARY_DIR}/${arg_OUTPUT_NAME}
+                COMMAND
+                    ${CMAKE_COMMAND} -E copy
+                    ${arg_INPUT}
+                    ${CMAKE_CURRENT_BINARY_DIR}/${arg_OUTPUT_NAME}
+                DEPENDS
+                    ${arg_INPUT}
+                VERBATIM
+            )
+
+        else()
+
+            add_custom_command(
+                OUTPUT
+                    ${CMAKE_CURRENT_BINARY_DIR}/${arg_OUTPUT_NAME}
+                COMMAND
+                    bbasm ${BBASM_ENDIAN_FLAG}
+                    ${arg_INPUT}
+                    ${CMAKE_CURRENT_BINARY_DIR}/${arg_OUTPUT_NAME}
+                DEPENDS
+                    bbasm
+                    ${arg_INPUT}
+                VERBATIM
+            )
+
+        endif()
 
         if (arg_MODE STREQUAL "resource")
 
@@ -66,6 +66,8 @@ template <typename R> struct ArchAPI : BaseCtx
     virtual PortType getBelPinType(BelId bel, IdString pin) const = 0;
     virtual typename R::BelPinsRangeT getBelPins(BelId bel) const = 0;
     virtual typename R::CellBelPinRangeT getBelPinsForCellPin(const CellInfo *cell_info, IdString pin) const = 0;
+    virtual int getBelIndexCount() const = 0;
+    virtual int getBelIndex(BelId bel) const = 0;
     // Wire methods
     virtual typename R::AllWiresRangeT getWires() const = 0;
     virtual WireId getWireByName(IdStringList name) const = 0;
@@ -84,6 +86,8 @@ template <typename R> struct ArchAPI : BaseCtx
     virtual NetInfo *getConflictingWireNet(WireId wire) const = 0;
     virtual DelayQuad getWireDelay(WireId wire) const = 0;
     virtual IdString getWireConstantValue(WireId wire) const = 0;
+    virtual int getWireIndexCount() const = 0;
+    virtual int getWireIndex(WireId wire) const = 0;
     // Pip methods
     virtual typename R::AllPipsRangeT getPips() const = 0;
     virtual PipId getPipByName(IdStringList name) const = 0;
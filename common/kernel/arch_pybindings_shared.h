@@ -12,6 +12,14 @@ readwrite_wrapper<Context, decltype(&Context::top_module), &Context::top_module,
 readonly_wrapper<Context, decltype(&Context::timing_result), &Context::timing_result,
                  wrap_context<TimingResult &>>::def_wrap(ctx_cls, "timing_result");
 
+// Whole-design tables, see get_cell_table in pybindings.h
+ctx_cls.def("getCellTable", get_cell_table, py::arg("names") = false)
+        .def("getNetTable", get_net_table)
+        .def("getNetUserTable", get_net_user_table)
+        .def("getRoutingTable", get_routing_table, py::arg("names") = false)
+        .def("getPortTimingTable", get_port_timing_table)
+        .def("getIdStrings", get_id_strings, py::arg("ids"));
+
 fn_wrapper_0a<Context, decltype(&Context::getNameDelimiter), &Context::getNameDelimiter, pass_through<char>>::def_wrap(
         ctx_cls, "getNameDelimiter");
 
@@ -152,7 +152,7 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void bindBel(BelId bel, CellInfo *cell, PlaceStrength strength) override
     {
         NPNR_ASSERT(bel != BelId());
-        auto &entry = base_bel2cell[bel];
+        auto &entry = bel2cell_entry(bel);
         NPNR_ASSERT(entry == nullptr);
         cell->bel = bel;
         cell->belStrength = strength;
@@ -162,7 +162,7 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void unbindBel(BelId bel) override
     {
         NPNR_ASSERT(bel != BelId());
-        auto &entry = base_bel2cell[bel];
+        auto &entry = bel2cell_entry(bel);
         NPNR_ASSERT(entry != nullptr);
         entry->bel = BelId();
         entry->belStrength = STRENGTH_NONE;
@@ -176,6 +176,8 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual bool checkBelAvail(BelId bel) const override { return getBoundBelCell(bel) == nullptr; };
     virtual CellInfo *getBoundBelCell(BelId bel) const override
     {
+        if (!dense_bel2cell.empty())
+            return (bel == BelId()) ? nullptr : dense_bel2cell[this->getBelIndex(bel)];
         auto fnd = base_bel2cell.find(bel);
         return fnd == base_bel2cell.end() ? nullptr : fnd->second;
     }
@@ -190,6 +192,11 @@ template <typename R> struct BaseArch : ArchAPI<R>
     {
         return return_if_match<std::array<IdString, 1>, typename R::CellBelPinRangeT>({pin});
     }
+    virtual int getBelIndexCount() const override { return 0; }
+    virtual int getBelIndex(BelId /*bel*/) const override
+    {
+        NPNR_ASSERT_FALSE("getBelIndex must be implemented when getBelIndexCount is nonzero!");
+    }
 
     // Wire methods
     virtual IdString getWireType(WireId /*wire*/) const override { return IdString(); }
@@ -202,7 +209,7 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void bindWire(WireId wire, NetInfo *net, PlaceStrength strength) override
     {
         NPNR_ASSERT(wire != WireId());
-        auto &w2n_entry = base_wire2net[wire];
+        auto &w2n_entry = wire2net_entry(wire);
         NPNR_ASSERT(w2n_entry == nullptr);
         net->wires[wire].pip = PipId();
         net->wires[wire].strength = strength;
@@ -212,7 +219,7 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void unbindWire(WireId wire) override
     {
         NPNR_ASSERT(wire != WireId());
-        auto &w2n_entry = base_wire2net[wire];
+        auto &w2n_entry = wire2net_entry(wire);
         NPNR_ASSERT(w2n_entry != nullptr);
 
         auto &net_wires = w2n_entry->wires;
@@ -220,12 +227,14 @@ template <typename R> struct BaseArch : ArchAPI<R>
         NPNR_ASSERT(it != net_wires.end());
 
         auto pip = it->second.pip;
-        if (pip != PipId()) {
-            base_pip2net[pip] = nullptr;
+        if (dense_wire2net.empty()) {
+            if (pip != PipId())
+                base_pip2net[pip] = nullptr;
+        } else {
+            dense_wire2pip[this->getWireIndex(wire)] = PipId();
         }
 
         net_wires.erase(it);
-        base_wire2net[wire] = nullptr;
 
         w2n_entry = nullptr;
         this->refreshUiWire(wire);
@@ -233,12 +242,19 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual bool checkWireAvail(WireId wire) const override { return getBoundWireNet(wire) == nullptr; }
     virtual NetInfo *getBoundWireNet(WireId wire) const override
     {
+        if (!dense_wire2net.empty())
+            return (wire == WireId()) ? nullptr : dense_wire2net[this->getWireIndex(wire)];
         auto fnd = base_wire2net.find(wire);
         return fnd == base_wire2net.end() ? nullptr : fnd->second;
     }
     virtual WireId getConflictingWireWire(WireId wire) const override { return wire; };
     virtual NetInfo *getConflictingWireNet(WireId wire) const override { return getBoundWireNet(wire); }
     virtual IdString getWireConstantValue(WireId /*wire*/) const override { return {}; }
+    virtual int getWireIndexCount() const override { return 0; }
+    virtual int getWireIndex(WireId /*wire*/) const override
+    {
+        NPNR_ASSERT_FALSE("getWireIndex must be implemented when getWireIndexCount is nonzero!");
+    }
 
     // Pip methods
     virtual IdString getPipType(PipId /*pip*/) const override { return IdString(); }
@@ -250,13 +266,17 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void bindPip(PipId pip, NetInfo *net, PlaceStrength strength) override
     {
         NPNR_ASSERT(pip != PipId());
-        auto &p2n_entry = base_pip2net[pip];
-        NPNR_ASSERT(p2n_entry == nullptr);
-        p2n_entry = net;
-
         WireId dst = this->getPipDstWire(pip);
-        auto &w2n_entry = base_wire2net[dst];
+        auto &w2n_entry = wire2net_entry(dst);
         NPNR_ASSERT(w2n_entry == nullptr);
+        if (dense_wire2net.empty()) {
+            auto &p2n_entry = base_pip2net[pip];
+            NPNR_ASSERT(p2n_entry == nullptr);
+            p2n_entry = net;
+        } else {
+            dense_wire2pip[this->getWireIndex(dst)] = pip;
+        }
+
         w2n_entry = net;
         net->wires[dst].pip = pip;
         net->wires[dst].strength = strength;
@@ -264,16 +284,21 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void unbindPip(PipId pip) override
     {
         NPNR_ASSERT(pip != PipId());
-        auto &p2n_entry = base_pip2net[pip];
-        NPNR_ASSERT(p2n_entry != nullptr);
         WireId dst = this->getPipDstWire(pip);
-
-        auto &w2n_entry = base_wire2net[dst];
+        auto &w2n_entry = wire2net_entry(dst);
         NPNR_ASSERT(w2n_entry != nullptr);
-        w2n_entry = nullptr;
+        if (dense_wire2net.empty()) {
+            auto &p2n_entry = base_pip2net[pip];
+            NPNR_ASSERT(p2n_entry != nullptr);
+            p2n_entry = nullptr;
+        } else {
+            auto &w2p_entry = dense_wire2pip[this->getWireIndex(dst)];
+            NPNR_ASSERT(w2p_entry == pip);
+            w2p_entry = PipId();
+        }
 
-        p2n_entry->wires.erase(dst);
-        p2n_entry = nullptr;
+        w2n_entry->wires.erase(dst);
+        w2n_entry = nullptr;
     }
     virtual bool checkPipAvail(PipId pip) const override { return getBoundPipNet(pip) == nullptr; }
     virtual bool checkPipAvailForNet(PipId pip, const NetInfo *net) const override
@@ -283,6 +308,12 @@ template <typename R> struct BaseArch : ArchAPI<R>
     }
     virtual NetInfo *getBoundPipNet(PipId pip) const override
     {
+        if (!dense_wire2net.empty()) {
+            if (pip == PipId())
+                return nullptr;
+            int dst_idx = this->getWireIndex(this->getPipDstWire(pip));
+            return (dense_wire2pip[dst_idx] == pip) ? dense_wire2net[dst_idx] : nullptr;
+        }
         auto fnd = base_pip2net.find(pip);
         return fnd == base_pip2net.end() ? nullptr : fnd->second;
     }
@@ -463,6 +494,34 @@ template <typename R> struct BaseArch : ArchAPI<R>
     dict<WireId, NetInfo *> base_wire2net;
     dict<PipId, NetInfo *> base_pip2net;
 
+    // If the arch provides dense bel and/or wire indices (getBelIndexCount/getWireIndexCount), the dicts above are
+    // replaced by flat arrays; sized on the first bind, once the arch is fully constructed. A pip is bound exactly
+    // when its destination wire is bound through it, so pips are tracked as the driving pip of each wire rather than
+    // needing an index of their own.
+    std::vector<CellInfo *> dense_bel2cell;
+    std::vector<NetInfo *> dense_wire2net;
+    std::vector<PipId> dense_wire2pip;
+    bool dense_bindings_init = false;
+    void init_dense_bindings()
+    {
+        if (dense_bindings_init)
+            return;
+        dense_bel2cell.resize(this->getBelIndexCount(), nullptr);
+        dense_wire2net.resize(this->getWireIndexCount(), nullptr);
+        dense_wire2pip.resize(this->getWireIndexCount());
+        dense_bindings_init = true;
+    }
+    CellInfo *&bel2cell_entry(BelId bel)
+    {
+        init_dense_bindings();
+        return dense_bel2cell.empty() ? base_bel2cell[bel] : dense_bel2cell[this->getBelIndex(bel)];
+    }
+    NetInfo *&wire2net_entry(WireId wire)
+    {
+        init_dense_bindings();
+        return dense_wire2net.empty() ? base_wire2net[wire] : dense_wire2net[this->getWireIndex(wire)];
+    }
+
     // For the default cell/bel bucket implementations
     std::vector<IdString> cell_types;
     std::vector<BelBucketId> bel_buckets;
@@ -193,16 +193,20 @@ void BaseCtx::archInfoToAttributes()
     }
     for (auto &net : getCtx()->nets) {
         auto ni = net.second.get();
-        std::string routing;
+        std::string routing, name;
         bool first = true;
         for (auto &item : ni->wires) {
             if (!first)
-                routing += ";";
-            routing += getCtx()->getWireName(item.first).str(getCtx());
-            routing += ";";
-            if (item.second.pip != PipId())
-                routing += getCtx()->getPipName(item.second.pip).str(getCtx());
-            routing += ";" + std::to_string(item.second.strength);
+                routing += ';';
+            getCtx()->getWireName(item.first).build_str(getCtx(), name);
+            routing += name;
+            routing += ';';
+            if (item.second.pip != PipId()) {
+                getCtx()->getPipName(item.second.pip).build_str(getCtx(), name);
+                routing += name;
+            }
+            routing += ';';
+            routing += std::to_string(item.second.strength);
             first = false;
         }
         ni->attrs[id("ROUTING")] = routing;
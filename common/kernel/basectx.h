@@ -30,6 +30,7 @@
 
 #include "hashlib.h"
 #include "idstring.h"
+#include "idstring_db.h"
 #include "nextpnr_namespaces.h"
 #include "nextpnr_types.h"
 #include "property.h"
@@ -53,8 +54,7 @@ struct BaseCtx
 #endif
 
     // ID String database.
-    mutable std::unordered_map<std::string, int> *idstring_str_to_idx;
-    mutable std::vector<const std::string *> *idstring_idx_to_str;
+    mutable IdStringDb idstring_db;
 
     // Temporary string backing store for logging
     mutable StrRingBuffer log_strs;
@@ -94,19 +94,13 @@ struct BaseCtx
 
     BaseCtx()
     {
-        idstring_str_to_idx = new std::unordered_map<std::string, int>;
-        idstring_idx_to_str = new std::vector<const std::string *>;
         IdString::initialize_add(this, "", 0);
         IdString::initialize_arch(this);
 
         design_loaded = false;
     }
 
-    virtual ~BaseCtx()
-    {
-        delete idstring_str_to_idx;
-        delete idstring_idx_to_str;
-    }
+    virtual ~BaseCtx() {}
 
     // Must be called before performing any mutating changes on the Ctx/Arch.
     void lock(void)
@@ -0,0 +1,768 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2024  The nextpnr Authors.
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+#include "log.h"
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace Checkpoint {
+
+// A checkpoint is a snapshot of the netlist and its placement and routing, for resuming the flow in the same
+// architecture and device with the same build of nextpnr. It isn't meant as an interchange format: values are
+// written in native byte order, and any change to the layout below needs a new version number.
+//
+// Layout:
+//   header: magic, version, byte order marker, delay_t format, arch and chip names
+//   string table: every IdString used by the rest of the file, which then refers to them by index
+//   body: random number generator state, settings and attributes, regions, nets, cells (with ports and placement),
+//         net connectivity, top level ports, net aliases, hierarchy and finally routing
+//
+// Bels, wires and pips are saved by name, so that checkpoints don't depend on the order the arch enumerates them.
+// Arch-specific cell and net data (ArchCellInfo/ArchNetInfo, other than the base cluster fields) isn't saved; it is
+// rebuilt by assignArchInfo, as it is when a placed or routed design is reloaded from JSON.
+
+static const char magic[8] = {'N', 'P', 'N', 'R', 'C', 'K', 'P', 'T'};
+static const uint32_t version = 1;
+static const uint32_t byte_order = 0x01020304;
+
+// hashlib containers iterate over the newest entry first, so they are written oldest first; inserting entries in the
+// order they are read back then recreates the same iteration order, which placement and routing results depend on.
+template <typename T> auto in_insertion_order(const T &container)
+{
+    std::vector<const std::remove_reference_t<decltype(*container.begin())> *> result;
+    result.reserve(container.size());
+    for (auto &entry : container)
+        result.push_back(&entry);
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+struct Writer
+{
+    explicit Writer(const Context *ctx) : ctx(ctx) {};
+    const Context *ctx;
+
+    std::string header, body;
+    // IdString index to string table index, or -1 if not yet used
+    std::vector<int32_t> id_map;
+    std::vector<IdString> strings;
+
+    template <typename T> void raw(std::string &out, T value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be plain data");
+        out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+    template <typename T> void raw(T value) { raw(body, value); }
+    void u8(uint8_t value) { raw(value); }
+    void i32(int32_t value) { raw(value); }
+    void count(size_t value) { raw(int32_t(value)); }
+    void str(std::string &out, std::string_view value)
+    {
+        raw(out, int32_t(value.size()));
+        out.append(value);
+    }
+    void str(std::string_view value) { str(body, value); }
+
+    void id(IdString value)
+    {
+        if (value.index >= int(id_map.size()))
+            id_map.resize(value.index + 1, -1);
+        int32_t &mapped = id_map.at(value.index);
+        if (mapped == -1) {
+            mapped = int32_t(strings.size());
+            strings.push_back(value);
+        }
+        i32(mapped);
+    }
+
+    // An empty list stands for a null bel, wire or pip
+    void id_list(const IdStringList &list)
+    {
+        count(list.size());
+        for (IdString entry : list)
+            id(entry);
+    }
+    void bel(BelId bel) { bel == BelId() ? count(0) : id_list(ctx->getBelName(bel)); }
+    void wire(WireId wire) { wire == WireId() ? count(0) : id_list(ctx->getWireName(wire)); }
+    void pip(PipId pip) { pip == PipId() ? count(0) : id_list(ctx->getPipName(pip)); }
+
+    void prop(const Property &value)
+    {
+        u8(value.is_string);
+        str(value.str);
+    }
+    void props(const dict<IdString, Property> &values)
+    {
+        count(values.size());
+        for (auto entry : in_insertion_order(values)) {
+            id(entry->first);
+            prop(entry->second);
+        }
+    }
+    void id_dict(const dict<IdString, IdString> &values)
+    {
+        count(values.size());
+        for (auto entry : in_insertion_order(values)) {
+            id(entry->first);
+            id(entry->second);
+        }
+    }
+    void delay(const DelayPair &value)
+    {
+        raw(value.min_delay);
+        raw(value.max_delay);
+    }
+    void net_ref(const NetInfo *net) { id(net ? net->name : IdString()); }
+    void port(const PortInfo &value)
+    {
+        id(value.name);
+        u8(value.type);
+        net_ref(value.net);
+        i32(value.user_idx.idx());
+    }
+
+    void write_regions()
+    {
+        count(ctx->region.size());
+        for (auto entry : in_insertion_order(ctx->region)) {
+            const Region *r = entry->second.get();
+            id(entry->first);
+            id(r->name);
+            u8(r->constr_bels);
+            u8(r->constr_wires);
+            u8(r->constr_pips);
+            count(r->bels.size());
+            for (auto b : in_insertion_order(r->bels))
+                bel(*b);
+            count(r->wires.size());
+            for (auto w : in_insertion_order(r->wires))
+                wire(*w);
+            count(r->piplocs.size());
+            for (auto loc : in_insertion_order(r->piplocs)) {
+                i32(loc->x);
+                i32(loc->y);
+                i32(loc->z);
+            }
+        }
+    }
+
+    void write_nets()
+    {
+        count(ctx->nets.size());
+        for (auto entry : in_insertion_order(ctx->nets)) {
+            const NetInfo *ni = entry->second.get();
+            id(ni->name);
+            id(ni->hierpath);
+            i32(ni->udata);
+            id(ni->constant_value);
+            props(ni->attrs);
+            count(ni->aliases.size());
+            for (IdString alias : ni->aliases)
+                id(alias);
+            id(ni->region ? ni->region->name : IdString());
+            u8(bool(ni->clkconstr));
+            if (ni->clkconstr) {
+                delay(ni->clkconstr->high);
+                delay(ni->clkconstr->low);
+                delay(ni->clkconstr->period);
+            }
+        }
+    }
+
+    void write_cells()
+    {
+        count(ctx->cells.size());
+        for (auto entry : in_insertion_order(ctx->cells)) {
+            const CellInfo *ci = entry->second.get();
+            if (ci->isPseudo())
+                log_error("Cell '%s' is a pseudo cell, which can't be saved in a checkpoint.\n", ctx->nameOf(ci));
+            id(ci->name);
+            id(ci->type);
+            id(ci->hierpath);
+            i32(ci->udata);
+            props(ci->attrs);
+            props(ci->params);
+            count(ci->ports.size());
+            for (auto p : in_insertion_order(ci->ports))
+                port(p->second);
+            id(ci->region ? ci->region->name : IdString());
+            bel(ci->bel);
+            u8(ci->belStrength);
+            id(ci->cluster);
+            if constexpr (std::is_base_of<BaseClusterInfo, ArchCellInfo>::value) {
+                count(ci->constr_children.size());
+                for (const CellInfo *child : ci->constr_children)
+                    id(child->name);
+                i32(ci->constr_x);
+                i32(ci->constr_y);
+                i32(ci->constr_z);
+                u8(ci->constr_abs_z);
+            }
+        }
+    }
+
+    void write_connectivity()
+    {
+        for (auto entry : in_insertion_order(ctx->nets)) {
+            const NetInfo *ni = entry->second.get();
+            id(ni->driver.cell ? ni->driver.cell->name : IdString());
+            id(ni->driver.port);
+            // User indices are stored in the ports that refer to them, so the layout of the store, holes and all,
+            // is kept as it is
+            i32(ni->users.capacity());
+            count(ni->users.entries());
+            for (int32_t i = 0; i < ni->users.capacity(); i++) {
+                store_index<PortRef> idx(i);
+                if (!ni->users.count(idx))
+                    continue;
+                i32(i);
+                id(ni->users.at(idx).cell->name);
+                id(ni->users.at(idx).port);
+            }
+        }
+    }
+
+    void write_top_level()
+    {
+        count(ctx->ports.size());
+        for (auto p : in_insertion_order(ctx->ports))
+            port(p->second);
+        count(ctx->port_cells.size());
+        for (auto p : in_insertion_order(ctx->port_cells)) {
+            id(p->first);
+            id(p->second->name);
+        }
+        id_dict(ctx->net_aliases);
+    }
+
+    void write_hierarchy()
+    {
+        id(ctx->top_module);
+        count(ctx->hierarchy.size());
+        for (auto entry : in_insertion_order(ctx->hierarchy)) {
+            const HierarchicalCell &hc = entry->second;
+            id(entry->first);
+            id(hc.name);
+            id(hc.type);
+            id(hc.parent);
+            id(hc.fullpath);
+            id_dict(hc.leaf_cells);
+            id_dict(hc.nets);
+            id_dict(hc.leaf_cells_by_gname);
+            id_dict(hc.nets_by_gname);
+            count(hc.ports.size());
+            for (auto p : in_insertion_order(hc.ports)) {
+                id(p->first);
+                id(p->second.name);
+                u8(p->second.dir);
+                count(p->second.nets.size());
+                for (IdString net : p->second.nets)
+                    id(net);
+                i32(p->second.offset);
+                u8(p->second.upto);
+            }
+            id_dict(hc.hier_cells);
+            props(hc.attrs);
+        }
+    }
+
+    void write_routing()
+    {
+        for (auto entry : in_insertion_order(ctx->nets)) {
+            const NetInfo *ni = entry->second.get();
+            // In the net's own order, so that binding them again recreates it exactly
+            count(ni->wires.size());
+            for (auto w : in_insertion_order(ni->wires)) {
+                wire(w->first);
+                pip(w->second.pip);
+                u8(w->second.strength);
+            }
+        }
+    }
+
+    void write(std::ostream &out)
+    {
+        // So that a resumed flow carries on with the same random sequence as an uninterrupted one
+        raw(ctx->rngstate);
+        props(ctx->settings);
+        props(ctx->attrs);
+        write_regions();
+        write_nets();
+        write_cells();
+        write_connectivity();
+        write_top_level();
+        write_hierarchy();
+        write_routing();
+
+        header.append(magic, sizeof(magic));
+        raw(header, version);
+        raw(header, byte_order);
+        raw(header, uint8_t(sizeof(delay_t)));
+        raw(header, uint8_t(std::is_floating_point<delay_t>::value));
+        str(header, ctx->archId().str(ctx));
+        str(header, ctx->getChipName());
+        raw(header, int32_t(strings.size()));
+        for (IdString s : strings)
+            str(header, s.view(ctx));
+
+        out.write(header.data(), header.size());
+        out.write(body.data(), body.size());
+    }
+};
+
+struct Reader
+{
+    Reader(Context *ctx, const std::string &filename, const char *data, size_t size)
+            : ctx(ctx), filename(filename), ptr(data), end(data + size) {};
+    Context *ctx;
+    std::string filename;
+    const char *ptr, *end;
+    std::vector<IdString> strings;
+
+    [[noreturn]] void corrupt() { log_error("Checkpoint '%s' is truncated or corrupt.\n", filename.c_str()); }
+
+    template <typename T> T raw()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be plain data");
+        if (size_t(end - ptr) < sizeof(T))
+            corrupt();
+        T value;
+        std::memcpy(&value, ptr, sizeof(T));
+        ptr += sizeof(T);
+        return value;
+    }
+    uint8_t u8() { return raw<uint8_t>(); }
+    bool flag() { return raw<uint8_t>() != 0; }
+    int32_t i32() { return raw<int32_t>(); }
+    // Every counted item takes at least one byte, which catches nonsensical counts before they are used to allocate
+    int32_t count()
+    {
+        int32_t value = i32();
+        if (value < 0 || value > end - ptr)
+            corrupt();
+        return value;
+    }
+    std::string str()
+    {
+        int32_t len = count();
+        std::string value(ptr, len);
+        ptr += len;
+        return value;
+    }
+
+    IdString id()
+    {
+        int32_t index = i32();
+        if (index < 0 || index >= int32_t(strings.size()))
+            corrupt();
+        return strings.at(index);
+    }
+
+    IdStringList id_list()
+    {
+        size_t size = count();
+        IdStringList list(size);
+        for (size_t i = 0; i < size; i++)
+            list.ids[i] = id();
+        return list;
+    }
+
+    BelId bel()
+    {
+        IdStringList name = id_list();
+        if (name.size() == 0)
+            return BelId();
+        BelId b = ctx->getBelByName(name);
+        if (b == BelId())
+            log_error("Bel '%s' from checkpoint '%s' doesn't exist.\n", name.str(ctx).c_str(), filename.c_str());
+        return b;
+    }
+    WireId wire()
+    {
+        IdStringList name = id_list();
+        if (name.size() == 0)
+            return WireId();
+        WireId w = ctx->getWireByName(name);
+        if (w == WireId())
+            log_error("Wire '%s' from checkpoint '%s' doesn't exist.\n", name.str(ctx).c_str(), filename.c_str());
+        return w;
+    }
+    PipId pip()
+    {
+        IdStringList name = id_list();
+        if (name.size() == 0)
+            return PipId();
+        PipId p = ctx->getPipByName(name);
+        if (p == PipId())
+            log_error("Pip '%s' from checkpoint '%s' doesn't exist.\n", name.str(ctx).c_str(), filename.c_str());
+        return p;
+    }
+
+    Property prop()
+    {
+        Property value;
+        value.is_string = flag();
+        value.str = str();
+        if (!value.is_string)
+            value.update_intval();
+        return value;
+    }
+    void props(dict<IdString, Property> &values)
+    {
+        int32_t n = count();
+        for (int32_t i = 0; i < n; i++) {
+            IdString key = id();
+            values[key] = prop();
+        }
+    }
+    void id_dict(dict<IdString, IdString> &values)
+    {
+        int32_t n = count();
+        for (int32_t i = 0; i < n; i++) {
+            IdString key = id();
+            values[key] = id();
+        }
+    }
+    DelayPair delay()
+    {
+        delay_t min_delay = raw<delay_t>();
+        delay_t max_delay = raw<delay_t>();
+        return DelayPair(min_delay, max_delay);
+    }
+
+    NetInfo *net_ref()
+    {
+        IdString name = id();
+        if (name == IdString())
+            return nullptr;
+        auto found = ctx->nets.find(name);
+        if (found == ctx->nets.end())
+            corrupt();
+        return found->second.get();
+    }
+    CellInfo *cell_ref()
+    {
+        IdString name = id();
+        if (name == IdString())
+            return nullptr;
+        auto found = ctx->cells.find(name);
+        if (found == ctx->cells.end())
+            corrupt();
+        return found->second.get();
+    }
+    Region *region_ref()
+    {
+        IdString name = id();
+        if (name == IdString())
+            return nullptr;
+        auto found = ctx->region.find(name);
+        if (found == ctx->region.end())
+            corrupt();
+        return found->second.get();
+    }
+    PortInfo port()
+    {
+        PortInfo value;
+        value.name = id();
+        value.type = PortType(u8());
+        value.net = net_ref();
+        value.user_idx = store_index<PortRef>(i32());
+        return value;
+    }
+
+    void read_header()
+    {
+        if (size_t(end - ptr) < sizeof(magic) || std::memcmp(ptr, magic, sizeof(magic)) != 0)
+            log_error("File '%s' is not a nextpnr checkpoint.\n", filename.c_str());
+        ptr += sizeof(magic);
+        uint32_t file_version = raw<uint32_t>();
+        if (file_version != version)
+            log_error("Checkpoint '%s' is version %u, but this build of nextpnr only reads version %u.\n",
+                      filename.c_str(), file_version, version);
+        if (raw<uint32_t>() != byte_order || u8() != sizeof(delay_t) ||
+            flag() != std::is_floating_point<delay_t>::value)
+            log_error("Checkpoint '%s' was written on an incompatible platform.\n", filename.c_str());
+        std::string arch = str(), chip = str();
+        if (arch != ctx->archId().str(ctx) || chip != ctx->getChipName())
+            log_error("Checkpoint '%s' is for %s device '%s', not %s device '%s'.\n", filename.c_str(), arch.c_str(),
+                      chip.c_str(), ctx->archId().c_str(ctx), ctx->getChipName().c_str());
+        int32_t n = count();
+        strings.reserve(n);
+        for (int32_t i = 0; i < n; i++)
+            strings.push_back(ctx->id(str()));
+    }
+
+    void read_regions()
+    {
+        int32_t n = count();
+        for (int32_t i = 0; i < n; i++) {
+            IdString key = id();
+            auto r = std::make_unique<Region>();
+            r->name = id();
+            r->constr_bels = flag();
+            r->constr_wires = flag();
+            r->constr_pips = flag();
+            int32_t n_bels = count();
+            for (int32_t j = 0; j < n_bels; j++)
+                r->bels.insert(bel());
+            int32_t n_wires = count();
+            for (int32_t j = 0; j < n_wires; j++)
+                r->wires.insert(wire());
+            int32_t n_locs = count();
+            for (int32_t j = 0; j < n_locs; j++) {
+                Loc loc;
+                loc.x = i32();
+                loc.y = i32();
+                loc.z = i32();
+                r->piplocs.insert(loc);
+            }
+            ctx->region[key] = std::move(r);
+        }
+    }
+
+    std::vector<NetInfo *> read_nets()
+    {
+        std::vector<NetInfo *> nets;
+        int32_t n = count();
+        nets.reserve(n);
+        for (int32_t i = 0; i < n; i++) {
+            IdString name = id();
+            auto ni = std::make_unique<NetInfo>(name);
+            ni->hierpath = id();
+            ni->udata = i32();
+            ni->constant_value = id();
+            props(ni->attrs);
+            int32_t n_aliases = count();
+            for (int32_t j = 0; j < n_aliases; j++)
+                ni->aliases.push_back(id());
+            ni->region = region_ref();
+            if (flag()) {
+                ni->clkconstr = std::make_unique<ClockConstraint>();
+                ni->clkconstr->high = delay();
+                ni->clkconstr->low = delay();
+                ni->clkconstr->period = delay();
+            }
+            nets.push_back(ni.get());
+            ctx->nets[name] = std::move(ni);
+        }
+        return nets;
+    }
+
+    std::vector<std::pair<CellInfo *, BelId>> read_cells()
+    {
+        std::vector<std::pair<CellInfo *, BelId>> placement;
+        // Cluster children may come before their parent, so they are resolved once all cells exist
+        std::vector<std::pair<CellInfo *, std::vector<IdString>>> cluster_children;
+        int32_t n = count();
+        for (int32_t i = 0; i < n; i++) {
+            IdString name = id();
+            IdString type = id();
+            auto ci = std::make_unique<CellInfo>(ctx, name, type);
+            ci->hierpath = id();
+            ci->udata = i32();
+            props(ci->attrs);
+            props(ci->params);
+            int32_t n_ports = count();
+            for (int32_t j = 0; j < n_ports; j++) {
+                PortInfo p = port();
+                ci->ports[p.name] = p;
+            }
+            ci->region = region_ref();
+            BelId b = bel();
+            ci->belStrength = PlaceStrength(u8());
+            if (b != BelId())
+                placement.emplace_back(ci.get(), b);
+            ci->cluster = id();
+            if constexpr (std::is_base_of<BaseClusterInfo, ArchCellInfo>::value) {
+                int32_t n_children = count();
+                std::vector<IdString> children;
+                for (int32_t j = 0; j < n_children; j++)
+                    children.push_back(id());
+                if (!children.empty())
+                    cluster_children.emplace_back(ci.get(), std::move(children));
+                ci->constr_x = i32();
+                ci->constr_y = i32();
+                ci->constr_z = i32();
+                ci->constr_abs_z = flag();
+            }
+            ctx->cells[name] = std::move(ci);
+        }
+        if constexpr (std::is_base_of<BaseClusterInfo, ArchCellInfo>::value) {
+            for (auto &entry : cluster_children) {
+                for (IdString child : entry.second) {
+                    auto found = ctx->cells.find(child);
+                    if (found == ctx->cells.end())
+                        corrupt();
+                    entry.first->constr_children.push_back(found->second.get());
+                }
+            }
+        }
+        return placement;
+    }
+
+    void read_connectivity(const std::vector<NetInfo *> &nets)
+    {
+        for (NetInfo *ni : nets) {
+            ni->driver.cell = cell_ref();
+            ni->driver.port = id();
+            int32_t capacity = count();
+            int32_t entries = count();
+            std::vector<PortRef> slots(capacity);
+            std::vector<bool> used(capacity, false);
+            for (int32_t i = 0; i < entries; i++) {
+                int32_t slot = i32();
+                if (slot < 0 || slot >= capacity)
+                    corrupt();
+                slots.at(slot).cell = cell_ref();
+                slots.at(slot).port = id();
+                used.at(slot) = true;
+            }
+            ni->users.reserve(capacity);
+            for (auto &usr : slots)
+                ni->users.add(usr);
+            for (int32_t i = capacity - 1; i >= 0; i--)
+                if (!used.at(i))
+                    ni->users.remove(store_index<PortRef>(i));
+        }
+    }
+
+    void read_top_level()
+    {
+        int32_t n_ports = count();
+        for (int32_t i = 0; i < n_ports; i++) {
+            PortInfo p = port();
+            ctx->ports[p.name] = p;
+        }
+        int32_t n_port_cells = count();
+        for (int32_t i = 0; i < n_port_cells; i++) {
+            IdString name = id();
+            ctx->port_cells[name] = cell_ref();
+        }
+        id_dict(ctx->net_aliases);
+    }
+
+    void read_hierarchy()
+    {
+        ctx->top_module = id();
+        int32_t n = count();
+        for (int32_t i = 0; i < n; i++) {
+            IdString key = id();
+            HierarchicalCell &hc = ctx->hierarchy[key];
+            hc.name = id();
+            hc.type = id();
+            hc.parent = id();
+            hc.fullpath = id();
+            id_dict(hc.leaf_cells);
+            id_dict(hc.nets);
+            id_dict(hc.leaf_cells_by_gname);
+            id_dict(hc.nets_by_gname);
+            int32_t n_ports = count();
+            for (int32_t j = 0; j < n_ports; j++) {
+                IdString port_key = id();
+                HierarchicalPort &p = hc.ports[port_key];
+                p.name = id();
+                p.dir = PortType(u8());
+                int32_t n_nets = count();
+                for (int32_t k = 0; k < n_nets; k++)
+                    p.nets.push_back(id());
+                p.offset = i32();
+                p.upto = flag();
+            }
+            id_dict(hc.hier_cells);
+            props(hc.attrs);
+        }
+    }
+
+    void read_routing(const std::vector<NetInfo *> &nets)
+    {
+        for (NetInfo *ni : nets) {
+            int32_t n = count();
+            for (int32_t i = 0; i < n; i++) {
+                WireId w = wire();
+                PipId p = pip();
+                PlaceStrength strength = PlaceStrength(u8());
+                if (p == PipId())
+                    ctx->bindWire(w, ni, strength);
+                else
+                    ctx->bindPip(p, ni, strength);
+            }
+        }
+    }
+
+    void read()
+    {
+        read_header();
+        ctx->rngstate = raw<uint64_t>();
+        // Settings from the checkpoint take precedence, as they do when loading JSON, but are kept in the order they
+        // were saved in
+        dict<IdString, Property> settings;
+        props(settings);
+        for (auto entry : in_insertion_order(ctx->settings))
+            if (!settings.count(entry->first))
+                settings[entry->first] = entry->second;
+        ctx->settings = std::move(settings);
+        props(ctx->attrs);
+        read_regions();
+        auto nets = read_nets();
+        auto placement = read_cells();
+        read_connectivity(nets);
+        read_top_level();
+        read_hierarchy();
+        for (auto &entry : placement)
+            ctx->bindBel(entry.second, entry.first, entry.first->belStrength);
+        read_routing(nets);
+        if (ptr != end)
+            corrupt();
+    }
+};
+
+} // namespace Checkpoint
+
+bool Context::writeCheckpoint(const std::string &filename) const
+{
+    std::ofstream out(filename, std::ios::binary);
+    if (!out)
+        log_error("Failed to open checkpoint '%s' for writing.\n", filename.c_str());
+    Checkpoint::Writer(this).write(out);
+    return bool(out);
+}
+
+void Context::loadCheckpoint(const std::string &filename)
+{
+    if (!cells.empty() || !nets.empty())
+        log_error("Can't load checkpoint '%s' as a design is already loaded.\n", filename.c_str());
+    boost::iostreams::mapped_file_source file;
+    try {
+        file.open(filename);
+    } catch (...) {
+        log_error("Failed to open checkpoint '%s'.\n", filename.c_str());
+    }
+    Checkpoint::Reader(this, filename, file.data(), file.size()).read();
+    assignArchInfo();
+    design_loaded = true;
+}
+
+NEXTPNR_NAMESPACE_END
@@ -341,7 +341,12 @@ po::options_description CommandHandler::getGeneralOptions()
 
 #endif
     general.add_options()("json", po::value<std::string>(), "JSON design file to ingest");
-    general.add_options()("write", po::value<std::string>(), "JSON design file to write");
+    general.add_options()("write", po::value<std::string>(), "JSON design file to write (gzipped if named *.gz)");
+    general.add_options()("save-checkpoint", po::value<std::string>(),
+                          "binary checkpoint of the design, placement and routing to write at the end of the flow");
+    general.add_options()("load-checkpoint", po::value<std::string>(),
+                          "binary checkpoint to resume from instead of a JSON design, skipping the stages it has "
+                          "already been through");
     general.add_options()("top", po::value<std::string>(), "name of top module");
     general.add_options()("seed", po::value<uint64_t>(), "seed value for random number generator");
     general.add_options()("randomize-seed,r", "randomize seed value for random number generator");
@@ -361,6 +366,9 @@ po::options_description CommandHandler::getGeneralOptions()
     general.add_options()("slack_redist_iter", po::value<int>(), "number of iterations between slack redistribution");
     general.add_options()("cstrweight", po::value<float>(), "placer weighting for relative constraint satisfaction");
     general.add_options()("starttemp", po::value<float>(), "placer SA start temperature");
+    general.add_options()("placer1-threads", po::value<int>(),
+                          "number of threads for SA placer annealing; more than 1 gives a different, typically slightly "
+                          "longer wirelength placement");
 
     general.add_options()("pack-only", "pack design only without placement or routing");
     general.add_options()("no-route", "process design without routing");
@@ -390,6 +398,8 @@ po::options_description CommandHandler::getGeneralOptions()
     general.add_options()("placer-heap-cell-placement-timeout", po::value<int>(),
                           "allow placer to attempt up to max(10000, total cells^2 / N) iterations to place a cell (int "
                           "N, default: 8, 0 for no timeout)");
+    general.add_options()("placer-heap-solver", po::value<std::string>(),
+                          "placer heap equation solver: pcg or eigen (default: pcg)");
 
     general.add_options()("static-dump-density", "write density csv files during placer-static flow");
 
@@ -399,6 +409,8 @@ po::options_description CommandHandler::getGeneralOptions()
 
     general.add_options()("router2-heatmap", po::value<std::string>(),
                           "prefix for router2 resource congestion heatmaps");
+    general.add_options()("router2-queue", po::value<std::string>(),
+                          "router2 search priority queue: heap or radix (default: heap)");
 
     general.add_options()("tmg-ripup", "enable experimental timing-driven ripup in router");
     general.add_options()("router2-tmg-ripup",
@@ -409,6 +421,7 @@ po::options_description CommandHandler::getGeneralOptions()
     general.add_options()("report", po::value<std::string>(),
                           "write timing and utilization report in JSON format to file");
     general.add_options()("detailed-timing-report", "Append detailed net timing data to the JSON report");
+    general.add_options()("report-memory", "log a breakdown of design memory usage after loading and at the end");
 
     general.add_options()("placed-svg", po::value<std::string>(), "write render of placement to SVG file");
     general.add_options()("routed-svg", po::value<std::string>(), "write render of routing to SVG file");
@@ -510,6 +523,9 @@ void CommandHandler::setupContext(Context *ctx)
     if (vm.count("starttemp")) {
         ctx->settings[ctx->id("placer1/startTemp")] = std::to_string(vm["starttemp"].as<float>());
     }
+    if (vm.count("placer1-threads")) {
+        ctx->settings[ctx->id("placer1/threads")] = std::to_string(vm["placer1-threads"].as<int>());
+    }
 
     if (vm.count("freq")) {
         auto freq = vm["freq"].as<double>();
@@ -536,11 +552,16 @@ void CommandHandler::setupContext(Context *ctx)
         ctx->settings[ctx->id("placerHeap/cellPlacementTimeout")] =
                 std::to_string(std::max(0, vm["placer-heap-cell-placement-timeout"].as<int>()));
 
+    if (vm.count("placer-heap-solver"))
+        ctx->settings[ctx->id("placerHeap/solver")] = vm["placer-heap-solver"].as<std::string>();
+
     if (vm.count("parallel-refine"))
         ctx->settings[ctx->id("placerHeap/parallelRefine")] = true;
 
     if (vm.count("router2-heatmap"))
         ctx->settings[ctx->id("router2/heatmap")] = vm["router2-heatmap"].as<std::string>();
+    if (vm.count("router2-queue"))
+        ctx->settings[ctx->id("router2/queue")] = vm["router2-queue"].as<std::string>();
     if (vm.count("tmg-ripup") || vm.count("router2-tmg-ripup"))
         ctx->settings[ctx->id("router/tmg_ripup")] = true;
 
@@ -599,13 +620,14 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
 
 #ifndef NO_GUI
     if (vm.count("gui")) {
+        if (vm.count("load-checkpoint"))
+            log_error("--load-checkpoint is not supported with --gui.\n");
         Application a(argc, argv, (vm.count("gui-no-aa") > 0));
         MainWindow w(std::move(ctx), this);
         try {
             if (vm.count("json")) {
                 std::string filename = vm["json"].as<std::string>();
-                std::ifstream f(filename);
-                if (!parse_json(f, filename, w.getContext()))
+                if (!parse_json(filename, w.getContext()))
                     log_error("Loading design failed.\n");
 
                 if (vm.count("sdc")) {
@@ -630,8 +652,7 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
 #endif
     if (vm.count("json")) {
         std::string filename = vm["json"].as<std::string>();
-        std::ifstream f(filename);
-        if (!parse_json(f, filename, ctx.get()))
+        if (!parse_json(filename, ctx.get()))
             log_error("Loading design failed.\n");
 
         if (vm.count("sdc")) {
@@ -643,6 +664,24 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
         customAfterLoad(ctx.get());
     }
 
+    if (vm.count("load-checkpoint")) {
+        if (vm.count("json"))
+            log_error("--json and --load-checkpoint can't be used together.\n");
+        std::string filename = vm["load-checkpoint"].as<std::string>();
+        ctx->loadCheckpoint(filename);
+
+        if (vm.count("sdc")) {
+            std::string sdc_filename = vm["sdc"].as<std::string>();
+            std::ifstream sdc_stream(sdc_filename);
+            ctx->read_sdc(sdc_stream);
+        }
+
+        customAfterLoad(ctx.get());
+    }
+
+    if (vm.count("report-memory") && ctx->design_loaded)
+        ctx->logMemoryUsage();
+
 #ifndef NO_PYTHON
     init_python(argv[0]);
     python_export_global("ctx", *ctx);
@@ -655,9 +694,13 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
     } else
 #endif
             if (ctx->design_loaded) {
-        bool do_pack = vm.count("pack-only") != 0 || vm.count("no-pack") == 0;
-        bool do_place = vm.count("pack-only") == 0 && vm.count("no-place") == 0;
-        bool do_route = vm.count("pack-only") == 0 && vm.count("no-route") == 0;
+        // Stages a checkpoint has already been through aren't run again
+        auto resumed_after = [&](const char *stage) {
+            return vm.count("load-checkpoint") && ctx->settings.count(ctx->id(stage));
+        };
+        bool do_pack = (vm.count("pack-only") != 0 || vm.count("no-pack") == 0) && !resumed_after("pack");
+        bool do_place = vm.count("pack-only") == 0 && vm.count("no-place") == 0 && !resumed_after("place");
+        bool do_route = vm.count("pack-only") == 0 && vm.count("no-route") == 0 && !resumed_after("route");
 
         if (do_pack) {
             run_script_hook("pre-pack");
@@ -698,11 +741,16 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
 
     if (vm.count("write")) {
         std::string filename = vm["write"].as<std::string>();
-        std::ofstream f(filename);
-        if (!write_json_file(f, filename, ctx.get()))
+        if (!write_json_file(filename, ctx.get()))
             log_error("Saving design failed.\n");
     }
 
+    if (vm.count("save-checkpoint")) {
+        std::string filename = vm["save-checkpoint"].as<std::string>();
+        if (!ctx->writeCheckpoint(filename))
+            log_error("Saving checkpoint failed.\n");
+    }
+
     if (vm.count("sdf")) {
         std::string filename = vm["sdf"].as<std::string>();
         std::ofstream f(filename);
@@ -719,6 +767,9 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
         ctx->writeJsonReport(f);
     }
 
+    if (vm.count("report-memory"))
+        ctx->logMemoryUsage();
+
 #ifndef NO_PYTHON
     deinit_python();
 #endif
@@ -772,11 +823,8 @@ void CommandHandler::load_json(Context *ctx, std::string filename)
 {
     setupContext(ctx);
     setupArchContext(ctx);
-    {
-        std::ifstream f(filename);
-        if (!parse_json(f, filename, ctx))
-            log_error("Loading design failed.\n");
-    }
+    if (!parse_json(filename, ctx))
+        log_error("Loading design failed.\n");
 }
 
 void CommandHandler::clear() { vm.clear(); }
@@ -19,6 +19,8 @@
 
 #include "context.h"
 
+#include <algorithm>
+
 #include "log.h"
 #include "nextpnr_namespaces.h"
 #include "util.h"
@@ -71,6 +73,28 @@ SSOArray<WireId, 2> Context::getNetinfoSinkWires(const NetInfo *net_info, const
     return result;
 }
 
+const std::vector<BelId> &Context::getBelsForCellType(IdString cell_type) const
+{
+    std::lock_guard<std::mutex> lock(cell_type_bels_mutex);
+    auto &bels = cell_type_bels[cell_type];
+    if (!bels) {
+        bels = std::make_unique<std::vector<BelId>>();
+        for (auto bel : getBels())
+            if (isValidBelForCellType(cell_type, bel))
+                bels->push_back(bel);
+    }
+    return *bels;
+}
+
+int Context::getThreadCount() const { return std::max(1, int_or_default(settings, id("threads"), default_threads)); }
+
+ThreadPool &Context::getThreadPool() const
+{
+    // Passes that are already running on several threads may get here at the same time
+    std::call_once(thread_pool_once, [&]() { thread_pool = std::make_unique<ThreadPool>(getThreadCount()); });
+    return *thread_pool;
+}
+
 size_t Context::getNetinfoSinkWireCount(const NetInfo *net_info, const PortRef &sink) const
 {
     size_t count = 0;
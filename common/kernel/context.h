@@ -22,9 +22,12 @@
 #define CONTEXT_H
 
 #include <boost/lexical_cast.hpp>
+#include <memory>
+#include <mutex>
 
 #include "arch.h"
 #include "deterministic_rng.h"
+#include "thread_pool.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -41,6 +44,11 @@ struct Context : Arch, DeterministicRNG
 
     ArchArgs arch_args;
 
+    mutable dict<IdString, std::unique_ptr<std::vector<BelId>>> cell_type_bels;
+    mutable std::mutex cell_type_bels_mutex;
+    mutable std::unique_ptr<ThreadPool> thread_pool;
+    mutable std::once_flag thread_pool_once;
+
     Context(ArchArgs args) : Arch(args)
     {
         BaseCtx::as_ctx = this;
@@ -58,6 +66,19 @@ struct Context : Arch, DeterministicRNG
     size_t getNetinfoSinkWireCount(const NetInfo *net_info, const PortRef &sink) const;
     WireId getNetinfoSinkWire(const NetInfo *net_info, const PortRef &sink, size_t phys_idx) const;
     delay_t getNetinfoRouteDelay(const NetInfo *net_info, const PortRef &sink) const;
+
+    // All bels that isValidBelForCellType accepts for a cell type, regardless of whether they are bound. This is
+    // worked out with a single pass over the bels the first time a cell type is queried, and then shared by all
+    // placers and legalisers for the rest of the flow.
+    const std::vector<BelId> &getBelsForCellType(IdString cell_type) const;
+
+    // How many threads multithreaded passes should use: the "threads" setting (--threads), or default_threads. This
+    // doesn't write the default into the settings, so it isn't saved with the design either.
+    static constexpr int default_threads = 4;
+    int getThreadCount() const;
+    // The worker threads shared by all multithreaded passes, getThreadCount() of them, created on first use. Passes
+    // should run their parallel work on this rather than starting threads of their own.
+    ThreadPool &getThreadPool() const;
     DelayQuad getNetinfoRouteDelayQuad(const NetInfo *net_info, const PortRef &sink) const;
 
     // provided by router1.cc
@@ -101,6 +122,13 @@ struct Context : Arch, DeterministicRNG
 
     // provided by report.cc
     void writeJsonReport(std::ostream &out) const;
+    // A breakdown of the memory taken by the design, for --report-memory
+    void logMemoryUsage() const;
+
+    // provided by checkpoint.cc
+    // A binary snapshot of the design, placement and routing, to resume the flow from with the same build and device
+    bool writeCheckpoint(const std::string &filename) const;
+    void loadCheckpoint(const std::string &filename);
 
     // provided by timing_log.cc
     void log_timing_results(TimingResult &result, bool print_histogram, bool print_fmax, bool print_path,
@@ -664,6 +664,8 @@ template <typename K, typename T, typename OPS> class dict
     }
 
     void reserve(size_t n) { entries.reserve(n); }
+    // Bytes allocated by the container itself, not counting anything owned by the keys and values
+    size_t heap_usage() const { return entries.capacity() * sizeof(entry_t) + hashtable.capacity() * sizeof(int); }
     size_t size() const { return entries.size(); }
     bool empty() const { return entries.empty(); }
     void clear()
@@ -1033,6 +1035,8 @@ template <typename K, typename OPS> class pool
     }
 
     void reserve(size_t n) { entries.reserve(n); }
+    // Bytes allocated by the container itself, not counting anything owned by the keys and values
+    size_t heap_usage() const { return entries.capacity() * sizeof(entry_t) + hashtable.capacity() * sizeof(int); }
     size_t size() const { return entries.size(); }
     bool empty() const { return entries.empty(); }
     void clear()
@@ -22,6 +22,7 @@
 #define IDSTRING_H
 
 #include <string>
+#include <string_view>
 #include "nextpnr_namespaces.h"
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -39,13 +40,16 @@ struct IdString
     constexpr IdString() : index(0) {}
     explicit constexpr IdString(int index) : index(index) {}
 
-    void set(const BaseCtx *ctx, const std::string &s);
+    void set(const BaseCtx *ctx, std::string_view s);
 
     IdString(const BaseCtx *ctx, const std::string &s) { set(ctx, s); }
 
     IdString(const BaseCtx *ctx, const char *s) { set(ctx, s); }
 
-    const std::string &str(const BaseCtx *ctx) const;
+    std::string str(const BaseCtx *ctx) const;
+
+    // Borrows the interned characters, which live as long as the context; prefer this to str() on hot paths.
+    std::string_view view(const BaseCtx *ctx) const;
 
     const char *c_str(const BaseCtx *ctx) const;
 
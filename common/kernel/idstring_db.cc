@@ -0,0 +1,206 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2024  The nextpnr Authors.
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "idstring_db.h"
+
+#include <algorithm>
+
+NEXTPNR_NAMESPACE_BEGIN
+
+IdStringDb::Table::Table(uint32_t size) : mask(size - 1), slots(new std::atomic<uint64_t>[size])
+{
+    for (uint32_t i = 0; i < size; i++)
+        slots[i].store(0, std::memory_order_relaxed);
+}
+
+IdStringDb::IdStringDb() : shards(new Shard[1 << shard_bits])
+{
+    for (auto &chunk : chunks)
+        chunk.store(nullptr, std::memory_order_relaxed);
+    for (int i = 0; i < (1 << shard_bits); i++) {
+        auto &shard = shards[i];
+        shard.tables.push_back(std::make_unique<Table>(initial_table_size));
+        shard.table.store(shard.tables.back().get(), std::memory_order_release);
+    }
+}
+
+IdStringDb::~IdStringDb()
+{
+    for (auto &chunk : chunks)
+        delete[] chunk.load(std::memory_order_relaxed);
+}
+
+size_t IdStringDb::memory_usage() const
+{
+    size_t bytes = 0;
+    for (auto &chunk : chunks)
+        if (chunk.load(std::memory_order_acquire) != nullptr)
+            bytes += chunk_size * sizeof(std::string_view);
+    {
+        std::lock_guard<std::mutex> lock(arena_mutex);
+        bytes += arena_bytes;
+    }
+    for (int i = 0; i < (1 << shard_bits); i++) {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        for (auto &table : shards[i].tables)
+            bytes += (table->mask + 1) * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+uint64_t IdStringDb::hash(std::string_view s)
+{
+    // FNV-1a, followed by the MurmurHash3 finaliser as both the shard and the table position come from it
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (char c : s) {
+        h ^= uint8_t(c);
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+int IdStringDb::find_in(const Table *table, std::string_view s, uint32_t h) const
+{
+    for (uint32_t i = h & table->mask;; i = (i + 1) & table->mask) {
+        uint64_t slot = table->slots[i].load(std::memory_order_acquire);
+        if (slot == 0)
+            return -1;
+        if (uint32_t(slot >> 32) == h) {
+            int index = int(uint32_t(slot)) - 1;
+            if (view(index) == s)
+                return index;
+        }
+    }
+}
+
+void IdStringDb::place(Table &table, uint64_t slot)
+{
+    uint32_t i = uint32_t(slot >> 32) & table.mask;
+    while (table.slots[i].load(std::memory_order_relaxed) != 0)
+        i = (i + 1) & table.mask;
+    table.slots[i].store(slot, std::memory_order_release);
+}
+
+std::string_view IdStringDb::store(std::string_view s)
+{
+    std::lock_guard<std::mutex> lock(arena_mutex);
+    size_t needed = s.size() + 1;
+    char *dest;
+    if (needed > arena_block_size / 4) {
+        // Very long strings get a block of their own, rather than wasting the rest of the current one
+        arena_blocks.emplace_back(new char[needed]);
+        arena_bytes += needed;
+        dest = arena_blocks.back().get();
+    } else {
+        if (needed > arena_left) {
+            arena_blocks.emplace_back(new char[arena_block_size]);
+            arena_bytes += arena_block_size;
+            arena_next = arena_blocks.back().get();
+            arena_left = arena_block_size;
+        }
+        dest = arena_next;
+        arena_next += needed;
+        arena_left -= needed;
+    }
+    std::copy(s.begin(), s.end(), dest);
+    dest[s.size()] = '\0';
+    return std::string_view(dest, s.size());
+}
+
+std::string_view &IdStringDb::slot_for_index(int index)
+{
+    int chunk_idx = index >> chunk_bits;
+    NPNR_ASSERT(chunk_idx < max_chunks);
+    std::string_view *chunk = chunks[chunk_idx].load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+        // Threads adding to different shards can race to create the same chunk
+        auto fresh = std::make_unique<std::string_view[]>(chunk_size);
+        if (chunks[chunk_idx].compare_exchange_strong(chunk, fresh.get(), std::memory_order_acq_rel))
+            chunk = fresh.release();
+    }
+    return chunk[index & (chunk_size - 1)];
+}
+
+int IdStringDb::insert(Shard &shard, std::string_view s, uint32_t h)
+{
+    // Called with the shard locked
+    int index = next_index.fetch_add(1, std::memory_order_acq_rel);
+    NPNR_ASSERT(index >= 0);
+    slot_for_index(index) = store(s);
+
+    Table *table = shard.table.load(std::memory_order_relaxed);
+    if (4 * (shard.entries + 1) > 3 * (table->mask + 1)) {
+        auto bigger = std::make_unique<Table>(2 * (table->mask + 1));
+        for (uint32_t i = 0; i <= table->mask; i++) {
+            uint64_t slot = table->slots[i].load(std::memory_order_relaxed);
+            if (slot != 0)
+                place(*bigger, slot);
+        }
+        table = bigger.get();
+        shard.tables.push_back(std::move(bigger));
+        shard.table.store(table, std::memory_order_release);
+    }
+    // Publishing the slot is what makes the string visible to other threads, so it must come after the string is
+    // written
+    place(*table, (uint64_t(h) << 32) | uint64_t(uint32_t(index) + 1));
+    ++shard.entries;
+    return index;
+}
+
+int IdStringDb::intern(std::string_view s)
+{
+    uint64_t h = hash(s);
+    Shard &shard = shard_for(h);
+    int found = find_in(shard.table.load(std::memory_order_acquire), s, uint32_t(h));
+    if (found != -1)
+        return found;
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // Another thread may have added it, or grown the table, since the lock-free lookup
+    found = find_in(shard.table.load(std::memory_order_relaxed), s, uint32_t(h));
+    if (found != -1)
+        return found;
+    return insert(shard, s, uint32_t(h));
+}
+
+int IdStringDb::find(std::string_view s) const
+{
+    uint64_t h = hash(s);
+    Shard &shard = shard_for(h);
+    int found = find_in(shard.table.load(std::memory_order_acquire), s, uint32_t(h));
+    if (found != -1)
+        return found;
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return find_in(shard.table.load(std::memory_order_relaxed), s, uint32_t(h));
+}
+
+void IdStringDb::add(std::string_view s, int expected_index)
+{
+    uint64_t h = hash(s);
+    Shard &shard = shard_for(h);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    NPNR_ASSERT(find_in(shard.table.load(std::memory_order_relaxed), s, uint32_t(h)) == -1);
+    NPNR_ASSERT(insert(shard, s, uint32_t(h)) == expected_index);
+}
+
+NEXTPNR_NAMESPACE_END
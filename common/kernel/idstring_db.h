@@ -0,0 +1,124 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2024  The nextpnr Authors.
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef IDSTRING_DB_H
+#define IDSTRING_DB_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nextpnr_assertions.h"
+#include "nextpnr_namespaces.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// The table behind IdString, mapping strings to dense integer indices and back.
+//
+// The characters of each string are bump-allocated, with a terminating NUL, from large blocks that are never freed or
+// moved, and the table from index to string is an array of string_views in fixed-size chunks. So a name costs little
+// more than its own length, and finding one by index is a shift and a mask. Going from a string to its index uses one
+// of a fixed number of shards, picked by the string's hash, each of which is an open-addressed table of (hash, index)
+// pairs. Looking up a string that already exists takes no locks, and adding a new one only locks its shard, so
+// ctx->id() may be called from any thread.
+//
+// The index a new string is given does depend on the order threads get to it, so passes that need deterministic
+// results shouldn't depend on the relative order of IdStrings created in parallel.
+struct IdStringDb
+{
+    IdStringDb();
+    ~IdStringDb();
+
+    IdStringDb(const IdStringDb &) = delete;
+    IdStringDb &operator=(const IdStringDb &) = delete;
+
+    // The index of s, adding it if it is new
+    int intern(std::string_view s);
+    // The index of s, or -1 if it hasn't been added
+    int find(std::string_view s) const;
+    // Add s, which must be new, checking that it gets the expected index (used for the predefined constids)
+    void add(std::string_view s, int expected_index);
+
+    std::string_view view(int index) const
+    {
+        NPNR_ASSERT(index >= 0 && index < size());
+        return chunks[index >> chunk_bits].load(std::memory_order_acquire)[index & (chunk_size - 1)];
+    }
+
+    // Strings are stored NUL terminated, so this is valid for the lifetime of the table
+    const char *c_str(int index) const { return view(index).data(); }
+
+    // The number of strings added so far
+    int size() const { return next_index.load(std::memory_order_acquire); }
+
+    // Bytes allocated for the strings and the tables, for memory reports
+    size_t memory_usage() const;
+
+  private:
+    static constexpr int chunk_bits = 14;
+    static constexpr int chunk_size = 1 << chunk_bits;
+    static constexpr int max_chunks = 1 << 14;
+    static constexpr size_t arena_block_size = 64 * 1024;
+    static constexpr int shard_bits = 6;
+    static constexpr int initial_table_size = 256;
+
+    // Each slot is (hash << 32) | (index + 1), or zero if unused
+    struct Table
+    {
+        explicit Table(uint32_t size);
+        uint32_t mask;
+        std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    };
+
+    struct alignas(64) Shard
+    {
+        std::mutex mutex;
+        std::atomic<Table *> table{nullptr};
+        // All the tables this shard has had: lock-free readers may still be probing an old one after it is grown
+        std::vector<std::unique_ptr<Table>> tables;
+        uint32_t entries = 0;
+    };
+
+    std::atomic<std::string_view *> chunks[max_chunks];
+    std::atomic<int> next_index{0};
+    std::unique_ptr<Shard[]> shards;
+
+    // Strings in different shards are added concurrently, so the character arena has its own lock
+    mutable std::mutex arena_mutex;
+    std::vector<std::unique_ptr<char[]>> arena_blocks;
+    char *arena_next = nullptr;
+    size_t arena_left = 0;
+    size_t arena_bytes = 0;
+
+    static uint64_t hash(std::string_view s);
+    Shard &shard_for(uint64_t h) const { return shards[h >> (64 - shard_bits)]; }
+    int find_in(const Table *table, std::string_view s, uint32_t h) const;
+    static void place(Table &table, uint64_t slot);
+    int insert(Shard &shard, std::string_view s, uint32_t h);
+    std::string_view store(std::string_view s);
+    std::string_view &slot_for_index(int index);
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif /* IDSTRING_DB_H */
@@ -46,7 +46,7 @@ void IdStringList::build_str(const Context *ctx, std::string &str) const
     for (auto entry : ids) {
         if (!first)
             str += delim;
-        str += entry.str(ctx);
+        str += entry.view(ctx);
         first = false;
     }
 }
@@ -154,7 +154,7 @@ template <typename T> class indexed_store
     void reserve(int32_t size) { slots.reserve(size); }
 
     // Check if an index exists
-    int32_t count(store_index<T> idx)
+    int32_t count(store_index<T> idx) const
     {
         if (idx.m_index < 0 || idx.m_index >= int32_t(slots.size()))
             return 0;
@@ -170,6 +170,9 @@ template <typename T> class indexed_store
     // Total size of the container
     int32_t capacity() const { return int32_t(slots.size()); }
 
+    // Bytes allocated by the container itself, not counting anything owned by the items
+    size_t heap_usage() const { return slots.capacity() * sizeof(slot); }
+
     // Iterate over items
     template <typename It, typename S> class enumerated_iterator;
 
@@ -28,6 +28,11 @@
 
 #include "log.h"
 
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#include <sys/resource.h>
+#define NPNR_HAVE_RUSAGE
+#endif
+
 NEXTPNR_NAMESPACE_BEGIN
 
 NPNR_NORETURN void logv_error(const char *format, va_list ap) NPNR_ATTRIBUTE(noreturn);
@@ -209,4 +214,20 @@ void log_flush()
         f.first->flush();
 }
 
+double peak_memory_mib()
+{
+#ifdef NPNR_HAVE_RUSAGE
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0); // bytes
+#else
+    return usage.ru_maxrss / 1024.0; // KiB
+#endif
+#else
+    return -1;
+#endif
+}
+
 NEXTPNR_NAMESPACE_END
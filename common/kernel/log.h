@@ -78,6 +78,9 @@ void log_nonfatal_error(const char *format, ...) NPNR_ATTRIBUTE(format(printf, 1
 void log_break();
 void log_flush();
 
+// Peak resident memory of the process so far, in MiB, or a negative value if unknown
+double peak_memory_mib();
+
 static inline void log_assert_worker(bool cond, const char *expr, const char *file, int line)
 {
     if (!cond)
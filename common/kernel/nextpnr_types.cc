@@ -194,4 +194,37 @@ Loc CellInfo::getLocation() const
     }
 }
 
+namespace {
+// Never destroyed, as a design may be torn down (e.g. by Python) after static destructors have run
+template <typename T> ObjectPool<T> &object_pool()
+{
+    static ObjectPool<T> *pool = new ObjectPool<T>();
+    return *pool;
+}
+} // namespace
+
+void *CellInfo::operator new(size_t size)
+{
+    NPNR_ASSERT(size == sizeof(CellInfo));
+    return object_pool<CellInfo>().allocate();
+}
+void CellInfo::operator delete(void *ptr, size_t size)
+{
+    NPNR_ASSERT(size == sizeof(CellInfo));
+    object_pool<CellInfo>().deallocate(ptr);
+}
+ObjectPoolStats CellInfo::poolStats() { return object_pool<CellInfo>().stats(); }
+
+void *NetInfo::operator new(size_t size)
+{
+    NPNR_ASSERT(size == sizeof(NetInfo));
+    return object_pool<NetInfo>().allocate();
+}
+void NetInfo::operator delete(void *ptr, size_t size)
+{
+    NPNR_ASSERT(size == sizeof(NetInfo));
+    object_pool<NetInfo>().deallocate(ptr);
+}
+ObjectPoolStats NetInfo::poolStats() { return object_pool<NetInfo>().stats(); }
+
 NEXTPNR_NAMESPACE_END
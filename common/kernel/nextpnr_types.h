@@ -32,6 +32,7 @@
 #include "indexed_store.h"
 #include "nextpnr_base_types.h"
 #include "nextpnr_namespaces.h"
+#include "object_pool.h"
 #include "property.h"
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -181,6 +182,11 @@ struct NetInfo : ArchNetInfo
     std::unique_ptr<ClockConstraint> clkconstr;
 
     Region *region = nullptr;
+
+    // Nets are allocated from a shared pool rather than one heap allocation each (see object_pool.h)
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr, size_t size);
+    static ObjectPoolStats poolStats();
 };
 
 enum PortType
@@ -367,6 +373,11 @@ struct CellInfo : ArchCellInfo
     void copyPortTo(IdString port, CellInfo *other, IdString other_port);
     void copyPortBusTo(IdString old_name, int old_offset, bool old_brackets, CellInfo *new_cell, IdString new_name,
                        int new_offset, bool new_brackets, int width);
+
+    // Cells are allocated from a shared pool rather than one heap allocation each (see object_pool.h)
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr, size_t size);
+    static ObjectPoolStats poolStats();
 };
 
 struct ClockConstraint
@@ -0,0 +1,117 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2024  The nextpnr Authors.
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "nextpnr_namespaces.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+struct ObjectPoolStats
+{
+    size_t live = 0;       // objects currently allocated
+    size_t capacity = 0;   // objects that fit in the slabs allocated so far
+    size_t slab_bytes = 0; // memory held by the slabs
+};
+
+// Storage for many objects of one type, handed out from large slabs rather than one heap allocation each. Objects
+// created one after another end up next to each other in memory, so walking a freshly loaded design touches
+// consecutive cache lines instead of jumping around the heap. Freed objects go on a free list and are reused by the
+// next allocation; slabs are never handed back while the pool exists, so memory use stays at the high-water mark. The
+// pools used for cells and nets live for the whole process.
+//
+// This only deals in raw memory, for use by a class's operator new/delete: constructing and destroying the objects is
+// up to the caller. Allocation and freeing are safe to call from multiple threads.
+template <typename T> class ObjectPool
+{
+  public:
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    void *allocate()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++live;
+        if (free_list != nullptr) {
+            Slot *slot = free_list;
+            free_list = slot->next_free;
+            return slot;
+        }
+        if (slabs.empty() || next_in_slab == slab_size) {
+            // Slabs start small, so a small design doesn't pay for a huge one, and grow to a fixed cap
+            slab_size = slabs.empty() ? first_slab_size : std::min(slab_size * 2, max_slab_size);
+            slabs.emplace_back(new Slot[slab_size]);
+            capacity += slab_size;
+            next_in_slab = 0;
+        }
+        return &slabs.back()[next_in_slab++];
+    }
+
+    void deallocate(void *ptr)
+    {
+        if (ptr == nullptr)
+            return;
+        std::lock_guard<std::mutex> lock(mutex);
+        --live;
+        Slot *slot = static_cast<Slot *>(ptr);
+        slot->next_free = free_list;
+        free_list = slot;
+    }
+
+    ObjectPoolStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ObjectPoolStats result;
+        result.live = live;
+        result.capacity = capacity;
+        result.slab_bytes = capacity * sizeof(Slot);
+        return result;
+    }
+
+  private:
+    static constexpr size_t first_slab_size = 64;
+    static constexpr size_t max_slab_size = 4096;
+
+    union Slot
+    {
+        Slot() {}
+        ~Slot() {}
+        Slot *next_free;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    size_t slab_size = 0, next_in_slab = 0;
+    Slot *free_list = nullptr;
+    size_t live = 0, capacity = 0;
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif /* OBJECT_POOL_H */
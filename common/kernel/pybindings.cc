@@ -50,10 +50,9 @@ bool operator==(const PortRef &a, const PortRef &b) { return (a.cell == b.cell)
 // Load a JSON file into a design
 void parse_json_shim(std::string filename, Context &d)
 {
-    std::ifstream inf(filename);
-    if (!inf)
+    if (!std::ifstream(filename))
         throw std::runtime_error("failed to open file " + filename);
-    parse_json(inf, filename, &d);
+    parse_json(filename, &d);
 }
 
 // Create a new Chip and load design from json file
@@ -297,6 +296,8 @@ PYBIND11_EMBEDDED_MODULE(MODULE_NAME, m)
     typedef dict<IdString, ClockFmax> ClockFmaxMap;
     WRAP_MAP(m, ClockFmaxMap, pass_through<ClockFmax>, "ClockFmaxMap");
 
+    wrap_table_column(m);
+
     auto clk_fmax_cls = py::class_<ClockFmax>(m, "ClockFmax")
                                 .def_readonly("achieved", &ClockFmax::achieved)
                                 .def_readonly("constraint", &ClockFmax::constraint);
@@ -22,11 +22,13 @@
 #define COMMON_PYBINDINGS_H
 
 #include <Python.h>
+#include <cstring>
 #include <iostream>
 #include <pybind11/embed.h>
 #include <pybind11/pybind11.h>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 #include "pycontainers.h"
 #include "pywrappers.h"
 
@@ -57,6 +59,41 @@ void deinit_python();
 
 void execute_python_file(const char *python_file);
 
+// One column of the design tables below: a number per row, stored contiguously and readable from Python through the
+// buffer protocol, so that numpy.asarray(col) or memoryview(col) get at it without copying
+struct TableColumn
+{
+    std::vector<uint8_t> data;
+    std::string format; // struct module format character of the elements
+    size_t itemsize = 0;
+    size_t rows = 0;
+
+    template <typename T> static TableColumn from(const std::vector<T> &values)
+    {
+        TableColumn col;
+        col.format = py::format_descriptor<T>::format();
+        col.itemsize = sizeof(T);
+        col.rows = values.size();
+        col.data.resize(sizeof(T) * values.size());
+        if (!values.empty())
+            memcpy(col.data.data(), values.data(), col.data.size());
+        return col;
+    }
+};
+
+void wrap_table_column(py::module &m);
+
+// Whole-design tables for analysis scripts, built in one go instead of walking ctx.cells and ctx.nets one wrapped
+// object at a time. Each is a dict from column name to a TableColumn. Where a column refers to a row of another table
+// it holds that row's index, or -1 for none; names held as an IdString hold its index, which get_id_strings turns
+// back into str. Bel, wire and pip names aren't single IdStrings, so are only included, as lists of str, if asked for.
+py::list get_id_strings(Context *ctx, py::buffer ids);
+py::dict get_cell_table(Context *ctx, bool names);
+py::dict get_net_table(Context *ctx);
+py::dict get_net_user_table(Context *ctx);
+py::dict get_routing_table(Context *ctx, bool names);
+py::dict get_port_timing_table(Context *ctx);
+
 // Defauld IdString conversions
 namespace PythonConversion {
 
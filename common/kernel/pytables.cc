@@ -0,0 +1,300 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2024  The nextpnr Authors.
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef NO_PYTHON
+
+#include <cstring>
+#include <limits>
+
+#include "nextpnr.h"
+#include "pybindings.h"
+#include "timing.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+
+// Row indices of the cell and net tables, which follow the order of ctx->cells and ctx->nets
+struct TableIndex
+{
+    dict<IdString, int> cell_row, net_row;
+
+    explicit TableIndex(const Context *ctx)
+    {
+        cell_row.reserve(ctx->cells.size());
+        for (auto &cell : ctx->cells)
+            cell_row.emplace(cell.first, int(cell_row.size()));
+        net_row.reserve(ctx->nets.size());
+        for (auto &net : ctx->nets)
+            net_row.emplace(net.first, int(net_row.size()));
+    }
+
+    int cell(const CellInfo *ci) const { return ci ? cell_row.at(ci->name) : -1; }
+    int net(const NetInfo *ni) const { return ni ? net_row.at(ni->name) : -1; }
+};
+
+template <typename T> void add_column(py::dict &table, const char *name, const std::vector<T> &values)
+{
+    table[name] = TableColumn::from(values);
+}
+
+// Arch-formatted bel, wire and pip names can't be held as a single IdString, so are only exported on request, as a
+// list of str
+void add_name_column(py::dict &table, const char *name, const std::vector<std::string> &values)
+{
+    py::list list(values.size());
+    for (size_t i = 0; i < values.size(); i++)
+        list[i] = py::str(values[i]);
+    table[name] = list;
+}
+
+// Whether a buffer's struct module format is a signed integer of the given size, allowing a byte order prefix
+bool is_int_format(const std::string &format, size_t itemsize, size_t size)
+{
+    if (itemsize != size || format.empty())
+        return false;
+    char c = format.back();
+    return (format.size() == 1 || (format.size() == 2 && std::strchr("@=<>!", format[0]))) && std::strchr("bhilq", c);
+}
+
+} // namespace
+
+void wrap_table_column(py::module &m)
+{
+    py::class_<TableColumn>(m, "TableColumn", py::buffer_protocol())
+            .def_buffer([](TableColumn &col) {
+                return py::buffer_info(col.data.data(), ssize_t(col.itemsize), col.format, 1, {ssize_t(col.rows)},
+                                       {ssize_t(col.itemsize)}, true);
+            })
+            .def("__len__", [](const TableColumn &col) { return col.rows; })
+            .def_readonly("format", &TableColumn::format);
+}
+
+py::list get_id_strings(Context *ctx, py::buffer ids)
+{
+    py::buffer_info info = ids.request();
+    if (info.ndim != 1)
+        throw py::value_error("expected a one-dimensional buffer of IdString indices");
+    bool is32 = is_int_format(info.format, info.itemsize, 4), is64 = is_int_format(info.format, info.itemsize, 8);
+    if (!is32 && !is64)
+        throw py::value_error("expected a buffer of 32 or 64-bit integers, got format '" + info.format + "'");
+    size_t n = size_t(info.shape.at(0));
+    int count = ctx->idstring_db.size();
+    py::list result(n);
+    const char *ptr = static_cast<const char *>(info.ptr);
+    for (size_t i = 0; i < n; i++, ptr += info.strides.at(0)) {
+        int64_t index;
+        if (is32) {
+            int32_t v;
+            memcpy(&v, ptr, sizeof(v));
+            index = v;
+        } else {
+            memcpy(&index, ptr, sizeof(index));
+        }
+        if (index < 0 || index >= count)
+            throw py::index_error(std::to_string(index) + " is not an IdString index");
+        std::string_view s = IdString(int(index)).view(ctx);
+        result[i] = py::str(s.data(), s.size());
+    }
+    return result;
+}
+
+py::dict get_cell_table(Context *ctx, bool names)
+{
+    size_t n = ctx->cells.size();
+    std::vector<std::string> bel;
+    std::vector<int32_t> name, type, x, y, z, strength;
+    name.reserve(n);
+    type.reserve(n);
+    if (names)
+        bel.reserve(n);
+    x.reserve(n);
+    y.reserve(n);
+    z.reserve(n);
+    strength.reserve(n);
+    for (auto &cell : ctx->cells) {
+        const CellInfo *ci = cell.second.get();
+        name.push_back(ci->name.index);
+        type.push_back(ci->type.index);
+        if (ci->bel != BelId()) {
+            Loc loc = ctx->getBelLocation(ci->bel);
+            if (names)
+                bel.push_back(ctx->getBelName(ci->bel).str(ctx));
+            x.push_back(loc.x);
+            y.push_back(loc.y);
+            z.push_back(loc.z);
+        } else {
+            if (names)
+                bel.emplace_back();
+            x.push_back(-1);
+            y.push_back(-1);
+            z.push_back(-1);
+        }
+        strength.push_back(int32_t(ci->belStrength));
+    }
+
+    py::dict table;
+    add_column(table, "name", name);
+    add_column(table, "type", type);
+    if (names)
+        add_name_column(table, "bel", bel);
+    add_column(table, "x", x);
+    add_column(table, "y", y);
+    add_column(table, "z", z);
+    add_column(table, "bel_strength", strength);
+    return table;
+}
+
+py::dict get_net_table(Context *ctx)
+{
+    TableIndex index(ctx);
+    size_t n = ctx->nets.size();
+    std::vector<int32_t> name, driver_port, driver_cell, users, wires;
+    name.reserve(n);
+    driver_port.reserve(n);
+    driver_cell.reserve(n);
+    users.reserve(n);
+    wires.reserve(n);
+    for (auto &net : ctx->nets) {
+        const NetInfo *ni = net.second.get();
+        name.push_back(ni->name.index);
+        driver_cell.push_back(index.cell(ni->driver.cell));
+        driver_port.push_back(ni->driver.cell ? ni->driver.port.index : IdString().index);
+        users.push_back(int32_t(ni->users.entries()));
+        wires.push_back(int32_t(ni->wires.size()));
+    }
+
+    py::dict table;
+    add_column(table, "name", name);
+    add_column(table, "driver_cell", driver_cell);
+    add_column(table, "driver_port", driver_port);
+    add_column(table, "users", users);
+    add_column(table, "wires", wires);
+    return table;
+}
+
+py::dict get_net_user_table(Context *ctx)
+{
+    TableIndex index(ctx);
+    std::vector<int32_t> net_col, cell, port;
+    std::vector<float> route_delay;
+    for (auto &net : ctx->nets) {
+        const NetInfo *ni = net.second.get();
+        int row = index.net(ni);
+        for (auto &usr : ni->users) {
+            net_col.push_back(row);
+            cell.push_back(index.cell(usr.cell));
+            port.push_back(usr.port.index);
+            // Only meaningful once the net is routed, or with an estimate from the arch for unrouted ones
+            route_delay.push_back(ni->driver.cell ? ctx->getDelayNS(ctx->getNetinfoRouteDelay(ni, usr)) : 0.0f);
+        }
+    }
+
+    py::dict table;
+    add_column(table, "net", net_col);
+    add_column(table, "cell", cell);
+    add_column(table, "port", port);
+    add_column(table, "route_delay", route_delay);
+    return table;
+}
+
+py::dict get_routing_table(Context *ctx, bool names)
+{
+    TableIndex index(ctx);
+    std::vector<std::string> wire, pip;
+    std::vector<int32_t> net_col, x, y, strength;
+    std::vector<float> delay;
+    for (auto &net : ctx->nets) {
+        const NetInfo *ni = net.second.get();
+        int row = index.net(ni);
+        for (auto &w : ni->wires) {
+            net_col.push_back(row);
+            if (names)
+                wire.push_back(ctx->getWireName(w.first).str(ctx));
+            float wire_delay = ctx->getDelayNS(ctx->getWireDelay(w.first).maxDelay());
+            PipId p = w.second.pip;
+            if (p != PipId()) {
+                Loc loc = ctx->getPipLocation(p);
+                if (names)
+                    pip.push_back(ctx->getPipName(p).str(ctx));
+                x.push_back(loc.x);
+                y.push_back(loc.y);
+                delay.push_back(wire_delay + ctx->getDelayNS(ctx->getPipDelay(p).maxDelay()));
+            } else {
+                if (names)
+                    pip.emplace_back();
+                x.push_back(-1);
+                y.push_back(-1);
+                delay.push_back(wire_delay);
+            }
+            strength.push_back(int32_t(w.second.strength));
+        }
+    }
+
+    py::dict table;
+    add_column(table, "net", net_col);
+    if (names) {
+        add_name_column(table, "wire", wire);
+        add_name_column(table, "pip", pip);
+    }
+    add_column(table, "x", x);
+    add_column(table, "y", y);
+    add_column(table, "delay", delay);
+    add_column(table, "strength", strength);
+    return table;
+}
+
+py::dict get_port_timing_table(Context *ctx)
+{
+    TableIndex index(ctx);
+    TimingAnalyser tmg(ctx);
+    tmg.setup();
+
+    std::vector<int32_t> cell, port, net_col;
+    std::vector<float> slack, criticality;
+    for (auto &c : ctx->cells) {
+        const CellInfo *ci = c.second.get();
+        int row = index.cell(ci);
+        for (auto &p : ci->ports) {
+            if (p.second.net == nullptr)
+                continue;
+            CellPortKey key(ci->name, p.first);
+            cell.push_back(row);
+            port.push_back(p.first.index);
+            net_col.push_back(index.net(p.second.net));
+            // Ports on no constrained path have the largest representable slack
+            float s = tmg.get_setup_slack(key);
+            slack.push_back(s >= float(std::numeric_limits<delay_t>::max()) ? std::numeric_limits<float>::quiet_NaN()
+                                                                            : ctx->getDelayNS(delay_t(s)));
+            criticality.push_back(tmg.get_criticality(key));
+        }
+    }
+
+    py::dict table;
+    add_column(table, "cell", cell);
+    add_column(table, "port", port);
+    add_column(table, "net", net_col);
+    add_column(table, "setup_slack", slack);
+    add_column(table, "criticality", criticality);
+    return table;
+}
+
+NEXTPNR_NAMESPACE_END
+
+#endif // NO_PYTHON
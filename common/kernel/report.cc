@@ -18,6 +18,7 @@
  */
 
 #include "json11.hpp"
+#include "log.h"
 #include "nextpnr.h"
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -269,4 +270,67 @@ void Context::writeJsonReport(std::ostream &out) const
     out << Json(jsonRoot).dump() << std::endl;
 }
 
+namespace {
+// Heap memory owned by a string, beyond the object itself (assumes the usual 15 character small string buffer)
+size_t string_heap_usage(const std::string &s) { return s.capacity() > 15 ? s.capacity() + 1 : 0; }
+
+struct MemoryTally
+{
+    size_t count = 0, bytes = 0;
+
+    void add_props(const dict<IdString, Property> &props)
+    {
+        count += props.size();
+        bytes += props.heap_usage();
+        for (auto &prop : props)
+            bytes += string_heap_usage(prop.second.str);
+    }
+
+    template <typename T> void add(const T &container, size_t items)
+    {
+        count += items;
+        bytes += container.heap_usage();
+    }
+};
+
+double mib(size_t bytes) { return bytes / (1024.0 * 1024.0); }
+} // namespace
+
+void Context::logMemoryUsage() const
+{
+    MemoryTally cell_ports, cell_props, net_users, net_props, net_wires;
+    for (auto &cell : cells) {
+        const CellInfo *ci = cell.second.get();
+        cell_ports.add(ci->ports, ci->ports.size());
+        cell_props.add_props(ci->attrs);
+        cell_props.add_props(ci->params);
+    }
+    for (auto &net : nets) {
+        const NetInfo *ni = net.second.get();
+        net_users.add(ni->users, ni->users.entries());
+        net_props.add_props(ni->attrs);
+        net_wires.add(ni->wires, ni->wires.size());
+    }
+    int id_count = idstring_db.size();
+    size_t id_bytes = idstring_db.memory_usage();
+
+    auto cell_pool = CellInfo::poolStats(), net_pool = NetInfo::poolStats();
+    log_info("Memory usage:\n");
+    log_info("    %8zu cells       %8.1f MiB (%zu bytes each, %zu allocated in this process)\n", cells.size(),
+             mib(cell_pool.slab_bytes), sizeof(CellInfo), cell_pool.capacity);
+    log_info("    %8zu cell ports  %8.1f MiB\n", cell_ports.count, mib(cell_ports.bytes));
+    log_info("    %8zu cell props  %8.1f MiB (attributes and parameters)\n", cell_props.count, mib(cell_props.bytes));
+    log_info("    %8zu nets        %8.1f MiB (%zu bytes each, %zu allocated in this process)\n", nets.size(),
+             mib(net_pool.slab_bytes), sizeof(NetInfo), net_pool.capacity);
+    log_info("    %8zu net users   %8.1f MiB\n", net_users.count, mib(net_users.bytes));
+    log_info("    %8zu net attrs   %8.1f MiB\n", net_props.count, mib(net_props.bytes));
+    log_info("    %8zu net wires   %8.1f MiB (routing)\n", net_wires.count, mib(net_wires.bytes));
+    log_info("    %8d IdStrings   %8.1f MiB\n", id_count, mib(id_bytes));
+    log_info("    %8s name maps   %8.1f MiB (cells, nets and net aliases by name)\n", "",
+             mib(cells.heap_usage() + nets.heap_usage() + net_aliases.heap_usage()));
+    double peak = peak_memory_mib();
+    if (peak >= 0)
+        log_info("    peak resident memory %.1f MiB\n", peak);
+}
+
 NEXTPNR_NAMESPACE_END
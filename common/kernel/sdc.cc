@@ -42,7 +42,7 @@ struct SdcEntity
     SdcEntity(EntityType type, IdString name) : type(type), name(name) {}
     SdcEntity(EntityType type, IdString name, IdString pin) : type(type), name(name), pin(pin) {}
 
-    const std::string &to_string(Context *ctx) { return name.str(ctx); }
+    std::string to_string(Context *ctx) { return name.str(ctx); }
 
     CellInfo *get_cell(Context *ctx) const
     {
@@ -0,0 +1,225 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2024  The nextpnr Authors.
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "thread_pool.h"
+
+#include <algorithm>
+
+NEXTPNR_NAMESPACE_BEGIN
+
+#ifdef NPNR_DISABLE_THREADS
+
+ThreadPool::ThreadPool(int) : thread_count(1) {}
+ThreadPool::~ThreadPool() {}
+
+ThreadPool::TaskGroup::~TaskGroup() {}
+
+void ThreadPool::TaskGroup::spawn(std::function<void()> task) { task(); }
+void ThreadPool::TaskGroup::wait() {}
+
+void ThreadPool::run(int N, std::function<void(int)> func)
+{
+    for (int i = 0; i < N; i++)
+        func(i);
+}
+
+void ThreadPool::parallel_for(int N, int grain, std::function<void(int, int)> func)
+{
+    if (N > 0)
+        func(0, N);
+}
+
+#else
+
+namespace {
+// The pool and worker index of the current thread, if it is a pool worker
+thread_local const ThreadPool *current_pool = nullptr;
+thread_local int current_worker = 0;
+} // namespace
+
+ThreadPool::ThreadPool(int thread_count) : thread_count(std::max(1, thread_count))
+{
+    for (int i = 0; i < this->thread_count; i++)
+        queues.push_back(std::make_unique<Queue>());
+    // The thread that waits on a group does work too, so one fewer worker is needed
+    for (int i = 1; i < this->thread_count; i++)
+        workers.emplace_back([this, i]() { this->worker(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(sleep_mutex);
+        shutdown = true;
+    }
+    wakeup.notify_all();
+    for (auto &w : workers)
+        w.join();
+}
+
+int ThreadPool::queue_index() const { return (current_pool == this) ? current_worker : 0; }
+
+void ThreadPool::push(Task task)
+{
+    auto &q = *queues.at(queue_index());
+    {
+        std::lock_guard<std::mutex> lk(q.mutex);
+        q.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lk(sleep_mutex);
+        ++queued;
+    }
+    wakeup.notify_one();
+}
+
+bool ThreadPool::try_run_one()
+{
+    int self = queue_index();
+    Task task;
+    bool found = false;
+    // Newest task from our own queue first, as that is most likely to still be in cache; otherwise steal the oldest
+    // task from another queue, which tends to be the largest piece of outstanding work.
+    for (int i = 0; i < int(queues.size()) && !found; i++) {
+        auto &q = *queues.at((self + i) % queues.size());
+        std::lock_guard<std::mutex> lk(q.mutex);
+        if (q.tasks.empty())
+            continue;
+        if (i == 0) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        } else {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+        found = true;
+    }
+    if (!found)
+        return false;
+    --queued;
+    execute(task);
+    return true;
+}
+
+void ThreadPool::execute(Task &task)
+{
+    TaskGroup *group = task.group;
+    try {
+        task.func();
+    } catch (...) {
+        std::lock_guard<std::mutex> lk(group->error_mutex);
+        if (!group->error)
+            group->error = std::current_exception();
+    }
+    if (--group->pending == 0) {
+        // Taking the lock orders this against a waiter that has just checked pending and is about to sleep
+        { std::lock_guard<std::mutex> lk(sleep_mutex); }
+        wakeup.notify_all();
+    }
+}
+
+void ThreadPool::worker(int idx)
+{
+    current_pool = this;
+    current_worker = idx;
+    while (true) {
+        if (try_run_one())
+            continue;
+        std::unique_lock<std::mutex> lk(sleep_mutex);
+        wakeup.wait(lk, [this] { return shutdown || queued > 0; });
+        if (shutdown && queued == 0)
+            break;
+    }
+}
+
+ThreadPool::TaskGroup::~TaskGroup()
+{
+    // Tasks refer to the group, so it can't go away with any outstanding; errors are dropped here as destructors
+    // can't throw
+    while (pending > 0) {
+        if (pool.try_run_one())
+            continue;
+        std::unique_lock<std::mutex> lk(pool.sleep_mutex);
+        pool.wakeup.wait(lk, [this] { return pending == 0 || pool.queued > 0; });
+    }
+}
+
+void ThreadPool::TaskGroup::spawn(std::function<void()> task)
+{
+    ++pending;
+    pool.push(Task{std::move(task), this});
+}
+
+void ThreadPool::TaskGroup::wait()
+{
+    while (pending > 0) {
+        if (pool.try_run_one())
+            continue;
+        std::unique_lock<std::mutex> lk(pool.sleep_mutex);
+        pool.wakeup.wait(lk, [this] { return pending == 0 || pool.queued > 0; });
+    }
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void ThreadPool::run(int N, std::function<void(int)> func)
+{
+    int chunks = std::min(N, thread_count);
+    if (chunks <= 1) {
+        for (int i = 0; i < N; i++)
+            func(i);
+        return;
+    }
+    int per_chunk = (N + chunks - 1) / chunks;
+    auto do_chunk = [&](int c) {
+        int end = std::min(N, per_chunk * (c + 1));
+        for (int i = per_chunk * c; i < end; i++)
+            func(i);
+    };
+    TaskGroup group(*this);
+    for (int c = 1; c < chunks; c++)
+        group.spawn([&do_chunk, c]() { do_chunk(c); });
+    do_chunk(0);
+    group.wait();
+}
+
+void ThreadPool::parallel_for(int N, int grain, std::function<void(int, int)> func)
+{
+    grain = std::max(1, grain);
+    int blocks = (N + grain - 1) / grain;
+    if (blocks <= 0)
+        return;
+    std::atomic<int> next_block{0};
+    auto take_blocks = [&]() {
+        for (int b = next_block++; b < blocks; b = next_block++)
+            func(b * grain, std::min(N, (b + 1) * grain));
+    };
+    TaskGroup group(*this);
+    for (int i = 1; i < std::min(blocks, thread_count); i++)
+        group.spawn(take_blocks);
+    take_blocks();
+    group.wait();
+}
+
+#endif
+
+NEXTPNR_NAMESPACE_END
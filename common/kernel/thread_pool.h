@@ -0,0 +1,117 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2024  The nextpnr Authors.
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#ifndef NPNR_DISABLE_THREADS
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#include "nextpnr_namespaces.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// A work-stealing pool of worker threads, normally the one owned by the Context (Context::getThreadPool) so that
+// all passes share the same threads.
+//
+// Each worker has its own task queue; tasks spawned from a worker go onto its queue, and idle workers steal from the
+// other end of the other queues. A thread waiting on a TaskGroup runs queued tasks itself while it waits, so the pool
+// can be used from inside its own tasks (e.g. an x/y axis solve that is itself parallel) without deadlocking, and the
+// calling thread always contributes to the work.
+struct ThreadPool
+{
+    // thread_count is the total number of threads that run tasks, including the thread that waits for them
+    explicit ThreadPool(int thread_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const { return thread_count; }
+
+    // A set of tasks that can be waited on together. The first exception thrown by a task (e.g. from log_error) is
+    // rethrown by wait().
+    struct TaskGroup
+    {
+        explicit TaskGroup(ThreadPool &pool) : pool(pool) {};
+        ~TaskGroup();
+
+        void spawn(std::function<void()> task);
+        void wait();
+
+      private:
+        friend struct ThreadPool;
+        ThreadPool &pool;
+        std::atomic<int> pending{0};
+        std::exception_ptr error;
+#ifndef NPNR_DISABLE_THREADS
+        std::mutex error_mutex;
+#endif
+    };
+
+    // Calls func(0..N-1), split into one contiguous chunk per thread, and returns once all of them are done
+    void run(int N, std::function<void(int)> func);
+    // Calls func(begin, end) for blocks of up to grain indices covering [0, N), handed out to threads as they become
+    // free, and returns once all of them are done. Better than run when the cost per index varies a lot.
+    void parallel_for(int N, int grain, std::function<void(int, int)> func);
+
+  private:
+    int thread_count;
+#ifndef NPNR_DISABLE_THREADS
+    struct Task
+    {
+        std::function<void()> func;
+        TaskGroup *group;
+    };
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    // queues[0] takes tasks spawned by threads outside the pool, queues[i] belongs to worker i
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    // Guards sleeping and waking, both of idle workers and of threads waiting on a group
+    std::mutex sleep_mutex;
+    std::condition_variable wakeup;
+    std::atomic<int> queued{0};
+    bool shutdown = false;
+
+    int queue_index() const;
+    void push(Task task);
+    bool try_run_one();
+    void execute(Task &task);
+    void worker(int idx);
+#endif
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif
@@ -24,6 +24,7 @@
 #include <boost/range/adaptor/reversed.hpp>
 #include <deque>
 #include <map>
+#include <queue>
 #include <utility>
 #include "util.h"
 
@@ -35,8 +36,22 @@ TimingAnalyser::TimingAnalyser(Context *ctx) : ctx(ctx)
     domain_to_id.emplace(key, 0);
     domains.emplace_back(key);
     async_clock_id = 0;
+    incremental = bool_or_default(ctx->settings, ctx->id("timing/incremental"), true);
+    threads = ctx->getThreadCount();
 };
 
+template <typename Tfunc> void TimingAnalyser::parallel_for(int begin, int end, Tfunc func)
+{
+    // Below this, waking up the worker threads costs more than the work itself
+    const int min_parallel = 1024;
+    if (threads <= 1 || (end - begin) < min_parallel) {
+        for (int i = begin; i < end; i++)
+            func(i);
+        return;
+    }
+    ctx->getThreadPool().run(end - begin, [&](int i) { func(begin + i); });
+}
+
 void TimingAnalyser::setup(bool update_net_timings, bool update_histogram, bool update_crit_paths)
 {
     init_ports();
@@ -44,19 +59,25 @@ void TimingAnalyser::setup(bool update_net_timings, bool update_histogram, bool
     topo_sort();
     setup_port_domains();
     identify_related_domains();
+    setup_propagation();
     run(true, update_net_timings, update_histogram, update_crit_paths);
 }
 
 void TimingAnalyser::run(bool update_route_delays, bool update_net_timings, bool update_histogram,
                          bool update_crit_paths)
 {
-    reset_times();
     if (update_route_delays)
         get_route_delays();
-    walk_forward();
-    walk_backward();
-    compute_slack();
-    compute_criticality();
+    if (!run_incremental()) {
+        reset_times();
+        walk_forward();
+        walk_backward();
+        compute_slack();
+        compute_criticality();
+        times_valid = true;
+        times_setup_only = setup_only;
+    }
+    clear_dirty();
 
     // Ensure we clear all timing results if any of them has been marked as
     // as to be updated. This is done so we ensure it's not possible to have
@@ -80,13 +101,18 @@ void TimingAnalyser::run(bool update_route_delays, bool update_net_timings, bool
 
 void TimingAnalyser::init_ports()
 {
+    ports.clear();
+    port_index.clear();
     // Per cell port structures
     for (auto &cell : ctx->cells) {
         CellInfo *ci = cell.second.get();
         for (auto &port : ci->ports) {
-            auto &data = ports[CellPortKey(ci->name, port.first)];
+            CellPortKey key(ci->name, port.first);
+            port_index[key] = int(ports.size());
+            auto &data = ports.emplace_back();
             data.type = port.second.type;
-            data.cell_port = CellPortKey(ci->name, port.first);
+            data.cell_port = key;
+            data.net = port.second.net;
         }
     }
 }
@@ -95,16 +121,17 @@ void TimingAnalyser::get_cell_delays()
 {
     auto async_clk_key = domains.at(async_clock_id);
 
-    for (auto &port : ports) {
-        CellInfo *ci = cell_info(port.first);
-        auto &pi = port_info(port.first);
-        auto &pd = port.second;
+    cell_arcs.clear();
+    for (int p = 0; p < int(ports.size()); p++, cell_arcs.end_port()) {
+        auto &pd = ports.at(p);
+        CellInfo *ci = cell_info(pd.cell_port);
+        auto &pi = port_info(pd.cell_port);
+        auto &arcs = cell_arcs.data;
 
-        IdString name = port.first.port;
+        IdString name = pd.cell_port.port;
         // Ignore dangling ports altogether for timing purposes
         if (!pi.net)
             continue;
-        pd.cell_arcs.clear();
         int clkInfoCount = 0;
         TimingPortClass cls = ctx->getPortTimingClass(ci, name, clkInfoCount);
         if (cls == TMG_CLOCK_INPUT || cls == TMG_GEN_CLOCK || cls == TMG_IGNORE)
@@ -116,15 +143,13 @@ void TimingAnalyser::get_cell_delays()
                     auto info = ctx->getPortClockingInfo(ci, name, i);
                     if (!ci->ports.count(info.clock_port) || ci->ports.at(info.clock_port).net == nullptr)
                         continue;
-                    pd.cell_arcs.emplace_back(CellArc::SETUP, info.clock_port, DelayQuad(info.setup, info.setup),
-                                              info.edge);
-                    pd.cell_arcs.emplace_back(CellArc::HOLD, info.clock_port, DelayQuad(info.hold, info.hold),
-                                              info.edge);
+                    arcs.emplace_back(CellArc::SETUP, info.clock_port, DelayQuad(info.setup, info.setup), info.edge);
+                    arcs.emplace_back(CellArc::HOLD, info.clock_port, DelayQuad(info.hold, info.hold), info.edge);
                 }
             }
             // asynchronous endpoint
             else if (cls == TMG_ENDPOINT) {
-                pd.cell_arcs.emplace_back(CellArc::ENDPOINT, async_clk_key.key.clock, DelayQuad{});
+                arcs.emplace_back(CellArc::ENDPOINT, async_clk_key.key.clock, DelayQuad{});
             }
             // Combinational delays through cell
             for (auto &other_port : ci->ports) {
@@ -135,7 +160,7 @@ void TimingAnalyser::get_cell_delays()
                 DelayQuad delay;
                 bool is_path = ctx->getCellDelay(ci, name, other_port.first, delay);
                 if (is_path)
-                    pd.cell_arcs.emplace_back(CellArc::COMBINATIONAL, other_port.first, delay);
+                    arcs.emplace_back(CellArc::COMBINATIONAL, other_port.first, delay);
             }
         } else if (pi.type == PORT_OUT) {
             // Output ports might have clk-to-q relationships
@@ -144,12 +169,12 @@ void TimingAnalyser::get_cell_delays()
                     auto info = ctx->getPortClockingInfo(ci, name, i);
                     if (!ci->ports.count(info.clock_port) || ci->ports.at(info.clock_port).net == nullptr)
                         continue;
-                    pd.cell_arcs.emplace_back(CellArc::CLK_TO_Q, info.clock_port, info.clockToQ, info.edge);
+                    arcs.emplace_back(CellArc::CLK_TO_Q, info.clock_port, info.clockToQ, info.edge);
                 }
             }
             // Asynchronous startpoint
             else if (cls == TMG_STARTPOINT) {
-                pd.cell_arcs.emplace_back(CellArc::STARTPOINT, async_clk_key.key.clock, DelayQuad{});
+                arcs.emplace_back(CellArc::STARTPOINT, async_clk_key.key.clock, DelayQuad{});
             }
             // Combinational delays through cell
             for (auto &other_port : ci->ports) {
@@ -160,9 +185,14 @@ void TimingAnalyser::get_cell_delays()
                 DelayQuad delay;
                 bool is_path = ctx->getCellDelay(ci, other_port.first, name, delay);
                 if (is_path)
-                    pd.cell_arcs.emplace_back(CellArc::COMBINATIONAL, other_port.first, delay);
+                    arcs.emplace_back(CellArc::COMBINATIONAL, other_port.first, delay);
             }
         }
+        for (int i = cell_arcs.offset.back(); i < int(arcs.size()); i++) {
+            auto found = port_index.find(CellPortKey(pd.cell_port.cell, arcs.at(i).other_port));
+            if (found != port_index.end())
+                arcs.at(i).other_idx = found->second;
+        }
     }
 }
 
@@ -176,33 +206,294 @@ void TimingAnalyser::get_route_delays()
         for (auto &usr : ni->users) {
             if (usr.cell->bel == BelId())
                 continue;
-            ports.at(CellPortKey(usr)).route_delay = DelayPair(ctx->getNetinfoRouteDelay(ni, usr));
+            set_route_delay(CellPortKey(usr), DelayPair(ctx->getNetinfoRouteDelay(ni, usr)));
+        }
+    }
+}
+
+void TimingAnalyser::set_route_delay(CellPortKey port, DelayPair value)
+{
+    int idx = port_index.at(port);
+    auto &pd = ports.at(idx);
+    if (pd.route_delay.min_delay == value.min_delay && pd.route_delay.max_delay == value.max_delay)
+        return;
+    pd.route_delay = value;
+    mark_dirty(idx);
+}
+
+void TimingAnalyser::setup_propagation()
+{
+    times_valid = false;
+    clear_dirty();
+    comb_fanin.clear();
+    comb_fanout.clear();
+    port_startpoints.clear();
+    port_endpoints.clear();
+    // Loops break the topological ordering that incremental propagation relies on
+    if (have_loops)
+        return;
+    std::vector<std::vector<std::pair<int, DelayPair>>> fanin(ports.size()), fanout(ports.size());
+    for (int p = 0; p < int(ports.size()); p++) {
+        auto &pd = ports.at(p);
+        for (auto &arc : cell_arcs[p]) {
+            if (arc.type != CellArc::COMBINATIONAL)
+                continue;
+            if (pd.type == PORT_IN)
+                fanin.at(arc.other_idx).emplace_back(p, arc.value.delayPair());
+            else if (pd.type == PORT_OUT)
+                fanout.at(arc.other_idx).emplace_back(p, DelayPair(arc.value.maxDelay()));
         }
     }
+    std::vector<std::vector<std::pair<domain_id_t, IdString>>> sps(ports.size()), eps(ports.size());
+    for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
+        for (auto &sp : domains.at(dom_id).startpoints)
+            sps.at(sp.first).emplace_back(dom_id, sp.second);
+        for (auto &ep : domains.at(dom_id).endpoints)
+            eps.at(ep.first).emplace_back(dom_id, ep.second);
+    }
+    // As ports are visited in index order, fan-in is also in the same order as walk_forward visits it
+    for (int p = 0; p < int(ports.size()); p++) {
+        comb_fanin.data.insert(comb_fanin.data.end(), fanin.at(p).begin(), fanin.at(p).end());
+        comb_fanin.end_port();
+        comb_fanout.data.insert(comb_fanout.data.end(), fanout.at(p).begin(), fanout.at(p).end());
+        comb_fanout.end_port();
+        port_startpoints.data.insert(port_startpoints.data.end(), sps.at(p).begin(), sps.at(p).end());
+        port_startpoints.end_port();
+        port_endpoints.data.insert(port_endpoints.data.end(), eps.at(p).begin(), eps.at(p).end());
+        port_endpoints.end_port();
+    }
+}
+
+void TimingAnalyser::mark_dirty(int port)
+{
+    if (!times_valid || ports.at(port).dirty)
+        return;
+    ports.at(port).dirty = true;
+    dirty_ports.push_back(port);
+    // Once a large part of the design has changed, a full analysis is cheaper than tracking it
+    if (dirty_ports.size() > ports.size() / 4) {
+        times_valid = false;
+        clear_dirty();
+    }
+}
+
+void TimingAnalyser::clear_dirty()
+{
+    for (int p : dirty_ports)
+        ports.at(p).dirty = false;
+    dirty_ports.clear();
+}
+
+bool TimingAnalyser::update_arrival(int port)
+{
+    static const auto init_delay =
+            DelayPair(std::numeric_limits<delay_t>::max(), std::numeric_limits<delay_t>::lowest());
+    auto times = arrival[port];
+    std::vector<std::pair<DelayPair, int>> old_times;
+    old_times.reserve(times.size());
+    for (auto &t : times) {
+        old_times.emplace_back(t.value, t.path_length);
+        t.value = init_delay;
+        t.path_length = 0;
+        t.bwd_min = -1;
+        t.bwd_max = -1;
+    }
+    gather_arrival(port);
+    auto old = old_times.begin();
+    for (auto &t : times) {
+        if (t.value.min_delay != old->first.min_delay || t.value.max_delay != old->first.max_delay ||
+            t.path_length != old->second)
+            return true;
+        ++old;
+    }
+    return false;
 }
 
-void TimingAnalyser::set_route_delay(CellPortKey port, DelayPair value) { ports.at(port).route_delay = value; }
+bool TimingAnalyser::update_required(int port)
+{
+    static const auto init_delay =
+            DelayPair(std::numeric_limits<delay_t>::max(), std::numeric_limits<delay_t>::lowest());
+    auto times = required[port];
+    std::vector<std::pair<DelayPair, int>> old_times;
+    old_times.reserve(times.size());
+    for (auto &t : times) {
+        old_times.emplace_back(t.value, t.path_length);
+        t.value = init_delay;
+        t.path_length = 0;
+        t.bwd_min = -1;
+        t.bwd_max = -1;
+    }
+    gather_required(port);
+    auto old = old_times.begin();
+    for (auto &t : times) {
+        if (t.value.min_delay != old->first.min_delay || t.value.max_delay != old->first.max_delay ||
+            t.path_length != old->second)
+            return true;
+        ++old;
+    }
+    return false;
+}
+
+bool TimingAnalyser::run_incremental()
+{
+    if (!incremental || !times_valid || have_loops || setup_only != times_setup_only)
+        return false;
+    if (dirty_ports.empty())
+        return true;
+
+    // Ports are queued by index, which is their topological order, so that each port is only recomputed once all
+    // of its changed fan-in (forwards) or fan-out (backwards) has been
+    enum : uint8_t
+    {
+        QUEUED_FWD = 1,
+        QUEUED_BWD = 2,
+        TOUCHED = 4,
+    };
+    std::vector<uint8_t> flags(ports.size(), 0);
+    std::vector<int> touched;
+    std::priority_queue<int, std::vector<int>, std::greater<int>> fwd_queue;
+    std::priority_queue<int> bwd_queue;
+    auto push_fwd = [&](int idx) {
+        if (!(flags.at(idx) & QUEUED_FWD)) {
+            flags.at(idx) |= QUEUED_FWD;
+            fwd_queue.push(idx);
+        }
+    };
+    auto push_bwd = [&](int idx) {
+        if (!(flags.at(idx) & QUEUED_BWD)) {
+            flags.at(idx) |= QUEUED_BWD;
+            bwd_queue.push(idx);
+        }
+    };
+    auto touch = [&](int idx) {
+        if (!(flags.at(idx) & TOUCHED)) {
+            flags.at(idx) |= TOUCHED;
+            touched.push_back(idx);
+        }
+    };
+
+    for (int port : dirty_ports) {
+        // A changed route delay affects the arrival time at the sink and the required time at the driver
+        auto &pd = ports.at(port);
+        push_fwd(port);
+        if (pd.driver != -1)
+            push_bwd(pd.driver);
+        if (with_clock_skew) {
+            // Clock route delays are part of the startpoint/endpoint times of the cell's registered ports
+            for (auto &other : cell_info(pd.cell_port)->ports) {
+                int other_idx = port_index.at(CellPortKey(pd.cell_port.cell, other.first));
+                for (auto &arc : cell_arcs[other_idx]) {
+                    if (arc.other_idx != port)
+                        continue;
+                    if (arc.type == CellArc::CLK_TO_Q)
+                        push_fwd(other_idx);
+                    else if (arc.type == CellArc::SETUP)
+                        push_bwd(other_idx);
+                }
+            }
+        }
+    }
+
+    // Past this point the full analysis is cheaper
+    size_t limit = ports.size() / 2, processed = 0;
+    while (!fwd_queue.empty()) {
+        int idx = fwd_queue.top();
+        fwd_queue.pop();
+        if (++processed > limit)
+            return false;
+        if (!update_arrival(idx))
+            continue;
+        touch(idx);
+        auto &pd = ports.at(idx);
+        if (pd.type == PORT_OUT) {
+            for (int usr : net_users[idx])
+                push_fwd(usr);
+        } else if (pd.type == PORT_IN) {
+            for (auto &arc : cell_arcs[idx])
+                if (arc.type == CellArc::COMBINATIONAL)
+                    push_fwd(arc.other_idx);
+        }
+    }
+    while (!bwd_queue.empty()) {
+        int idx = bwd_queue.top();
+        bwd_queue.pop();
+        if (++processed > limit)
+            return false;
+        if (!update_required(idx))
+            continue;
+        touch(idx);
+        auto &pd = ports.at(idx);
+        if (pd.type == PORT_IN) {
+            if (pd.driver != -1)
+                push_bwd(pd.driver);
+        } else if (pd.type == PORT_OUT) {
+            for (auto &arc : cell_arcs[idx])
+                if (arc.type == CellArc::COMBINATIONAL)
+                    push_bwd(arc.other_idx);
+        }
+    }
+
+    // Update slack at the ports whose times changed. The worst slack of a domain pair can only get better if one of
+    // those ports held it, in which case it has to be found again.
+    std::vector<std::pair<delay_t, delay_t>> old_worst;
+    old_worst.reserve(domain_pairs.size());
+    for (auto &dp : domain_pairs)
+        old_worst.emplace_back(dp.worst_setup_slack, dp.worst_hold_slack);
+    bool rescan = false;
+    for (int idx : touched) {
+        for (auto &pdp : port_domain_pairs[idx]) {
+            auto &dp = domain_pairs.at(pdp.domain_pair);
+            if (pdp.setup_slack == dp.worst_setup_slack || (!setup_only && pdp.hold_slack == dp.worst_hold_slack))
+                rescan = true;
+        }
+        compute_port_slack(idx);
+    }
+    if (rescan) {
+        update_worst_slack();
+    } else {
+        for (int idx : touched) {
+            for (auto &pdp : port_domain_pairs[idx]) {
+                auto &dp = domain_pairs.at(pdp.domain_pair);
+                dp.worst_setup_slack = std::min(dp.worst_setup_slack, pdp.setup_slack);
+                if (!setup_only)
+                    dp.worst_hold_slack = std::min(dp.worst_hold_slack, pdp.hold_slack);
+            }
+        }
+    }
+
+    // Criticality is relative to the worst slack, so if that moved it must be updated everywhere
+    bool worst_changed = false;
+    for (size_t i = 0; i < domain_pairs.size(); i++)
+        worst_changed |= (domain_pairs.at(i).worst_setup_slack != old_worst.at(i).first);
+    if (worst_changed) {
+        compute_criticality();
+    } else {
+        for (int idx : touched)
+            compute_port_criticality(idx);
+    }
+    return true;
+}
 
 void TimingAnalyser::topo_sort()
 {
     TopoSort<CellPortKey> topo;
-    for (auto &port : ports) {
-        auto &pd = port.second;
+    for (int p = 0; p < int(ports.size()); p++) {
+        auto &pd = ports.at(p);
         // All ports are nodes
-        topo.node(port.first);
+        topo.node(pd.cell_port);
         if (pd.type == PORT_IN) {
             // inputs: combinational arcs through the cell are edges
-            for (auto &arc : pd.cell_arcs) {
+            for (auto &arc : cell_arcs[p]) {
                 if (arc.type != CellArc::COMBINATIONAL)
                     continue;
-                topo.edge(port.first, CellPortKey(port.first.cell, arc.other_port));
+                topo.edge(pd.cell_port, CellPortKey(pd.cell_port.cell, arc.other_port));
             }
         } else if (pd.type == PORT_OUT) {
             // output: routing arcs are edges
-            const NetInfo *pn = port_info(port.first).net;
+            const NetInfo *pn = pd.net;
             if (pn != nullptr) {
                 for (auto &usr : pn->users)
-                    topo.edge(port.first, CellPortKey(usr));
+                    topo.edge(pd.cell_port, CellPortKey(usr));
             }
         }
     }
@@ -226,7 +517,80 @@ void TimingAnalyser::topo_sort()
             log_error("Timing analysis failed due to combinational loops.\n");
     }
     have_loops = !no_loops;
-    std::swap(topological_order, topo.sorted);
+
+    std::vector<int> order;
+    order.reserve(topo.sorted.size());
+    for (auto &key : topo.sorted)
+        order.push_back(port_index.at(key));
+
+    level_start.clear();
+    if (!have_loops) {
+        // A port's level is one more than the highest level in its fan-in
+        std::vector<int> level(ports.size(), 0);
+        int max_level = 0;
+        for (int p : order) {
+            auto &pd = ports.at(p);
+            auto visit = [&](int next) { level.at(next) = std::max(level.at(next), level.at(p) + 1); };
+            if (pd.type == PORT_IN) {
+                for (auto &arc : cell_arcs[p])
+                    if (arc.type == CellArc::COMBINATIONAL)
+                        visit(arc.other_idx);
+            } else if (pd.type == PORT_OUT && pd.net != nullptr) {
+                for (auto &usr : pd.net->users)
+                    visit(port_index.at(CellPortKey(usr)));
+            }
+            max_level = std::max(max_level, level.at(p));
+        }
+        // Sorting by level keeps the order topological
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return level.at(a) < level.at(b); });
+        level_start.resize(max_level + 2, 0);
+        for (int p : order)
+            ++level_start.at(level.at(p) + 1);
+        for (int i = 1; i < int(level_start.size()); i++)
+            level_start.at(i) += level_start.at(i - 1);
+    }
+    renumber_ports(order);
+}
+
+void TimingAnalyser::renumber_ports(const std::vector<int> &order)
+{
+    NPNR_ASSERT(order.size() == ports.size());
+    std::vector<int> new_idx(ports.size());
+    for (int i = 0; i < int(order.size()); i++)
+        new_idx.at(order.at(i)) = i;
+
+    std::vector<PerPort> new_ports;
+    PortTable<CellArc> new_arcs;
+    new_ports.reserve(ports.size());
+    new_arcs.data.reserve(cell_arcs.data.size());
+    for (int old_idx : order) {
+        new_ports.push_back(ports.at(old_idx));
+        port_index.at(new_ports.back().cell_port) = int(new_ports.size()) - 1;
+        for (auto &arc : cell_arcs[old_idx]) {
+            new_arcs.data.push_back(arc);
+            if (arc.other_idx != -1)
+                new_arcs.data.back().other_idx = new_idx.at(arc.other_idx);
+        }
+        new_arcs.end_port();
+    }
+    std::swap(ports, new_ports);
+    std::swap(cell_arcs, new_arcs);
+
+    // Connectivity through nets
+    net_users.clear();
+    for (int p = 0; p < int(ports.size()); p++) {
+        auto &pd = ports.at(p);
+        pd.driver = -1;
+        if (pd.net != nullptr) {
+            if (pd.type == PORT_OUT) {
+                for (auto &usr : pd.net->users)
+                    net_users.data.push_back(port_index.at(CellPortKey(usr)));
+            } else if (pd.net->driver.cell != nullptr) {
+                pd.driver = port_index.at(CellPortKey(pd.net->driver));
+            }
+        }
+        net_users.end_port();
+    }
 }
 
 void TimingAnalyser::setup_port_domains()
@@ -235,86 +599,118 @@ void TimingAnalyser::setup_port_domains()
         d.startpoints.clear();
         d.endpoints.clear();
     }
+    // Domains are discovered one at a time, so collect them per port here before flattening them into the time tables
+    std::vector<std::vector<domain_id_t>> arr_doms(ports.size()), req_doms(ports.size());
+    auto add_domain = [&](std::vector<domain_id_t> &doms, domain_id_t dom) {
+        auto pos = std::lower_bound(doms.begin(), doms.end(), dom);
+        if (pos != doms.end() && *pos == dom)
+            return false;
+        doms.insert(pos, dom);
+        return true;
+    };
+    auto copy_domains = [&](std::vector<std::vector<domain_id_t>> &doms, int from, int to) {
+        for (domain_id_t dom : doms.at(from))
+            updated_domains |= add_domain(doms.at(to), dom);
+    };
+    std::vector<std::vector<domain_id_t>> pair_doms(ports.size());
     bool first_iter = true;
     do {
         // Go forward through the topological order (domains from the PoV of arrival time)
         updated_domains = false;
-        for (auto port : topological_order) {
+        for (int port = 0; port < int(ports.size()); port++) {
             auto &pd = ports.at(port);
-            auto &pi = port_info(port);
-            if (pi.type == PORT_OUT) {
+            if (pd.type == PORT_OUT) {
                 if (first_iter) {
-                    for (auto &fanin : pd.cell_arcs) {
+                    for (auto &fanin : cell_arcs[port]) {
                         domain_id_t dom;
                         // registered outputs are startpoints
                         if (fanin.type == CellArc::CLK_TO_Q)
-                            dom = domain_id(port.cell, fanin.other_port, fanin.edge);
+                            dom = domain_id(pd.cell_port.cell, fanin.other_port, fanin.edge);
                         else if (fanin.type == CellArc::STARTPOINT)
                             dom = async_clock_id;
                         else
                             continue;
                         // create per-domain data
-                        pd.arrival[dom];
+                        add_domain(arr_doms.at(port), dom);
                         domains.at(dom).startpoints.emplace_back(port, fanin.other_port);
                     }
                 }
                 // copy domains across routing
-                if (pi.net != nullptr)
-                    for (auto &usr : pi.net->users)
-                        copy_domains(port, CellPortKey(usr), false);
+                for (int usr : net_users[port])
+                    copy_domains(arr_doms, port, usr);
             } else {
                 // copy domains from input to output
-                for (auto &fanout : pd.cell_arcs) {
+                for (auto &fanout : cell_arcs[port]) {
                     if (fanout.type != CellArc::COMBINATIONAL)
                         continue;
-                    copy_domains(port, CellPortKey(port.cell, fanout.other_port), false);
+                    copy_domains(arr_doms, port, fanout.other_idx);
                 }
             }
         }
         // Go backward through the topological order (domains from the PoV of required time)
-        for (auto port : reversed_range(topological_order)) {
+        for (int port = int(ports.size()) - 1; port >= 0; port--) {
             auto &pd = ports.at(port);
-            auto &pi = port_info(port);
-            if (pi.type == PORT_OUT) {
+            if (pd.type == PORT_OUT) {
                 // copy domains from output to input
-                for (auto &fanin : pd.cell_arcs) {
+                for (auto &fanin : cell_arcs[port]) {
                     if (fanin.type != CellArc::COMBINATIONAL)
                         continue;
-                    copy_domains(port, CellPortKey(port.cell, fanin.other_port), true);
+                    copy_domains(req_doms, port, fanin.other_idx);
                 }
             } else {
                 if (first_iter) {
-                    for (auto &fanout : pd.cell_arcs) {
+                    for (auto &fanout : cell_arcs[port]) {
                         domain_id_t dom;
                         // registered inputs are endpoints
                         if (fanout.type == CellArc::SETUP)
-                            dom = domain_id(port.cell, fanout.other_port, fanout.edge);
+                            dom = domain_id(pd.cell_port.cell, fanout.other_port, fanout.edge);
                         else if (fanout.type == CellArc::ENDPOINT)
                             dom = async_clock_id;
                         else
                             continue;
                         // create per-domain data
-                        pd.required[dom];
+                        add_domain(req_doms.at(port), dom);
                         domains.at(dom).endpoints.emplace_back(port, fanout.other_port);
                     }
                 }
                 // copy port to driver
-                if (pi.net != nullptr && pi.net->driver.cell != nullptr)
-                    copy_domains(port, CellPortKey(pi.net->driver), true);
+                if (pd.driver != -1)
+                    copy_domains(req_doms, port, pd.driver);
             }
         }
         // Iterate over ports and find domain pairs
-        for (auto port : topological_order) {
-            auto &pd = ports.at(port);
-            for (auto &arr : pd.arrival)
-                for (auto &req : pd.required) {
-                    pd.domain_pairs[domain_pair_id(arr.first, req.first)];
+        for (int port = 0; port < int(ports.size()); port++) {
+            for (domain_id_t arr : arr_doms.at(port))
+                for (domain_id_t req : req_doms.at(port)) {
+                    auto &pairs = pair_doms.at(port);
+                    domain_id_t dp = domain_pair_id(arr, req);
+                    auto pos = std::lower_bound(pairs.begin(), pairs.end(), dp);
+                    if (pos == pairs.end() || *pos != dp)
+                        pairs.insert(pos, dp);
                 }
         }
         first_iter = false;
         // If there are loops, repeat the process until a fixed point is reached, as there might be unusual ways to
         // visit points, which would result in a missing domain key and therefore crash later on
     } while (have_loops && updated_domains);
+
+    arrival.clear();
+    required.clear();
+    port_domain_pairs.clear();
+    for (int port = 0; port < int(ports.size()); port++) {
+        for (domain_id_t dom : arr_doms.at(port))
+            arrival.data.push_back(ArrivReqTime{dom, DelayPair(0), -1, -1, 0});
+        arrival.end_port();
+        for (domain_id_t dom : req_doms.at(port))
+            required.data.push_back(ArrivReqTime{dom, DelayPair(0), -1, -1, 0});
+        required.end_port();
+        for (domain_id_t dp : pair_doms.at(port)) {
+            port_domain_pairs.data.emplace_back();
+            port_domain_pairs.data.back().domain_pair = dp;
+        }
+        port_domain_pairs.end_port();
+    }
+
     for (auto &dp : domain_pairs) {
         auto &launch_data = domains.at(dp.key.launch);
         auto &capture_data = domains.at(dp.key.capture);
@@ -498,114 +894,148 @@ void TimingAnalyser::identify_related_domains()
             clock_delays[std::make_pair(c1.first, c2.first)] = delay;
         }
     }
+
+    for (auto &dp : domain_pairs) {
+        auto clocks = std::make_pair(domains.at(dp.key.launch).key.clock, domains.at(dp.key.capture).key.clock);
+        dp.clock_to_clock = clock_delays.count(clocks) ? clock_delays.at(clocks) : 0;
+    }
 }
 
 void TimingAnalyser::reset_times()
 {
     static const auto init_delay =
             DelayPair(std::numeric_limits<delay_t>::max(), std::numeric_limits<delay_t>::lowest());
-    for (auto &port : ports) {
-        auto do_reset = [&](dict<domain_id_t, ArrivReqTime> &times) {
-            for (auto &t : times) {
-                t.second.value = init_delay;
-                t.second.path_length = 0;
-                t.second.bwd_min = CellPortKey();
-                t.second.bwd_max = CellPortKey();
-            }
-        };
-        do_reset(port.second.arrival);
-        do_reset(port.second.required);
-        for (auto &dp : port.second.domain_pairs) {
-            dp.second.setup_slack = std::numeric_limits<delay_t>::max();
-            dp.second.hold_slack = std::numeric_limits<delay_t>::max();
-            dp.second.max_path_length = 0;
-            dp.second.criticality = 0;
+    auto do_reset = [&](std::vector<ArrivReqTime> &times) {
+        for (auto &t : times) {
+            t.value = init_delay;
+            t.path_length = 0;
+            t.bwd_min = -1;
+            t.bwd_max = -1;
         }
-        port.second.worst_crit = 0;
-        port.second.worst_setup_slack = std::numeric_limits<delay_t>::max();
-        port.second.worst_hold_slack = std::numeric_limits<delay_t>::max();
+    };
+    do_reset(arrival.data);
+    do_reset(required.data);
+    for (auto &dp : port_domain_pairs.data) {
+        dp.setup_slack = std::numeric_limits<delay_t>::max();
+        dp.hold_slack = std::numeric_limits<delay_t>::max();
+        dp.max_path_length = 0;
+        dp.criticality = 0;
+    }
+    for (auto &pd : ports) {
+        pd.worst_crit = 0;
+        pd.worst_setup_slack = std::numeric_limits<delay_t>::max();
+        pd.worst_hold_slack = std::numeric_limits<delay_t>::max();
     }
 }
 
-void TimingAnalyser::set_arrival_time(CellPortKey target, domain_id_t domain, DelayPair arrival, int path_length,
-                                      CellPortKey prev)
+void TimingAnalyser::set_arrival_time(int target, domain_id_t domain, DelayPair arrival, int path_length, int prev)
 {
-    auto &arr = ports.at(target).arrival.at(domain);
-    if (arrival.max_delay > arr.value.max_delay) {
-        arr.value.max_delay = arrival.max_delay;
-        arr.bwd_max = prev;
+    auto *arr = find_time(this->arrival[target], domain);
+    NPNR_ASSERT(arr != nullptr);
+    if (arrival.max_delay > arr->value.max_delay) {
+        arr->value.max_delay = arrival.max_delay;
+        arr->bwd_max = prev;
     }
-    if (!setup_only && (arrival.min_delay < arr.value.min_delay)) {
-        arr.value.min_delay = arrival.min_delay;
-        arr.bwd_min = prev;
+    if (!setup_only && (arrival.min_delay < arr->value.min_delay)) {
+        arr->value.min_delay = arrival.min_delay;
+        arr->bwd_min = prev;
     }
-    arr.path_length = std::max(arr.path_length, path_length);
+    arr->path_length = std::max(arr->path_length, path_length);
 }
 
-void TimingAnalyser::set_required_time(CellPortKey target, domain_id_t domain, DelayPair required, int path_length,
-                                       CellPortKey prev)
+void TimingAnalyser::set_required_time(int target, domain_id_t domain, DelayPair required, int path_length, int prev)
 {
-    auto &req = ports.at(target).required.at(domain);
-    if (required.min_delay < req.value.min_delay) {
-        req.value.min_delay = required.min_delay;
-        req.bwd_min = prev;
+    auto *req = find_time(this->required[target], domain);
+    NPNR_ASSERT(req != nullptr);
+    if (required.min_delay < req->value.min_delay) {
+        req->value.min_delay = required.min_delay;
+        req->bwd_min = prev;
+    }
+    if (!setup_only && (required.max_delay > req->value.max_delay)) {
+        req->value.max_delay = required.max_delay;
+        req->bwd_max = prev;
     }
-    if (!setup_only && (required.max_delay > req.value.max_delay)) {
-        req.value.max_delay = required.max_delay;
-        req.bwd_max = prev;
+    req->path_length = std::max(req->path_length, path_length);
+}
+
+void TimingAnalyser::get_startpoint_arrival(int port, IdString clock_port, DelayPair &arrival, int &clock_idx)
+{
+    arrival = DelayPair(0);
+    clock_idx = -1;
+    if (clock_port == IdString())
+        return;
+    // clocked startpoints have a clock-to-out time
+    for (auto &fanin : cell_arcs[port]) {
+        if (fanin.type == CellArc::CLK_TO_Q && fanin.other_port == clock_port) {
+            arrival += fanin.value.delayPair();
+            clock_idx = fanin.other_idx;
+            // Include the clock delay if clock_skew analysis is enabled
+            if (with_clock_skew) {
+                arrival += ports.at(fanin.other_idx).route_delay;
+            }
+            break;
+        }
+    }
+}
+
+void TimingAnalyser::get_endpoint_required(int port, IdString clock_port, DelayPair &required, int &clock_idx)
+{
+    required = DelayPair(0);
+    clock_idx = -1;
+    // TODO: clock routing delay, if analysis of that is enabled
+    if (clock_port == IdString())
+        return;
+    // Add setup/hold time, if this endpoint is clocked
+    for (auto &fanin : cell_arcs[port]) {
+
+        if (fanin.type == CellArc::SETUP && fanin.other_port == clock_port) {
+            clock_idx = fanin.other_idx;
+            if (with_clock_skew) {
+                required += ports.at(fanin.other_idx).route_delay;
+            }
+            required.min_delay -= fanin.value.maxDelay();
+        }
+        if (fanin.type == CellArc::HOLD && fanin.other_port == clock_port)
+            required.max_delay += fanin.value.maxDelay();
     }
-    req.path_length = std::max(req.path_length, path_length);
 }
 
 void TimingAnalyser::walk_forward()
 {
+    if (!level_start.empty()) {
+        // Levelised walk: each port pulls its arrival times from its fan-in, which is all at lower levels
+        for (int i = 0; i < int(level_start.size()) - 1; i++)
+            parallel_for(level_start.at(i), level_start.at(i + 1), [&](int p) { gather_arrival(p); });
+        return;
+    }
     // Assign initial arrival time to domain startpoints
     for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
         auto &dom = domains.at(dom_id);
         for (auto &sp : dom.startpoints) {
-            auto &pd = ports.at(sp.first);
-            DelayPair init_arrival(0);
-            CellPortKey clock_key;
-            if (sp.second != IdString()) {
-                // clocked startpoints have a clock-to-out time
-                for (auto &fanin : pd.cell_arcs) {
-                    if (fanin.type == CellArc::CLK_TO_Q && fanin.other_port == sp.second) {
-                        init_arrival += fanin.value.delayPair();
-                        // Include the clock delay if clock_skew analysis is enabled
-                        if (with_clock_skew) {
-                            init_arrival += ports.at(CellPortKey(sp.first.cell, fanin.other_port)).route_delay;
-                        }
-                        break;
-                    }
-                }
-                clock_key = CellPortKey(sp.first.cell, sp.second);
-            }
-            set_arrival_time(sp.first, dom_id, init_arrival, 1, clock_key);
+            DelayPair init_arrival;
+            int clock_idx;
+            get_startpoint_arrival(sp.first, sp.second, init_arrival, clock_idx);
+            set_arrival_time(sp.first, dom_id, init_arrival, 1, clock_idx);
         }
     }
     // Walk forward in topological order
-    for (auto p : topological_order) {
+    for (int p = 0; p < int(ports.size()); p++) {
         auto &pd = ports.at(p);
-        for (auto &arr : pd.arrival) {
+        for (auto &arr : arrival[p]) {
             if (pd.type == PORT_OUT) {
                 // Output port: propagate delay through net, adding route delay
-                NetInfo *net = port_info(p).net;
-                if (net != nullptr)
-                    for (auto &usr : net->users) {
-                        CellPortKey usr_key(usr);
-                        auto &usr_pd = ports.at(usr_key);
-                        auto next_arr = arr.second.value + usr_pd.route_delay;
-                        set_arrival_time(usr_key, arr.first, next_arr, arr.second.path_length, p);
-                    }
+                for (int usr : net_users[p]) {
+                    auto next_arr = arr.value + ports.at(usr).route_delay;
+                    set_arrival_time(usr, arr.domain, next_arr, arr.path_length, p);
+                }
             } else if (pd.type == PORT_IN) {
                 // Input port; propagate delay through cell, adding combinational delay
-                for (auto &fanout : pd.cell_arcs) {
+                for (auto &fanout : cell_arcs[p]) {
                     if (fanout.type != CellArc::COMBINATIONAL)
                         continue;
 
-                    auto next_arr = arr.second.value + fanout.value.delayPair();
-                    set_arrival_time(CellPortKey(p.cell, fanout.other_port), arr.first, next_arr,
-                                     arr.second.path_length + 1, p);
+                    auto next_arr = arr.value + fanout.value.delayPair();
+                    set_arrival_time(fanout.other_idx, arr.domain, next_arr, arr.path_length + 1, p);
                 }
             }
         }
@@ -614,59 +1044,87 @@ void TimingAnalyser::walk_forward()
 
 void TimingAnalyser::walk_backward()
 {
+    if (!level_start.empty()) {
+        for (int i = int(level_start.size()) - 2; i >= 0; i--)
+            parallel_for(level_start.at(i), level_start.at(i + 1), [&](int p) { gather_required(p); });
+        return;
+    }
     // Assign initial required time to domain endpoints
     // Note that clock frequency will be considered later in the analysis for, for now all required times are normalised
     // to 0ns
     for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
         auto &dom = domains.at(dom_id);
         for (auto &ep : dom.endpoints) {
-            auto &pd = ports.at(ep.first);
-            DelayPair init_required(0);
-            CellPortKey clock_key;
-            // TODO: clock routing delay, if analysis of that is enabled
-            if (ep.second != IdString()) {
-                // Add setup/hold time, if this endpoint is clocked
-                for (auto &fanin : pd.cell_arcs) {
-
-                    if (fanin.type == CellArc::SETUP && fanin.other_port == ep.second) {
-                        if (with_clock_skew) {
-                            init_required += ports.at(CellPortKey(ep.first.cell, fanin.other_port)).route_delay;
-                        }
-                        init_required.min_delay -= fanin.value.maxDelay();
-                    }
-                    if (fanin.type == CellArc::HOLD && fanin.other_port == ep.second)
-                        init_required.max_delay += fanin.value.maxDelay();
-                }
-                clock_key = CellPortKey(ep.first.cell, ep.second);
-            }
-            set_required_time(ep.first, dom_id, init_required, 1, clock_key);
+            DelayPair init_required;
+            int clock_idx;
+            get_endpoint_required(ep.first, ep.second, init_required, clock_idx);
+            set_required_time(ep.first, dom_id, init_required, 1, clock_idx);
         }
     }
     // Walk backwards in topological order
-    for (auto p : reversed_range(topological_order)) {
+    for (int p = int(ports.size()) - 1; p >= 0; p--) {
         auto &pd = ports.at(p);
-        for (auto &req : pd.required) {
+        for (auto &req : required[p]) {
             if (pd.type == PORT_IN) {
                 // Input port: propagate delay back through net, subtracting route delay
-                NetInfo *net = port_info(p).net;
-                if (net != nullptr && net->driver.cell != nullptr)
-                    set_required_time(CellPortKey(net->driver), req.first,
-                                      req.second.value - DelayPair(pd.route_delay.maxDelay()), req.second.path_length,
-                                      p);
+                if (pd.driver != -1)
+                    set_required_time(pd.driver, req.domain, req.value - DelayPair(pd.route_delay.maxDelay()),
+                                      req.path_length, p);
             } else if (pd.type == PORT_OUT) {
                 // Output port : propagate delay back through cell, subtracting combinational delay
-                for (auto &fanin : pd.cell_arcs) {
+                for (auto &fanin : cell_arcs[p]) {
                     if (fanin.type != CellArc::COMBINATIONAL)
                         continue;
-                    set_required_time(CellPortKey(p.cell, fanin.other_port), req.first,
-                                      req.second.value - DelayPair(fanin.value.maxDelay()), req.second.path_length + 1,
-                                      p);
+                    set_required_time(fanin.other_idx, req.domain, req.value - DelayPair(fanin.value.maxDelay()),
+                                      req.path_length + 1, p);
                 }
             }
         }
     }
 }
 
+void TimingAnalyser::gather_arrival(int port)
+{
+    auto &pd = ports.at(port);
+    for (auto &dom : port_startpoints[port]) {
+        DelayPair init_arrival;
+        int clock_idx;
+        get_startpoint_arrival(port, dom.second, init_arrival, clock_idx);
+        set_arrival_time(port, dom.first, init_arrival, 1, clock_idx);
+    }
+    if (pd.type == PORT_OUT) {
+        for (auto &arc : comb_fanin[port])
+            for (auto &arr : arrival[arc.first])
+                set_arrival_time(port, arr.domain, arr.value + arc.second, arr.path_length + 1, arc.first);
+    } else if (pd.type == PORT_IN && pd.driver != -1) {
+        for (auto &arr : arrival[pd.driver])
+            set_arrival_time(port, arr.domain, arr.value + pd.route_delay, arr.path_length, pd.driver);
+    }
+}
+
+void TimingAnalyser::gather_required(int port)
+{
+    auto &pd = ports.at(port);
+    for (auto &dom : port_endpoints[port]) {
+        DelayPair init_required;
+        int clock_idx;
+        get_endpoint_required(port, dom.second, init_required, clock_idx);
+        set_required_time(port, dom.first, init_required, 1, clock_idx);
+    }
+    if (pd.type == PORT_IN) {
+        for (auto &arc : comb_fanout[port])
+            for (auto &req : required[arc.first])
+                set_required_time(port, req.domain, req.value - arc.second, req.path_length + 1, arc.first);
+    } else if (pd.type == PORT_OUT) {
+        for (int usr : net_users[port]) {
+            auto &usr_pd = ports.at(usr);
+            for (auto &req : required[usr])
+                set_required_time(port, req.domain, req.value - DelayPair(usr_pd.route_delay.maxDelay()),
+                                  req.path_length, usr);
+        }
+    }
+}
+
 dict<domain_id_t, delay_t> TimingAnalyser::max_delay_by_domain_pairs()
 {
     dict<domain_id_t, delay_t> domain_delay;
@@ -675,11 +1133,10 @@ dict<domain_id_t, delay_t> TimingAnalyser::max_delay_by_domain_pairs()
         const auto &capture = domains.at(capture_id);
 
         for (auto &ep : capture.endpoints) {
-            auto &ep_port = ports.at(ep.first);
+            auto &req = *find_time(required[ep.first], capture_id);
 
-            auto &req = ep_port.required.at(capture_id);
-
-            for (auto &[launch_id, arr] : ep_port.arrival) {
+            for (auto &arr : arrival[ep.first]) {
+                domain_id_t launch_id = arr.domain;
                 const auto &launch = domains.at(capture_id);
 
                 auto dp = domain_pair_id(launch_id, capture_id);
@@ -698,9 +1155,9 @@ dict<domain_id_t, delay_t> TimingAnalyser::max_delay_by_domain_pairs()
                 // to remove the clock delays from the arrival and required times
                 // because the delays have no common reference.
                 if (with_clock_skew && !same_clock && !related_clocks) {
-                    for (auto &fanin : ep_port.cell_arcs) {
+                    for (auto &fanin : cell_arcs[ep.first]) {
                         if (fanin.type == CellArc::SETUP) {
-                            auto clock_delay = ports.at(CellPortKey(ep.first.cell, fanin.other_port)).route_delay;
+                            auto clock_delay = ports.at(fanin.other_idx).route_delay;
                             delay += clock_delay.minDelay();
                         }
                     }
@@ -709,11 +1166,11 @@ dict<domain_id_t, delay_t> TimingAnalyser::max_delay_by_domain_pairs()
                     auto crit_path = walk_crit_path(domain_pair_id(launch_id, capture_id), ep.first, true);
                     auto first_inp = crit_path.back();
                     const auto &sp = first_inp.cell->ports.at(first_inp.port).net->driver;
-                    auto &sp_port = ports.at(CellPortKey{sp.cell->name, sp.port});
+                    int sp_idx = port_index.at(CellPortKey(sp));
 
-                    for (auto &fanin : sp_port.cell_arcs) {
+                    for (auto &fanin : cell_arcs[sp_idx]) {
                         if (fanin.type == CellArc::CLK_TO_Q) {
-                            auto clock_delay = ports.at(CellPortKey(sp.cell->name, fanin.other_port)).route_delay;
+                            auto clock_delay = ports.at(fanin.other_idx).route_delay;
                             delay -= clock_delay.maxDelay();
                         }
                     }
@@ -730,61 +1187,67 @@ dict<domain_id_t, delay_t> TimingAnalyser::max_delay_by_domain_pairs()
 }
 
 void TimingAnalyser::compute_slack()
+{
+    parallel_for(0, int(ports.size()), [&](int p) { compute_port_slack(p); });
+    update_worst_slack();
+}
+
+void TimingAnalyser::update_worst_slack()
 {
     for (auto &dp : domain_pairs) {
         dp.worst_setup_slack = std::numeric_limits<delay_t>::max();
         dp.worst_hold_slack = std::numeric_limits<delay_t>::max();
     }
-    for (auto p : topological_order) {
-        auto &pd = ports.at(p);
-        for (auto &pdp : pd.domain_pairs) {
-            auto &dp = domain_pairs.at(pdp.first);
-
-            // Get clock names
-            const auto &launch_clock = domains.at(dp.key.launch).key.clock;
-            const auto &capture_clock = domains.at(dp.key.capture).key.clock;
-
-            // Get clock-to-clock delay if any
-            delay_t clock_to_clock = 0;
-            auto clocks = std::make_pair(launch_clock, capture_clock);
-            if (clock_delays.count(clocks)) {
-                clock_to_clock = clock_delays.at(clocks);
-            }
+    for (auto &pdp : port_domain_pairs.data) {
+        auto &dp = domain_pairs.at(pdp.domain_pair);
+        dp.worst_setup_slack = std::min(dp.worst_setup_slack, pdp.setup_slack);
+        if (!setup_only)
+            dp.worst_hold_slack = std::min(dp.worst_hold_slack, pdp.hold_slack);
+    }
+}
 
-            auto &arr = pd.arrival.at(dp.key.launch);
-            auto &req = pd.required.at(dp.key.capture);
-            pdp.second.setup_slack = 0 - (arr.value.maxDelay() - req.value.minDelay() + clock_to_clock);
-            if (!setup_only)
-                pdp.second.hold_slack = arr.value.minDelay() - req.value.maxDelay() + clock_to_clock;
-            pdp.second.max_path_length = arr.path_length + req.path_length;
-            if (dp.key.launch == dp.key.capture)
-                pd.worst_setup_slack = std::min(pd.worst_setup_slack, dp.period.minDelay() + pdp.second.setup_slack);
-            dp.worst_setup_slack = std::min(dp.worst_setup_slack, pdp.second.setup_slack);
-            if (!setup_only) {
-                pd.worst_hold_slack = std::min(pd.worst_hold_slack, pdp.second.hold_slack);
-                dp.worst_hold_slack = std::min(dp.worst_hold_slack, pdp.second.hold_slack);
-            }
-        }
+void TimingAnalyser::compute_port_slack(int p)
+{
+    auto &pd = ports.at(p);
+    pd.worst_setup_slack = std::numeric_limits<delay_t>::max();
+    pd.worst_hold_slack = std::numeric_limits<delay_t>::max();
+    for (auto &pdp : port_domain_pairs[p]) {
+        auto &dp = domain_pairs.at(pdp.domain_pair);
+        delay_t clock_to_clock = dp.clock_to_clock;
+
+        auto &arr = *find_time(arrival[p], dp.key.launch);
+        auto &req = *find_time(required[p], dp.key.capture);
+        pdp.setup_slack = 0 - (arr.value.maxDelay() - req.value.minDelay() + clock_to_clock);
+        if (!setup_only)
+            pdp.hold_slack = arr.value.minDelay() - req.value.maxDelay() + clock_to_clock;
+        pdp.max_path_length = arr.path_length + req.path_length;
+        if (dp.key.launch == dp.key.capture)
+            pd.worst_setup_slack = std::min(pd.worst_setup_slack, dp.period.minDelay() + pdp.setup_slack);
+        if (!setup_only)
+            pd.worst_hold_slack = std::min(pd.worst_hold_slack, pdp.hold_slack);
     }
 }
 
 void TimingAnalyser::compute_criticality()
 {
-    for (auto p : topological_order) {
-        auto &pd = ports.at(p);
-        for (auto &pdp : pd.domain_pairs) {
-            auto &dp = domain_pairs.at(pdp.first);
-            // Do not set criticality for asynchronous paths
-            if (domains.at(dp.key.launch).key.is_async() || domains.at(dp.key.capture).key.is_async())
-                continue;
+    parallel_for(0, int(ports.size()), [&](int p) { compute_port_criticality(p); });
+}
 
-            float crit =
-                    1.0f - (float(pdp.second.setup_slack) - float(dp.worst_setup_slack)) / float(-dp.worst_setup_slack);
-            crit = std::min(crit, 1.0f);
-            crit = std::max(crit, 0.0f);
-            pdp.second.criticality = crit;
-            pd.worst_crit = std::max(pd.worst_crit, crit);
-        }
+void TimingAnalyser::compute_port_criticality(int p)
+{
+    auto &pd = ports.at(p);
+    pd.worst_crit = 0;
+    for (auto &pdp : port_domain_pairs[p]) {
+        auto &dp = domain_pairs.at(pdp.domain_pair);
+        // Do not set criticality for asynchronous paths
+        if (domains.at(dp.key.launch).key.is_async() || domains.at(dp.key.capture).key.is_async())
+            continue;
+
+        float crit = 1.0f - (float(pdp.setup_slack) - float(dp.worst_setup_slack)) / float(-dp.worst_setup_slack);
+        crit = std::min(crit, 1.0f);
+        crit = std::max(crit, 0.0f);
+        pdp.criticality = crit;
+        pd.worst_crit = std::max(pd.worst_crit, crit);
     }
 }
 
@@ -796,12 +1259,12 @@ void TimingAnalyser::build_detailed_net_timing_report()
         auto &dom = domains.at(dom_id);
         for (auto &ep : dom.endpoints) {
             auto &pd = ports.at(ep.first);
-            const NetInfo *net = port_info(ep.first).net;
+            const NetInfo *net = pd.net;
 
-            for (auto &arr : pd.arrival) {
-                auto &launch = domains.at(arr.first).key;
-                for (auto &req : pd.required) {
-                    auto &capture = domains.at(req.first).key;
+            for (auto &arr : arrival[ep.first]) {
+                auto &launch = domains.at(arr.domain).key;
+                for (auto &req : required[ep.first]) {
+                    auto &capture = domains.at(req.domain).key;
 
                     NetSinkTiming sink_timing;
                     sink_timing.clock_pair.start.clock = launch.clock;
@@ -809,7 +1272,7 @@ void TimingAnalyser::build_detailed_net_timing_report()
                     sink_timing.clock_pair.end.clock = capture.clock;
                     sink_timing.clock_pair.end.edge = capture.edge;
                     sink_timing.cell_port = std::make_pair(pd.cell_port.cell, pd.cell_port.port);
-                    sink_timing.delay = arr.second.value;
+                    sink_timing.delay = arr.value;
 
                     net_timings[net->name].push_back(sink_timing);
                 }
@@ -818,26 +1281,26 @@ void TimingAnalyser::build_detailed_net_timing_report()
     }
 }
 
-std::vector<CellPortKey> TimingAnalyser::get_worst_eps(domain_id_t domain_pair, int count)
+std::vector<int> TimingAnalyser::get_worst_eps(domain_id_t domain_pair, int count)
 {
-    std::vector<CellPortKey> worst_eps;
+    std::vector<int> worst_eps;
     delay_t last_slack = std::numeric_limits<delay_t>::lowest();
     auto &dp = domain_pairs.at(domain_pair);
     auto &cap_d = domains.at(dp.key.capture);
     while (int(worst_eps.size()) < count) {
-        CellPortKey next;
+        int next = -1;
         delay_t next_slack = std::numeric_limits<delay_t>::max();
         for (auto ep : cap_d.endpoints) {
-            auto &pd = ports.at(ep.first);
-            if (!pd.domain_pairs.count(domain_pair))
+            auto *pdp = find_domain_pair(ep.first, domain_pair);
+            if (pdp == nullptr)
                 continue;
-            delay_t ep_slack = pd.domain_pairs.at(domain_pair).setup_slack;
+            delay_t ep_slack = pdp->setup_slack;
             if (ep_slack < next_slack && ep_slack > last_slack) {
                 next = ep.first;
                 next_slack = ep_slack;
             }
         }
-        if (next == CellPortKey())
+        if (next == -1)
             break;
         worst_eps.push_back(next);
         last_slack = next_slack;
@@ -845,7 +1308,7 @@ std::vector<CellPortKey> TimingAnalyser::get_worst_eps(domain_id_t domain_pair,
     return worst_eps;
 }
 
-std::vector<PortRef> TimingAnalyser::walk_crit_path(domain_id_t domain_pair, CellPortKey endpoint, bool longest_path)
+std::vector<PortRef> TimingAnalyser::walk_crit_path(domain_id_t domain_pair, int endpoint, bool longest_path)
 {
     const auto &dp = domain_pairs.at(domain_pair);
 
@@ -856,8 +1319,8 @@ std::vector<PortRef> TimingAnalyser::walk_crit_path(domain_id_t domain_pair, Cel
 
     bool is_startpoint = false;
     do {
-        auto cell = cell_info(cursor);
-        auto &port = port_info(cursor);
+        auto cell = cell_info(ports.at(cursor).cell_port);
+        auto &port = port_info(ports.at(cursor).cell_port);
         int port_clocks;
         auto portClass = ctx->getPortTimingClass(cell, port.name, port_clocks);
 
@@ -872,22 +1335,22 @@ std::vector<PortRef> TimingAnalyser::walk_crit_path(domain_id_t domain_pair, Cel
         if (is_input)
             crit_path_rev.emplace_back(PortRef{cell, port.name});
 
-        if (!ports.at(cursor).arrival.count(dp.key.launch))
+        auto *arr = find_time(arrival[cursor], dp.key.launch);
+        if (arr == nullptr)
             break;
 
         if (longest_path) {
-            cursor = ports.at(cursor).arrival.at(dp.key.launch).bwd_max;
+            cursor = arr->bwd_max;
         } else {
-            cursor = ports.at(cursor).arrival.at(dp.key.launch).bwd_min;
+            cursor = arr->bwd_min;
         }
         is_startpoint = portClass == TMG_REGISTER_OUTPUT || portClass == TMG_STARTPOINT;
-    } while (!is_startpoint);
+    } while (!is_startpoint && cursor != -1);
 
     return crit_path_rev;
 }
 
-CriticalPath TimingAnalyser::build_critical_path_report(domain_id_t domain_pair, CellPortKey endpoint,
-                                                        bool longest_path)
+CriticalPath TimingAnalyser::build_critical_path_report(domain_id_t domain_pair, int endpoint, bool longest_path)
 {
     CriticalPath report;
 
@@ -1170,12 +1633,10 @@ void TimingAnalyser::build_slack_histogram_report()
 
     for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
         for (auto &ep : domains.at(dom_id).endpoints) {
-            auto &pd = ports.at(ep.first);
-
-            for (auto &req : pd.required) {
-                auto &capture = domains.at(req.first).key;
-                for (auto &arr : pd.arrival) {
-                    auto &launch = domains.at(arr.first).key;
+            for (auto &req : required[ep.first]) {
+                auto &capture = domains.at(req.domain).key;
+                for (auto &arr : arrival[ep.first]) {
+                    auto &launch = domains.at(arr.domain).key;
 
                     if (launch.clock != capture.clock || launch.is_async())
                         continue;
@@ -1187,7 +1648,7 @@ void TimingAnalyser::build_slack_histogram_report()
                     if (launch.edge != capture.edge)
                         clk_period = clk_period / 2;
 
-                    delay_t delay = arr.second.value.maxDelay() - req.second.value.minDelay();
+                    delay_t delay = arr.value.maxDelay() - req.value.minDelay();
                     delay_t slack = clk_period - delay;
 
                     int slack_ps = ctx->getDelayNS(slack) * 1000;
@@ -1207,17 +1668,17 @@ std::vector<CriticalPath> TimingAnalyser::get_min_delay_violations()
         const auto &capture_clock = capture.key.clock;
 
         for (const auto &ep : capture.endpoints) {
-            const CellInfo *ci = cell_info(ep.first);
+            const auto &ep_key = ports.at(ep.first).cell_port;
+            const CellInfo *ci = cell_info(ep_key);
             int clkInfoCount = 0;
-            const TimingPortClass cls = ctx->getPortTimingClass(ci, ep.first.port, clkInfoCount);
+            const TimingPortClass cls = ctx->getPortTimingClass(ci, ep_key.port, clkInfoCount);
             if (cls != TMG_REGISTER_INPUT)
                 continue;
 
-            const auto &port = ports.at(ep.first);
+            const auto &req = *find_time(required[ep.first], capture_id);
 
-            const auto &req = port.required.at(capture_id);
-
-            for (auto &[launch_id, arr] : port.arrival) {
+            for (auto &arr : arrival[ep.first]) {
+                domain_id_t launch_id = arr.domain;
                 const auto &launch = domains.at(launch_id);
                 const auto &launch_clock = launch.key.clock;
                 const auto dom_pair_id = domain_pair_id(launch_id, capture_id);
@@ -1294,14 +1755,6 @@ domain_id_t TimingAnalyser::domain_pair_id(domain_id_t launch, domain_id_t captu
     return inserted.first->second;
 }
 
-void TimingAnalyser::copy_domains(const CellPortKey &from, const CellPortKey &to, bool backward)
-{
-    auto &f = ports.at(from), &t = ports.at(to);
-    for (auto &dom : (backward ? f.required : f.arrival)) {
-        updated_domains |= (backward ? t.required : t.arrival).emplace(dom.first, ArrivReqTime{}).second;
-    }
-}
-
 const std::string TimingAnalyser::arcType_to_str(CellArc::ArcType typ)
 {
     switch (typ) {
@@ -21,6 +21,7 @@
 #ifndef TIMING_H
 #define TIMING_H
 
+#include <memory>
 #include "nextpnr.h"
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -84,13 +85,13 @@ struct TimingAnalyser
     // model), but want to re-run STA with their own calculated delays
     void set_route_delay(CellPortKey port, DelayPair value);
 
-    float get_criticality(CellPortKey port) const { return ports.at(port).worst_crit; }
-    float get_setup_slack(CellPortKey port) const { return ports.at(port).worst_setup_slack; }
+    float get_criticality(CellPortKey port) const { return ports.at(port_index.at(port)).worst_crit; }
+    float get_setup_slack(CellPortKey port) const { return ports.at(port_index.at(port)).worst_setup_slack; }
     float get_domain_setup_slack(CellPortKey port) const
     {
         delay_t slack = std::numeric_limits<delay_t>::max();
-        for (const auto &dp : ports.at(port).domain_pairs)
-            slack = std::min(slack, domain_pairs.at(dp.first).worst_setup_slack);
+        for (const auto &dp : port_domain_pairs[port_index.at(port)])
+            slack = std::min(slack, domain_pairs.at(dp.domain_pair).worst_setup_slack);
         return slack;
     }
 
@@ -105,11 +106,21 @@ struct TimingAnalyser
     bool have_loops = false;
     bool updated_domains = false;
 
+    // When only some route delays changed since the last run, only propagate arrival/required times through the
+    // fan-out/fan-in cones of the changed ports instead of re-walking the whole design. Falls back to a full
+    // analysis if too much of the design is affected.
+    bool incremental = true;
+
+    // Set to 1 to do the levelised walks on the calling thread only; otherwise they use the context's thread pool
+    int threads = 1;
+
   private:
+    // Ports are referred to by a dense index, which after topo_sort is also their position in the topological order
     void init_ports();
     void get_cell_delays();
     void get_route_delays();
     void topo_sort();
+    void renumber_ports(const std::vector<int> &order);
     void setup_port_domains();
     void identify_related_domains();
 
@@ -117,18 +128,41 @@ struct TimingAnalyser
 
     void walk_forward();
     void walk_backward();
+    // Pull the arrival/required times of a single port from its fan-in/fan-out
+    void gather_arrival(int port);
+    void gather_required(int port);
 
     void compute_slack();
+    void update_worst_slack();
     void compute_criticality();
 
+    // Run func(i) for i in [begin, end), across the thread pool if the range is large enough
+    template <typename Tfunc> void parallel_for(int begin, int end, Tfunc func);
+
+    // Initial arrival/required time at a startpoint/endpoint for a given clock port (IdString() if asynchronous)
+    void get_startpoint_arrival(int port, IdString clock_port, DelayPair &arrival, int &clock_idx);
+    void get_endpoint_required(int port, IdString clock_port, DelayPair &required, int &clock_idx);
+
+    // Fan-in/fan-out tables for the levelised walks and incremental analysis
+    void setup_propagation();
+    // Incremental analysis
+    void mark_dirty(int port);
+    void clear_dirty();
+    bool run_incremental();
+    // Recompute the arrival/required times at a port from its fan-in/fan-out; returning true if they changed
+    bool update_arrival(int port);
+    bool update_required(int port);
+    void compute_port_slack(int port);
+    void compute_port_criticality(int port);
+
     // Walk the endpoint back to a startpoint and get back the input ports walked
     // and the startpoint.
-    std::vector<PortRef> walk_crit_path(domain_id_t domain_pair, CellPortKey endpoint, bool longest_path);
+    std::vector<PortRef> walk_crit_path(domain_id_t domain_pair, int endpoint, bool longest_path);
 
     void build_detailed_net_timing_report();
     // longest_path indicate whether to follow the longest or shortest path from endpoint to startpoint
     // longest paths are interesting for setup violations and shortest paths are interesting for hold violations
-    CriticalPath build_critical_path_report(domain_id_t domain_pair, CellPortKey endpoint, bool longest_path);
+    CriticalPath build_critical_path_report(domain_id_t domain_pair, int endpoint, bool longest_path);
     void build_crit_path_reports();
     void build_slack_histogram_report();
 
@@ -137,13 +171,11 @@ struct TimingAnalyser
     dict<domain_id_t, delay_t> max_delay_by_domain_pairs();
 
     // get the N worst endpoints for a given domain pair
-    std::vector<CellPortKey> get_worst_eps(domain_id_t domain_pair, int count);
+    std::vector<int> get_worst_eps(domain_id_t domain_pair, int count);
 
     // Set arrival/required times if more/less than the current value
-    void set_arrival_time(CellPortKey target, domain_id_t domain, DelayPair arrival, int path_length,
-                          CellPortKey prev = CellPortKey());
-    void set_required_time(CellPortKey target, domain_id_t domain, DelayPair required, int path_length,
-                           CellPortKey prev = CellPortKey());
+    void set_arrival_time(int target, domain_id_t domain, DelayPair arrival, int path_length, int prev = -1);
+    void set_required_time(int target, domain_id_t domain, DelayPair required, int path_length, int prev = -1);
 
     // To avoid storing the domain tag structure (which could get large when considering more complex constrained tag
     // cases), assign each domain an ID and use that instead
@@ -151,13 +183,16 @@ struct TimingAnalyser
     // path reporting
     struct ArrivReqTime
     {
+        domain_id_t domain;
         DelayPair value;
-        CellPortKey bwd_min, bwd_max;
+        // index of the previous port on the min/max path, or -1
+        int bwd_min, bwd_max;
         int path_length;
     };
     // Data per port-domain tuple
     struct PortDomainPairData
     {
+        domain_id_t domain_pair;
         delay_t setup_slack = std::numeric_limits<delay_t>::max(), hold_slack = std::numeric_limits<delay_t>::max();
         int max_path_length = 0;
         float criticality = 0;
@@ -178,6 +213,8 @@ struct TimingAnalyser
         } type;
 
         IdString other_port;
+        // index of other_port, or -1 for the asynchronous clock of startpoints and endpoints
+        int other_idx = -1;
         DelayQuad value;
         // Clock polarity, not used for combinational arcs
         ClockEdge edge;
@@ -188,23 +225,52 @@ struct TimingAnalyser
                 : type(type), other_port(other_port), value(value), edge(edge) {};
     };
 
+    template <typename T> struct Span
+    {
+        T *b, *e;
+        T *begin() const { return b; }
+        T *end() const { return e; }
+        size_t size() const { return e - b; }
+        bool empty() const { return b == e; }
+    };
+
+    // Variable-length per port data, stored contiguously in port order: the entries for port i are
+    // data[offset[i]] up to data[offset[i + 1]]
+    template <typename T> struct PortTable
+    {
+        std::vector<int> offset{0};
+        std::vector<T> data;
+
+        Span<T> operator[](int port) { return Span<T>{data.data() + offset[port], data.data() + offset[port + 1]}; }
+        Span<const T> operator[](int port) const
+        {
+            return Span<const T>{data.data() + offset[port], data.data() + offset[port + 1]};
+        }
+        // Entries are added port by port, in index order
+        void end_port() { offset.push_back(int(data.size())); }
+        void clear()
+        {
+            offset.assign(1, 0);
+            data.clear();
+        }
+    };
+
     // Timing data for every cell port
     struct PerPort
     {
         CellPortKey cell_port;
         PortType type;
-        // per domain timings
-        dict<domain_id_t, ArrivReqTime> arrival;
-        dict<domain_id_t, ArrivReqTime> required;
-        dict<domain_id_t, PortDomainPairData> domain_pairs;
-        // cell timing arcs to (outputs)/from (inputs)  from this port
-        std::vector<CellArc> cell_arcs;
+        NetInfo *net = nullptr;
+        // index of the net driver (input and inout ports only), or -1
+        int driver = -1;
         // routing delay into this port (input ports only)
         DelayPair route_delay{0};
         // worst criticality and slack across domain pairs
         float worst_crit = 0;
         delay_t worst_setup_slack = std::numeric_limits<delay_t>::max(),
                 worst_hold_slack = std::numeric_limits<delay_t>::max();
+        // route delay changed since the last run
+        bool dirty = false;
     };
 
     struct PerDomain
@@ -212,7 +278,7 @@ struct TimingAnalyser
         PerDomain(ClockDomainKey key) : key(key) {};
         ClockDomainKey key;
         // these are pairs (signal port; clock port)
-        std::vector<std::pair<CellPortKey, IdString>> startpoints, endpoints;
+        std::vector<std::pair<int, IdString>> startpoints, endpoints;
     };
 
     struct PerDomainPair
@@ -220,9 +286,27 @@ struct TimingAnalyser
         PerDomainPair(ClockDomainPairKey key) : key(key) {};
         ClockDomainPairKey key;
         DelayPair period{0};
+        // Delay between launch and capture clock, if they are related
+        delay_t clock_to_clock = 0;
         delay_t worst_setup_slack, worst_hold_slack;
     };
 
+    // Per port times are sorted by domain, and there are only ever a handful of them
+    template <typename T> static T *find_time(Span<T> times, domain_id_t domain)
+    {
+        for (auto &t : times)
+            if (t.domain == domain)
+                return &t;
+        return nullptr;
+    }
+    PortDomainPairData *find_domain_pair(int port, domain_id_t domain_pair)
+    {
+        for (auto &pdp : port_domain_pairs[port])
+            if (pdp.domain_pair == domain_pair)
+                return &pdp;
+        return nullptr;
+    }
+
     CellInfo *cell_info(const CellPortKey &key);
     PortInfo &port_info(const CellPortKey &key);
 
@@ -230,18 +314,38 @@ struct TimingAnalyser
     domain_id_t domain_id(const NetInfo *net, ClockEdge edge);
     domain_id_t domain_pair_id(domain_id_t launch, domain_id_t capture);
 
-    void copy_domains(const CellPortKey &from, const CellPortKey &to, bool backwards);
-
     [[maybe_unused]] static const std::string arcType_to_str(CellArc::ArcType typ);
 
-    dict<CellPortKey, PerPort> ports;
+    std::vector<PerPort> ports;
+    dict<CellPortKey, int> port_index;
+    // Cell arcs to (outputs)/from (inputs) each port
+    PortTable<CellArc> cell_arcs;
+    // Users of the net driven by each output port
+    PortTable<int> net_users;
+    // Per domain times and per domain pair slacks of each port
+    PortTable<ArrivReqTime> arrival, required;
+    PortTable<PortDomainPairData> port_domain_pairs;
+
     dict<ClockDomainKey, domain_id_t> domain_to_id;
     dict<ClockDomainPairKey, domain_id_t> pair_to_id;
     std::vector<PerDomain> domains;
     std::vector<PerDomainPair> domain_pairs;
     dict<std::pair<IdString, IdString>, delay_t> clock_delays;
 
-    std::vector<CellPortKey> topological_order;
+    // Without combinational loops, ports are ordered by level (longest path from a startpoint) and each level is a
+    // contiguous range of indices, from level_start[i] to level_start[i + 1]. Ports at the same level don't depend
+    // on each other, so are processed in parallel.
+    std::vector<int> level_start;
+
+    // Combinational fan-in/fan-out follow the same cell arcs as walk_forward (input ports' arcs) and walk_backward
+    // (output ports' arcs) respectively. Only set up when there are no combinational loops.
+    PortTable<std::pair<int, DelayPair>> comb_fanin, comb_fanout;
+    PortTable<std::pair<domain_id_t, IdString>> port_startpoints, port_endpoints;
+    // Ports whose route delay changed since the last run
+    std::vector<int> dirty_ports;
+    // Whether the stored times are the result of a complete analysis with the current setup_only
+    bool times_valid = false;
+    bool times_setup_only = false;
 
     domain_id_t async_clock_id;
 
@@ -214,7 +214,7 @@ static void log_fmax(Context *ctx, TimingResult &result, bool warn_on_failure)
 
     unsigned max_width = 0;
     for (auto &clock : result.clock_paths)
-        max_width = std::max<unsigned>(max_width, clock.first.str(ctx).size());
+        max_width = std::max<unsigned>(max_width, clock.first.view(ctx).size());
 
     for (auto &clock : result.clock_paths) {
         const auto &clock_name = clock.first.str(ctx);
@@ -460,4 +460,142 @@ bool DetailPlacerThreadState::add_to_move(CellInfo *cell, BelId old_bel, BelId n
     return true;
 }
 
+bool DetailPlacerThreadState::try_swap_cell(CellInfo *cell, BelId new_bel)
+{
+    NPNR_ASSERT(moved_cells.empty());
+    BelId old_bel = cell->bel;
+    CellInfo *bound = nullptr;
+    {
+#if !defined(NPNR_DISABLE_THREADS)
+        std::shared_lock<std::shared_timed_mutex> l(g.archapi_mutex);
+#endif
+        bound = ctx->getBoundBelCell(new_bel);
+    }
+    if (bound && (bound->belStrength > STRENGTH_STRONG || bound->cluster != ClusterId()))
+        return false;
+    if (!add_to_move(cell, old_bel, new_bel))
+        goto fail;
+    if (bound && !add_to_move(bound, new_bel, old_bel))
+        goto fail;
+    compute_total_change();
+    // SA acceptance criteria
+
+    if (!accept_move()) {
+        // SA fail
+        goto fail;
+    }
+    // Check validity rules
+    if (!bind_move())
+        goto fail;
+    if (!check_validity())
+        goto fail;
+    // Accepted!
+    commit_move();
+    reset_move_state();
+    return true;
+fail:
+    revert_move();
+    reset_move_state();
+    return false;
+}
+
+bool DetailPlacerThreadState::try_swap_chain(CellInfo *root_cell, BelId new_root_bel, bool swap_clusters)
+{
+    NPNR_ASSERT(moved_cells.empty());
+    std::queue<std::pair<ClusterId, BelId>> displaced_clusters;
+    pool<ClusterId> moving_clusters;
+    pool<BelId> used_bels;
+    displaced_clusters.emplace(root_cell->cluster, new_root_bel);
+    moving_clusters.insert(root_cell->cluster);
+    while (!displaced_clusters.empty()) {
+        std::vector<std::pair<CellInfo *, BelId>> dest_bels;
+        auto cursor = displaced_clusters.front();
+        displaced_clusters.pop();
+        if (!ctx->getClusterPlacement(cursor.first, cursor.second, dest_bels))
+            goto fail;
+        for (const auto &db : dest_bels) {
+            BelId old_bel = db.first->bel;
+            if (moved_cells.count(db.first->name))
+                goto fail;
+            if (!add_to_move(db.first, old_bel, db.second))
+                goto fail;
+            if (used_bels.count(db.second))
+                goto fail;
+            used_bels.insert(db.second);
+            CellInfo *bound = nullptr;
+            {
+#if !defined(NPNR_DISABLE_THREADS)
+                std::shared_lock<std::shared_timed_mutex> l(g.archapi_mutex);
+#endif
+                bound = ctx->getBoundBelCell(db.second);
+            }
+            if (bound) {
+                if (swap_clusters && (moved_cells.count(bound->name) ||
+                                      (bound->cluster != ClusterId() && moving_clusters.count(bound->cluster)))) {
+                    // Already part of this move, so will be leaving this bel; used_bels stops two cells ending up
+                    // in it
+                } else if (moved_cells.count(bound->name)) {
+                    // Don't move a cell multiple times in the same go
+                    goto fail;
+                } else if (bound->belStrength > STRENGTH_STRONG) {
+                    goto fail;
+                } else if (bound->cluster != ClusterId()) {
+                    // Displace the entire cluster
+                    Loc old_loc = ctx->getBelLocation(old_bel);
+                    Loc bound_loc = ctx->getBelLocation(bound->bel);
+                    Loc root_loc = ctx->getBelLocation(ctx->getClusterRootCell(bound->cluster)->bel);
+                    Loc new_loc(old_loc.x + (root_loc.x - bound_loc.x), old_loc.y + (root_loc.y - bound_loc.y),
+                                old_loc.z + (root_loc.z - bound_loc.z));
+                    if (new_loc.x < 0 || new_loc.x >= ctx->getGridDimX())
+                        goto fail;
+                    if (new_loc.y < 0 || new_loc.y >= ctx->getGridDimY())
+                        goto fail;
+                    BelId new_root = ctx->getBelByLocation(new_loc);
+                    if (new_root == BelId())
+                        goto fail;
+                    displaced_clusters.emplace(bound->cluster, new_root);
+                    moving_clusters.insert(bound->cluster);
+                } else {
+                    // Single cell swap
+                    if (used_bels.count(old_bel))
+                        goto fail;
+                    used_bels.insert(old_bel);
+                    if (!add_to_move(bound, bound->bel, old_bel))
+                        goto fail;
+                }
+            } else {
+                bool avail = false;
+                {
+#if !defined(NPNR_DISABLE_THREADS)
+                    std::shared_lock<std::shared_timed_mutex> l(g.archapi_mutex);
+#endif
+                    avail = ctx->checkBelAvail(db.second);
+                }
+                if (!avail)
+                    goto fail;
+            }
+        }
+    }
+    compute_total_change();
+    // SA acceptance criteria
+
+    if (!accept_move()) {
+        // SA fail
+        goto fail;
+    }
+    // Check validity rules
+    if (!bind_move())
+        goto fail;
+    if (!check_validity())
+        goto fail;
+    // Accepted!
+    commit_move();
+    reset_move_state();
+    return true;
+fail:
+    revert_move();
+    reset_move_state();
+    return false;
+}
+
 NEXTPNR_NAMESPACE_END
@@ -39,6 +39,9 @@ and it should be aborted. check_validity must then be called to use the arch API
 
 Finally if the move meets criteria and is accepted then commit_move marks it as committed, otherwise revert_move
 aborts the entire move transaction.
+
+try_swap_cell and try_swap_chain wrap this whole sequence up for the two common kinds of move, with the placer
+deciding whether to accept each one through accept_move.
 */
 
 #ifndef DETAIL_PLACE_CORE_H
@@ -217,6 +220,17 @@ struct DetailPlacerThreadState
     void compute_changes_for_cell(CellInfo *cell, BelId old_bel, BelId new_bel);
     // Update the total cost change for an inflight move
     void compute_total_change();
+
+    // Whether to accept an inflight move given its cost change, called by the move functions below once the costs of
+    // a move are known; provided by the placer
+    virtual bool accept_move() = 0;
+    // Attempt to move a cell to a new bel, swapping it with any unconstrained cell already there. Returns true if the
+    // move was made
+    bool try_swap_cell(CellInfo *cell, BelId new_bel);
+    // Attempt to move a cluster to a new root bel, displacing any single cells or entire clusters in the way. Unless
+    // swap_clusters is set, a displaced cluster can't go where the moved one was, so two clusters can't trade places.
+    // Returns true if the move was made
+    bool try_swap_chain(CellInfo *root_cell, BelId new_root_bel, bool swap_clusters = false);
 };
 
 NEXTPNR_NAMESPACE_END
@@ -21,6 +21,7 @@
 #pragma once
 
 #include <cstddef>
+#include <iterator>
 #include "nextpnr.h"
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -57,23 +58,14 @@ struct FastBels
         NPNR_ASSERT(bel_data.get() == nullptr);
         bel_data = std::make_unique<FastBelsData>();
 
-        for (auto bel : ctx->getBels()) {
-            if (!ctx->isValidBelForCellType(cell_type, bel)) {
-                continue;
-            }
-
-            cell_type_data.number_of_possible_bels += 1;
-        }
+        const auto &type_bels = ctx->getBelsForCellType(cell_type);
+        cell_type_data.number_of_possible_bels = int(type_bels.size());
 
-        for (auto bel : ctx->getBels()) {
+        for (auto bel : type_bels) {
             if (check_bel_available && !ctx->checkBelAvail(bel)) {
                 continue;
             }
 
-            if (!ctx->isValidBelForCellType(cell_type, bel)) {
-                continue;
-            }
-
             Loc loc = ctx->getBelLocation(bel);
             if (minBelsForGridPick >= 0 && cell_type_data.number_of_possible_bels < minBelsForGridPick) {
                 loc.x = loc.y = 0;
@@ -108,20 +100,24 @@ struct FastBels
         NPNR_ASSERT(bel_data.get() == nullptr);
         bel_data = std::make_unique<FastBelsData>();
 
-        for (auto bel : ctx->getBels()) {
-            if (ctx->getBelBucketForBel(bel) != partition) {
-                continue;
+        // Buckets are a cover of all bels that the arch has already built, so there is no need to search every bel
+        // for the ones in this bucket. getBelsInBucket is only defined for the buckets the arch knows about, though.
+        bool known_bucket = false;
+        for (auto bucket : ctx->getBelBuckets()) {
+            if (bucket == partition) {
+                known_bucket = true;
+                break;
             }
-
-            type_data.number_of_possible_bels += 1;
+        }
+        if (!known_bucket) {
+            return;
         }
 
-        for (auto bel : ctx->getBels()) {
-            if (check_bel_available && !ctx->checkBelAvail(bel)) {
-                continue;
-            }
+        auto &&bucket_bels = ctx->getBelsInBucket(partition);
+        type_data.number_of_possible_bels = int(std::distance(bucket_bels.begin(), bucket_bels.end()));
 
-            if (ctx->getBelBucketForBel(bel) != partition) {
+        for (auto bel : bucket_bels) {
+            if (check_bel_available && !ctx->checkBelAvail(bel)) {
                 continue;
             }
 
@@ -27,9 +27,7 @@
 
 #include <chrono>
 #include <mutex>
-#include <queue>
 #include <shared_mutex>
-#include <thread>
 
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -56,7 +54,7 @@ struct ThreadState : DetailPlacerThreadState
 
     dict<std::pair<int, int>, std::vector<CellInfo *>> tile2cell;
 
-    bool accept_move()
+    bool accept_move() override
     {
         static constexpr double epsilon = 1e-20;
         double delta = g.cfg.lambda * (timing_delta / std::max<double>(epsilon, g.total_timing_cost)) +
@@ -65,133 +63,6 @@ struct ThreadState : DetailPlacerThreadState
                (g.temperature > 1e-8 && (rng.rng() / float(0x3fffffff)) <= std::exp(-delta / g.temperature));
     }
 
-    bool single_cell_swap(CellInfo *cell, BelId new_bel)
-    {
-        NPNR_ASSERT(moved_cells.empty());
-        BelId old_bel = cell->bel;
-        CellInfo *bound = nullptr;
-        {
-#if !defined(NPNR_DISABLE_THREADS)
-            std::shared_lock<std::shared_timed_mutex> l(g.archapi_mutex);
-#endif
-            bound = ctx->getBoundBelCell(new_bel);
-        }
-        if (bound && (bound->belStrength > STRENGTH_STRONG || bound->cluster != ClusterId()))
-            return false;
-        if (!add_to_move(cell, old_bel, new_bel))
-            goto fail;
-        if (bound && !add_to_move(bound, new_bel, old_bel))
-            goto fail;
-        compute_total_change();
-        // SA acceptance criteria
-
-        if (!accept_move()) {
-            // SA fail
-            goto fail;
-        }
-        // Check validity rules
-        if (!bind_move())
-            goto fail;
-        if (!check_validity())
-            goto fail;
-        // Accepted!
-        commit_move();
-        reset_move_state();
-        return true;
-    fail:
-        revert_move();
-        reset_move_state();
-        return false;
-    }
-
-    bool chain_swap(CellInfo *root_cell, BelId new_root_bel)
-    {
-        NPNR_ASSERT(moved_cells.empty());
-        std::queue<std::pair<ClusterId, BelId>> displaced_clusters;
-        pool<BelId> used_bels;
-        displaced_clusters.emplace(root_cell->cluster, new_root_bel);
-        while (!displaced_clusters.empty()) {
-            std::vector<std::pair<CellInfo *, BelId>> dest_bels;
-            auto cursor = displaced_clusters.front();
-            displaced_clusters.pop();
-            if (!ctx->getClusterPlacement(cursor.first, cursor.second, dest_bels))
-                goto fail;
-            for (const auto &db : dest_bels) {
-                BelId old_bel = db.first->bel;
-                if (moved_cells.count(db.first->name))
-                    goto fail;
-                if (!add_to_move(db.first, old_bel, db.second))
-                    goto fail;
-                if (used_bels.count(db.second))
-                    goto fail;
-                used_bels.insert(db.second);
-                CellInfo *bound = nullptr;
-                {
-#if !defined(NPNR_DISABLE_THREADS)
-                    std::shared_lock<std::shared_timed_mutex> l(g.archapi_mutex);
-#endif
-                    bound = ctx->getBoundBelCell(db.second);
-                }
-                if (bound) {
-                    if (moved_cells.count(bound->name)) {
-                        // Don't move a cell multiple times in the same go
-                        goto fail;
-                    } else if (bound->belStrength > STRENGTH_STRONG) {
-                        goto fail;
-                    } else if (bound->cluster != ClusterId()) {
-                        // Displace the entire cluster
-                        Loc old_loc = ctx->getBelLocation(old_bel);
-                        Loc bound_loc = ctx->getBelLocation(bound->bel);
-                        Loc root_loc = ctx->getBelLocation(ctx->getClusterRootCell(bound->cluster)->bel);
-                        BelId new_root = ctx->getBelByLocation(Loc(old_loc.x + (root_loc.x - bound_loc.x),
-                                                                   old_loc.y + (root_loc.y - bound_loc.y),
-                                                                   old_loc.z + (root_loc.z - bound_loc.z)));
-                        if (new_root == BelId())
-                            goto fail;
-                        displaced_clusters.emplace(bound->cluster, new_root);
-                    } else {
-                        // Single cell swap
-                        if (used_bels.count(old_bel))
-                            goto fail;
-                        used_bels.insert(old_bel);
-                        if (!add_to_move(bound, bound->bel, old_bel))
-                            goto fail;
-                    }
-                } else {
-                    bool avail = false;
-                    {
-#if !defined(NPNR_DISABLE_THREADS)
-                        std::shared_lock<std::shared_timed_mutex> l(g.archapi_mutex);
-#endif
-                        avail = ctx->checkBelAvail(db.second);
-                    }
-                    if (!avail)
-                        goto fail;
-                }
-            }
-        }
-        compute_total_change();
-        // SA acceptance criteria
-
-        if (!accept_move()) {
-            // SA fail
-            goto fail;
-        }
-        // Check validity rules
-        if (!bind_move())
-            goto fail;
-        if (!check_validity())
-            goto fail;
-        // Accepted!
-        commit_move();
-        reset_move_state();
-        return true;
-    fail:
-        revert_move();
-        reset_move_state();
-        return false;
-    }
-
     BelId random_bel_for_cell(CellInfo *cell, int force_z = -1)
     {
         IdString targetType = cell->type;
@@ -347,14 +218,14 @@ struct ThreadState : DetailPlacerThreadState
                     if (new_root == BelId() || new_root == cell->bel)
                         continue;
                     ++n_move;
-                    if (chain_swap(cell, new_root))
+                    if (try_swap_chain(cell, new_root))
                         ++n_accept;
                 } else {
                     BelId new_bel = random_bel_for_cell(cell);
                     if (new_bel == BelId() || new_bel == cell->bel)
                         continue;
                     ++n_move;
-                    if (single_cell_swap(cell, new_bel))
+                    if (try_swap_cell(cell, new_bel))
                         ++n_accept;
                 }
             }
@@ -438,13 +309,7 @@ struct ParallelRefine
         }
 
         NPNR_ASSERT(parts.size() == t.size());
-        // TODO: thread pool to make this worthwhile...
-        std::vector<std::thread> workers;
-        for (size_t i = 0; i < t.size(); i++) {
-            workers.emplace_back([i, this]() { t.at(i).set_partition(parts.at(i)); });
-        }
-        for (auto &w : workers)
-            w.join();
+        ctx->getThreadPool().run(int(t.size()), [this](int i) { t.at(i).set_partition(parts.at(i)); });
     }
 
     void run()
@@ -498,12 +363,7 @@ struct ParallelRefine
 
             do_partition();
 
-            std::vector<std::thread> workers;
-            workers.reserve(t.size());
-            for (int j = 0; j < int(t.size()); j++)
-                workers.emplace_back([this, j]() { t.at(j).run_iter(); });
-            for (auto &w : workers)
-                w.join();
+            ctx->getThreadPool().run(int(t.size()), [this](int j) { t.at(j).run_iter(); });
             g.tmg.run();
             g.update_global_costs();
             iter++;
@@ -517,7 +377,7 @@ struct ParallelRefine
 
 ParallelRefineCfg::ParallelRefineCfg(Context *ctx) : DetailPlaceCfg(ctx)
 {
-    threads = ctx->setting<int>("threads", 8);
+    threads = ctx->getThreadCount();
     // snap to nearest power of two; and minimum thread size
     int actual_threads = 1;
     while ((actual_threads * 2) <= threads && (int(ctx->cells.size()) / (actual_threads * 2)) >= min_thread_size)
@@ -39,6 +39,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <vector>
+#include "detail_place_core.h"
 #include "fast_bels.h"
 #include "log.h"
 #include "place_common.h"
@@ -65,7 +66,8 @@ class SAPlacer
 
   public:
     SAPlacer(Context *ctx, Placer1Cfg cfg)
-            : ctx(ctx), fast_bels(ctx, /*check_bel_available=*/false, cfg.minBelsForGridPick), cfg(cfg), tmg(ctx)
+            : ctx(ctx), fast_bels(ctx, /*check_bel_available=*/false, cfg.minBelsForGridPick), cfg(cfg),
+              detail_cfg(ctx)
     {
         for (auto bel : ctx->getBels()) {
             Loc loc = ctx->getBelLocation(bel);
@@ -97,6 +99,23 @@ class SAPlacer
             net.second->udata = n++;
             net_by_udata.push_back(net.second.get());
         }
+#if !defined(NPNR_DISABLE_THREADS)
+        // As for parallel refinement, use a power of two threads and don't make the partitions too small to be useful
+        while (anneal_thread_count * 2 <= cfg.threads &&
+               int(ctx->cells.size()) / (anneal_thread_count * 2) >= min_cells_per_thread)
+            anneal_thread_count *= 2;
+#endif
+        if (anneal_thread_count > 1) {
+            detail_cfg.timing_driven = cfg.timing_driven;
+            detail_cfg.hpwl_scale_x = cfg.hpwl_scale_x;
+            detail_cfg.hpwl_scale_y = cfg.hpwl_scale_y;
+            detail = std::make_unique<DetailPlacerState>(ctx, detail_cfg);
+            detail->flat_nets = net_by_udata;
+            tmg = &detail->tmg;
+        } else {
+            serial_tmg = std::make_unique<TimingAnalyser>(ctx);
+            tmg = serial_tmg.get();
+        }
         for (auto &region : ctx->region) {
             Region *r = region.second.get();
             BoundingBox bb;
@@ -237,8 +256,8 @@ class SAPlacer
         auto saplace_start = std::chrono::high_resolution_clock::now();
 
         // Invoke timing analysis to obtain criticalities
-        tmg.setup_only = true;
-        tmg.setup();
+        tmg->setup_only = true;
+        tmg->setup();
 
         // Calculate costs after initial placement
         setup_costs();
@@ -267,22 +286,26 @@ class SAPlacer
                          "%.0f, wirelen = %.0f\n",
                          iter, temp, double(curr_timing_cost), double(curr_wirelen_cost));
 
-            for (int m = 0; m < 15; ++m) {
-                // Loop through all automatically placed cells
-                for (auto cell : autoplaced) {
-                    // Find another random Bel for this cell
-                    BelId try_bel = random_bel_for_cell(cell);
-                    // If valid, try and swap to a new position and see if
-                    // the new position is valid/worthwhile
-                    if (try_bel != BelId() && try_bel != cell->bel)
-                        try_swap_position(cell, try_bel);
-                }
-                // Also try swapping chains, if applicable
-                for (auto cb : chain_basis) {
-                    Loc chain_base_loc = ctx->getBelLocation(cb->bel);
-                    BelId try_base = random_bel_for_cell(cb, chain_base_loc.z);
-                    if (try_base != BelId() && try_base != cb->bel)
-                        try_swap_chain(cb, try_base);
+            if (use_parallel_anneal()) {
+                anneal_parallel(autoplaced, chain_basis);
+            } else {
+                for (int m = 0; m < 15; ++m) {
+                    // Loop through all automatically placed cells
+                    for (auto cell : autoplaced) {
+                        // Find another random Bel for this cell
+                        BelId try_bel = random_bel_for_cell(cell);
+                        // If valid, try and swap to a new position and see if
+                        // the new position is valid/worthwhile
+                        if (try_bel != BelId() && try_bel != cell->bel)
+                            try_swap_position(cell, try_bel);
+                    }
+                    // Also try swapping chains, if applicable
+                    for (auto cb : chain_basis) {
+                        Loc chain_base_loc = ctx->getBelLocation(cb->bel);
+                        BelId try_base = random_bel_for_cell(cb, chain_base_loc.z);
+                        if (try_base != BelId() && try_base != cb->bel)
+                            try_swap_chain(cb, try_base);
+                    }
                 }
             }
 
@@ -371,7 +394,7 @@ class SAPlacer
 
             // Invoke timing analysis to obtain criticalities
             if (cfg.timing_driven)
-                tmg.run();
+                tmg->run();
             // Need to rebuild costs after criticalities change
             setup_costs();
             // Reset incremental bounds
@@ -780,6 +803,195 @@ class SAPlacer
         }
     }
 
+    // One thread of parallel annealing, moving the cells of one partition of the design with the transactional moves
+    // of detail_place_core so it doesn't interfere with the other threads
+    struct AnnealThread : DetailPlacerThreadState
+    {
+        AnnealThread(SAPlacer *placer, int idx)
+                : DetailPlacerThreadState(placer->ctx, *placer->detail, idx), placer(placer) {};
+        SAPlacer *placer;
+        int n_move = 0, n_accept = 0;
+        bool accepted = false;
+
+        bool accept_move() override
+        {
+            static constexpr double epsilon = 1e-20;
+            ++n_move;
+            double delta = placer->lambda * (timing_delta / std::max<double>(g.total_timing_cost, epsilon)) +
+                           (1 - placer->lambda) * (double(wirelen_delta) / std::max<double>(g.total_wirelen, epsilon));
+            accepted = delta < 0 ||
+                       (placer->temp > 1e-8 && (rng.rng() / float(0x3fffffff)) <= std::exp(-delta / placer->temp));
+            return accepted;
+        }
+
+        // The serial placer checks a move is legal before costing it, so doesn't count illegal moves towards the
+        // acceptance rate that sets the cooling schedule; here legality is checked after acceptance and the move
+        // needs to be taken back out of the count
+        void count_move(bool success)
+        {
+            if (success)
+                ++n_accept;
+            else if (accepted)
+                --n_move;
+            accepted = false;
+        }
+
+        // As SAPlacer::random_bel_for_cell, but only returning bels inside the partition; giving up if none turn up, as
+        // there might not be any. The window is clipped to the partition, so that long moves early on, which mostly
+        // reach outside it, aren't wasted.
+        BelId random_bel_for_cell(CellInfo *cell, int force_z = -1)
+        {
+            Loc curr_loc = ctx->getBelLocation(cell->bel);
+            int dx = placer->diameter, dy = placer->diameter;
+            if (cell->region != nullptr && cell->region->constr_bels) {
+                const BoundingBox &rb = placer->region_bounds.at(cell->region->name);
+                dx = std::min(placer->cfg.hpwl_scale_x * placer->diameter, (rb.x1 - rb.x0) + 1);
+                dy = std::min(placer->cfg.hpwl_scale_y * placer->diameter, (rb.y1 - rb.y0) + 1);
+                curr_loc.x = std::min(std::max(rb.x0, curr_loc.x), rb.x1);
+                curr_loc.y = std::min(std::max(rb.y0, curr_loc.y), rb.y1);
+            }
+
+            int wx0 = std::max(curr_loc.x - dx, p.x0), wx1 = std::min(curr_loc.x + dx, p.x1);
+            int wy0 = std::max(curr_loc.y - dy, p.y0), wy1 = std::min(curr_loc.y + dy, p.y1);
+            if (wx0 > wx1 || wy0 > wy1)
+                return BelId();
+
+            FastBels::FastBelsData *bel_data;
+            auto type_cnt = placer->fast_bels.getBelsForCellType(cell->type, &bel_data);
+
+            for (int attempt = 0; attempt < 100; attempt++) {
+                int nx = wx0 + rng.rng(wx1 - wx0 + 1);
+                int ny = wy0 + rng.rng(wy1 - wy0 + 1);
+                if (placer->cfg.minBelsForGridPick >= 0 && type_cnt < placer->cfg.minBelsForGridPick)
+                    nx = ny = 0;
+                if (nx >= int(bel_data->size()))
+                    continue;
+                if (ny >= int(bel_data->at(nx).size()))
+                    continue;
+                const auto &fb = bel_data->at(nx).at(ny);
+                if (fb.size() == 0)
+                    continue;
+                BelId bel = fb.at(rng.rng(int(fb.size())));
+                if (!bounds_check(bel))
+                    continue;
+                if (force_z != -1 && ctx->getBelLocation(bel).z != force_z)
+                    continue;
+                if (!cell->testRegion(bel))
+                    continue;
+                if (placer->locked_bels.count(bel))
+                    continue;
+                return bel;
+            }
+            return BelId();
+        }
+
+        void run_iter()
+        {
+            setup_initial_state();
+            n_move = n_accept = 0;
+            std::vector<CellInfo *> cells, chains;
+            for (auto cell : p.cells) {
+                if (placer->parallel_chains.count(cell->name))
+                    chains.push_back(cell);
+                else if (placer->parallel_cells.count(cell->name))
+                    cells.push_back(cell);
+            }
+            for (int m = 0; m < 15; ++m) {
+                for (auto cell : cells) {
+                    BelId try_bel = random_bel_for_cell(cell);
+                    if (try_bel != BelId() && try_bel != cell->bel)
+                        count_move(try_swap_cell(cell, try_bel));
+                }
+                for (auto cb : chains) {
+                    BelId try_base = random_bel_for_cell(cb, ctx->getBelLocation(cb->bel).z);
+                    if (try_base != BelId() && try_base != cb->bel)
+                        count_move(try_swap_chain(cb, try_base, /*swap_clusters=*/true));
+                }
+            }
+        }
+    };
+
+    bool use_parallel_anneal() const
+    {
+        // The global spreading before legalisation, which is most of the iterations, runs in parallel. Once legal,
+        // the final refinement is left serial, as that is where moves between partitions matter most to QoR. The net
+        // sharing cost is global state, so can't be used with partitions at all
+        return anneal_thread_count > 1 && cfg.netShareWeight <= 0 && require_legal;
+    }
+
+    // One iteration's worth of moves, made by splitting the design into a partition per thread that only moves cells
+    // within that partition
+    void anneal_parallel(const std::vector<CellInfo *> &cells, const std::vector<CellInfo *> &chains)
+    {
+        if (anneal_threads.empty()) {
+            log_info("Using %d threads for annealing.\n", anneal_thread_count);
+            for (int i = 0; i < anneal_thread_count; i++)
+                anneal_threads.emplace_back(this, i);
+        }
+        // Until clusters are legalised their cells are moved individually, with a cost for how far they are from a
+        // legal placement relative to the rest of the cluster. That depends on cells that may be in other partitions,
+        // so those moves are still made serially afterwards
+        std::vector<CellInfo *> serial_cells;
+        parallel_cells.clear();
+        parallel_chains.clear();
+        for (auto cell : cells) {
+            if (require_legal && cell->cluster != ClusterId())
+                serial_cells.push_back(cell);
+            else
+                parallel_cells.insert(cell->name);
+        }
+        for (auto cell : chains)
+            parallel_chains.insert(cell->name);
+
+        // Cells can only move within their own partition, from the very first iteration when moves span the whole
+        // device. The partitions are redrawn every iteration, with random pivots and alternating which axis is split
+        // first, so that over a few iterations any cell can still get anywhere.
+        std::vector<PlacePartition> parts;
+        parts.emplace_back(ctx);
+        bool yaxis = split_y_first;
+        split_y_first = !split_y_first;
+        while (parts.size() < anneal_threads.size()) {
+            std::vector<PlacePartition> next(parts.size() * 2);
+            for (size_t i = 0; i < parts.size(); i++) {
+                // Unlike refinement, annealing spends many iterations at each move size, so the boundaries need to
+                // move a long way for cells near one to eventually be able to cross it
+                const float delta = 0.5;
+                float pivot = (0.5 - (delta / 2)) + delta * (ctx->rng(10000) / 10000.0f);
+                parts.at(i).split(ctx, yaxis, pivot, next.at(i * 2), next.at(i * 2 + 1));
+            }
+            std::swap(parts, next);
+            yaxis = !yaxis;
+        }
+        for (auto &t : anneal_threads)
+            t.rng.rngseed(ctx->rng64());
+
+        detail->update_global_costs();
+        // Setting up a partition looks at cells in the others, so must finish everywhere before any moves are made
+        ctx->getThreadPool().run(int(anneal_threads.size()),
+                                 [&](int i) { anneal_threads.at(i).set_partition(parts.at(i)); });
+        ctx->getThreadPool().run(int(anneal_threads.size()), [&](int i) { anneal_threads.at(i).run_iter(); });
+        for (auto &t : anneal_threads) {
+            n_move += t.n_move;
+            n_accept += t.n_accept;
+        }
+
+        // The threads only kept track of costs within their partitions
+        setup_costs();
+        curr_wirelen_cost = total_wirelen_cost();
+        curr_timing_cost = total_timing_cost();
+        last_wirelen_cost = curr_wirelen_cost;
+        last_timing_cost = curr_timing_cost;
+        moveChange.new_net_bounds = net_bounds;
+
+        for (int m = 0; m < 15 && !serial_cells.empty(); ++m) {
+            for (auto cell : serial_cells) {
+                BelId try_bel = random_bel_for_cell(cell);
+                if (try_bel != BelId() && try_bel != cell->bel)
+                    try_swap_position(cell, try_bel);
+            }
+        }
+    }
+
     // Return true if a net is to be entirely ignored
     inline bool ignore_net(NetInfo *net)
     {
@@ -843,7 +1055,7 @@ class SAPlacer
         if (ctx->getPortTimingClass(net->driver.cell, net->driver.port, cc) == TMG_IGNORE)
             return 0;
 
-        float crit = tmg.get_criticality(CellPortKey(user));
+        float crit = tmg->get_criticality(CellPortKey(user));
         double delay = ctx->getDelayNS(ctx->predictArcDelay(net, user));
         return delay * std::pow(crit, crit_exp);
     }
@@ -1227,7 +1439,17 @@ class SAPlacer
     const int legalise_dia = 4;
     Placer1Cfg cfg;
 
-    TimingAnalyser tmg;
+    // Parallel annealing, only set up if more than one thread is to be used. The serial parts of the placer then use
+    // its timing analyser, so that both see the same criticalities; otherwise they have one of their own.
+    DetailPlaceCfg detail_cfg;
+    std::unique_ptr<DetailPlacerState> detail;
+    std::unique_ptr<TimingAnalyser> serial_tmg;
+    TimingAnalyser *tmg = nullptr;
+    const int min_cells_per_thread = 500;
+    int anneal_thread_count = 1;
+    std::vector<AnnealThread> anneal_threads;
+    bool split_y_first = false;
+    pool<IdString> parallel_cells, parallel_chains;
 };
 
 Placer1Cfg::Placer1Cfg(Context *ctx)
@@ -1241,6 +1463,9 @@ Placer1Cfg::Placer1Cfg(Context *ctx)
     slack_redist_iter = ctx->setting<int>("slack_redist_iter");
     hpwl_scale_x = 1;
     hpwl_scale_y = 1;
+    // Parallel annealing doesn't give the same placement as the serial placer, so is only used if asked for
+    // specifically. Other passes' "threads" setting doesn't turn it on, as that can be left in a saved design.
+    threads = int_or_default(ctx->settings, ctx->id("placer1/threads"), 1);
 }
 
 bool placer1(Context *ctx, Placer1Cfg cfg)
@@ -34,6 +34,7 @@
 #include "placer_heap.h"
 #include <Eigen/Core>
 #include <Eigen/IterativeLinearSolvers>
+#include <atomic>
 #include <boost/optional.hpp>
 #include <chrono>
 #include <deque>
@@ -48,6 +49,7 @@
 #include "place_common.h"
 #include "placer1.h"
 #include "scope_lock.h"
+#include "thread_pool.h"
 #include "timing.h"
 #include "util.h"
 
@@ -60,7 +62,10 @@ namespace {
 template <typename T> struct EquationSystem
 {
 
-    EquationSystem(size_t rows, size_t cols)
+    EquationSystem() {}
+    EquationSystem(size_t rows, size_t cols) { resize(rows, cols); }
+
+    void resize(size_t rows, size_t cols)
     {
         A.resize(cols);
         rhs.resize(rows);
@@ -97,7 +102,8 @@ template <typename T> struct EquationSystem
 
     void add_rhs(int row, T val) { rhs[row] += val; }
 
-    void solve(std::vector<T> &x, float tolerance)
+    // Solve using Eigen's ConjugateGradient
+    void solve_eigen(std::vector<T> &x, float tolerance)
     {
         using namespace Eigen;
         if (x.empty())
@@ -130,6 +136,156 @@ template <typename T> struct EquationSystem
         // for (int i = 0; i < int(x.size()); i++)
         //    log_info("x[%d] = %f\n", i, x.at(i));
     }
+
+    // Compressed sparse row copy of A for solve_pcg; as A is symmetric, its columns double as rows. These buffers are
+    // kept between solves, and the column indices are only rewritten when the sparsity pattern changes.
+    std::vector<int> row_start, row_cols;
+    std::vector<T> row_vals, inv_diag;
+    // CG working vectors
+    std::vector<T> res, z, p, Ap;
+    // Per-block partial dot products, reduced in block order so results don't depend on the thread count
+    std::vector<T> block_dot0, block_dot1, block_dot2;
+    static constexpr int block_size = 2048;
+
+    void update_csr()
+    {
+        int n = int(A.size());
+        bool same_pattern = int(row_start.size()) == (n + 1);
+        if (same_pattern) {
+            for (int i = 0; i < n && same_pattern; i++)
+                same_pattern = (row_start.at(i + 1) - row_start.at(i)) == int(A.at(i).size());
+        }
+        if (!same_pattern) {
+            row_start.resize(n + 1);
+            row_start.at(0) = 0;
+            for (int i = 0; i < n; i++)
+                row_start.at(i + 1) = row_start.at(i) + int(A.at(i).size());
+            row_cols.resize(row_start.at(n));
+            row_vals.resize(row_start.at(n));
+        }
+        inv_diag.resize(n);
+        for (int i = 0; i < n; i++) {
+            T diag = T();
+            int idx = row_start.at(i);
+            for (auto &el : A.at(i)) {
+                if (!same_pattern || row_cols.at(idx) != el.first)
+                    row_cols.at(idx) = el.first;
+                row_vals.at(idx) = el.second;
+                if (el.first == i)
+                    diag = el.second;
+                ++idx;
+            }
+            inv_diag.at(i) = (diag != T()) ? (T(1) / diag) : T(1);
+        }
+    }
+
+    // Jacobi-preconditioned conjugate gradient, warm-started from the incoming x, with the same stopping rule as
+    // Eigen (|b - Ax| <= tolerance * |b|, at most 2n iterations). Rows are processed in fixed-size blocks, spread
+    // over thread_pool if one is given and the system is large enough to be worth it.
+    int solve_pcg(std::vector<T> &x, float tolerance, ThreadPool *thread_pool)
+    {
+        int n = int(A.size());
+        if (n == 0)
+            return 0;
+        NPNR_ASSERT(int(x.size()) == n);
+        update_csr();
+
+        int blocks = (n + block_size - 1) / block_size;
+        res.resize(n);
+        z.resize(n);
+        p.resize(n);
+        Ap.resize(n);
+        block_dot0.resize(blocks);
+        block_dot1.resize(blocks);
+        block_dot2.resize(blocks);
+
+        auto for_blocks = [&](std::function<void(int, int, int)> func) {
+            auto do_block = [&](int b) { func(b, b * block_size, std::min(n, (b + 1) * block_size)); };
+            if (thread_pool != nullptr && blocks > 1)
+                thread_pool->run(blocks, do_block);
+            else
+                for (int b = 0; b < blocks; b++)
+                    do_block(b);
+        };
+        auto reduce = [&](const std::vector<T> &partial) {
+            T sum = T();
+            for (auto v : partial)
+                sum += v;
+            return sum;
+        };
+        auto spmv_row = [&](const std::vector<T> &v, int i) {
+            T sum = T();
+            for (int j = row_start[i]; j < row_start[i + 1]; j++)
+                sum += row_vals[j] * v[row_cols[j]];
+            return sum;
+        };
+
+        // r = b - Ax; z = M^-1 r
+        for_blocks([&](int b, int begin, int end) {
+            T bb = T(), rr = T(), rz = T();
+            for (int i = begin; i < end; i++) {
+                res[i] = rhs[i] - spmv_row(x, i);
+                z[i] = inv_diag[i] * res[i];
+                p[i] = z[i];
+                bb += rhs[i] * rhs[i];
+                rr += res[i] * res[i];
+                rz += res[i] * z[i];
+            }
+            block_dot0[b] = bb;
+            block_dot1[b] = rz;
+            block_dot2[b] = rr;
+        });
+        T rhs_norm2 = reduce(block_dot0);
+        if (rhs_norm2 == T()) {
+            std::fill(x.begin(), x.end(), T());
+            return 0;
+        }
+        T res_norm2 = reduce(block_dot2);
+        T threshold = std::max<T>(T(tolerance) * T(tolerance) * rhs_norm2, std::numeric_limits<T>::min());
+        if (res_norm2 < threshold)
+            return 0;
+        T rz = reduce(block_dot1);
+
+        int iter = 0, max_iters = 2 * n;
+        while (iter < max_iters) {
+            // Ap = A p; alpha = rz / (p . Ap)
+            for_blocks([&](int b, int begin, int end) {
+                T pAp = T();
+                for (int i = begin; i < end; i++) {
+                    Ap[i] = spmv_row(p, i);
+                    pAp += p[i] * Ap[i];
+                }
+                block_dot0[b] = pAp;
+            });
+            T alpha = rz / reduce(block_dot0);
+            // x += alpha p; r -= alpha Ap; z = M^-1 r
+            for_blocks([&](int b, int begin, int end) {
+                T rr = T(), rz_new = T();
+                for (int i = begin; i < end; i++) {
+                    x[i] += alpha * p[i];
+                    res[i] -= alpha * Ap[i];
+                    z[i] = inv_diag[i] * res[i];
+                    rr += res[i] * res[i];
+                    rz_new += res[i] * z[i];
+                }
+                block_dot0[b] = rr;
+                block_dot1[b] = rz_new;
+            });
+            ++iter;
+            res_norm2 = reduce(block_dot0);
+            if (res_norm2 < threshold)
+                break;
+            T rz_new = reduce(block_dot1);
+            T beta = rz_new / rz;
+            rz = rz_new;
+            // p = z + beta p
+            for_blocks([&](int b, int begin, int end) {
+                for (int i = begin; i < end; i++)
+                    p[i] = z[i] + beta * p[i];
+            });
+        }
+        return iter;
+    }
 };
 
 } // namespace
@@ -141,6 +297,8 @@ class HeAPPlacer
             : ctx(ctx), cfg(cfg), fast_bels(ctx, /*check_bel_available=*/true, -1), tmg(ctx)
     {
         Eigen::initParallel();
+        if (cfg.threads > 1)
+            thread_pool = &ctx->getThreadPool();
         tmg.setup_only = true;
         tmg.setup();
 
@@ -164,14 +322,7 @@ class HeAPPlacer
         for (int i = 0; i < 4; i++) {
             setup_solve_cells();
             auto solve_startt = std::chrono::high_resolution_clock::now();
-#ifdef NPNR_DISABLE_THREADS
-            build_solve_direction(false, -1);
-            build_solve_direction(true, -1);
-#else
-            boost::thread xaxis([&]() { build_solve_direction(false, -1); });
-            build_solve_direction(true, -1);
-            xaxis.join();
-#endif
+            solve_both_axes(-1);
             auto solve_endt = std::chrono::high_resolution_clock::now();
             solve_time += std::chrono::duration<double>(solve_endt - solve_startt).count();
 
@@ -233,14 +384,9 @@ class HeAPPlacer
                 auto solve_startt = std::chrono::high_resolution_clock::now();
 
                 // Build the connectivity matrix and run the solver; multithreaded between x and y axes if applicable
-#ifndef NPNR_DISABLE_THREADS
                 if (solve_cells.size() >= 500) {
-                    boost::thread xaxis([&]() { build_solve_direction(false, (iter == 0) ? -1 : iter); });
-                    build_solve_direction(true, (iter == 0) ? -1 : iter);
-                    xaxis.join();
-                } else
-#endif
-                {
+                    solve_both_axes((iter == 0) ? -1 : iter);
+                } else {
                     build_solve_direction(false, (iter == 0) ? -1 : iter);
                     build_solve_direction(true, (iter == 0) ? -1 : iter);
                 }
@@ -360,6 +506,8 @@ class HeAPPlacer
         auto endtt = std::chrono::high_resolution_clock::now();
         log_info("HeAP Placer Time: %.02fs\n", std::chrono::duration<double>(endtt - startt).count());
         log_info("  of which solving equations: %.02fs\n", solve_time);
+        log_info("    building equations: %.02fs, %s solver: %.02fs (summed over x and y)\n",
+                 build_eqn_time[0] + build_eqn_time[1], cfg.solver.c_str(), solver_time[0] + solver_time[1]);
         log_info("  of which spreading cells: %.02fs\n", cl_time);
         log_info("  of which strict legalisation: %.02fs\n", sl_time);
 
@@ -420,6 +568,14 @@ class HeAPPlacer
     dict<ClusterId, int> chain_size;
     // Performance counting
     double solve_time = 0, cl_time = 0, sl_time = 0;
+    // Per axis breakdown of solve_time
+    double build_eqn_time[2] = {0, 0}, solver_time[2] = {0, 0};
+
+    // Per axis equation systems, kept between solves to reuse their allocations
+    EquationSystem<double> axis_eqns[2];
+    // The context's thread pool, used for the x/y axis solves, the solver itself and spreading independent regions;
+    // nullptr when running single threaded
+    ThreadPool *thread_pool = nullptr;
 
     // Place cells with the BEL attribute set to constrain them
     void place_constraints()
@@ -520,13 +676,33 @@ class HeAPPlacer
         }
     }
 
+    // Build and solve the x and y axes, concurrently if running multithreaded
+    void solve_both_axes(int iter)
+    {
+        if (thread_pool == nullptr) {
+            build_solve_direction(false, iter);
+            build_solve_direction(true, iter);
+            return;
+        }
+        ThreadPool::TaskGroup xaxis(*thread_pool);
+        xaxis.spawn([&]() { build_solve_direction(false, iter); });
+        build_solve_direction(true, iter);
+        xaxis.wait();
+    }
+
     // Build and solve in one direction
     void build_solve_direction(bool yaxis, int iter)
     {
+        auto &es = axis_eqns[yaxis];
+        es.resize(solve_cells.size(), solve_cells.size());
         for (int i = 0; i < 5; i++) {
-            EquationSystem<double> esx(solve_cells.size(), solve_cells.size());
-            build_equations(esx, yaxis, iter);
-            solve_equations(esx, yaxis);
+            auto build_startt = std::chrono::high_resolution_clock::now();
+            build_equations(es, yaxis, iter);
+            auto build_endt = std::chrono::high_resolution_clock::now();
+            build_eqn_time[yaxis] += std::chrono::duration<double>(build_endt - build_startt).count();
+            solve_equations(es, yaxis);
+            solver_time[yaxis] +=
+                    std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - build_endt).count();
         }
     }
 
@@ -803,7 +979,10 @@ class HeAPPlacer
         auto cell_pos = [&](CellInfo *cell) { return yaxis ? cell_locs.at(cell->name).y : cell_locs.at(cell->name).x; };
         std::vector<double> vals;
         std::transform(solve_cells.begin(), solve_cells.end(), std::back_inserter(vals), cell_pos);
-        es.solve(vals, cfg.solverTolerance);
+        if (cfg.solver == "eigen")
+            es.solve_eigen(vals, cfg.solverTolerance);
+        else
+            es.solve_pcg(vals, cfg.solverTolerance, thread_pool);
         for (size_t i = 0; i < vals.size(); i++)
             if (yaxis) {
                 cell_locs.at(solve_cells.at(i)->name).rawy = vals.at(i);
@@ -1136,7 +1315,8 @@ class HeAPPlacer
 
     struct SpreaderRegion
     {
-        int id;
+        // Index into CutSpreader::regions; subregions created by cutting aren't stored there and have no id
+        int id = -1;
         int x0, y0, x1, y1;
         std::vector<int> cells, bels;
         bool overused(float beta) const
@@ -1185,13 +1365,15 @@ class HeAPPlacer
 #endif
             }
             expand_regions();
-            std::queue<std::pair<int, bool>> workqueue;
 #if 0
             std::vector<std::pair<double, double>> orig;
             if (ctx->debug)
                 for (auto c : p->solve_cells)
                     orig.emplace_back(p->cell_locs[c->name].rawx, p->cell_locs[c->name].rawy);
 #endif
+            // Regions that survived merging are disjoint, and cutting one only touches the cells and locations inside
+            // it, so they can be spread concurrently in any order without changing the result
+            std::vector<int> top_regions;
             for (auto &r : regions) {
                 if (merged_regions.count(r.id))
                     continue;
@@ -1202,26 +1384,17 @@ class HeAPPlacer
                 }
 
 #endif
-                workqueue.emplace(r.id, false);
+                top_regions.push_back(r.id);
             }
-            while (!workqueue.empty()) {
-                auto front = workqueue.front();
-                workqueue.pop();
-                auto &r = regions.at(front.first);
-                if (std::all_of(r.cells.begin(), r.cells.end(), [](int x) { return x == 0; }))
-                    continue;
-                auto res = cut_region(r, front.second);
-                if (res) {
-                    workqueue.emplace(res->first, !front.second);
-                    workqueue.emplace(res->second, !front.second);
-                } else {
-                    // Try the other dir, in case stuck in one direction only
-                    auto res2 = cut_region(r, !front.second);
-                    if (res2) {
-                        workqueue.emplace(res2->first, front.second);
-                        workqueue.emplace(res2->second, front.second);
-                    }
-                }
+            if (p->thread_pool != nullptr && top_regions.size() > 1) {
+                // Regions vary a lot in size, so rather than a fixed split each thread picks up the next region
+                p->thread_pool->parallel_for(int(top_regions.size()), 1, [&](int begin, int end) {
+                    for (int i = begin; i < end; i++)
+                        spread_region(regions.at(top_regions.at(i)));
+                });
+            } else {
+                for (int rid : top_regions)
+                    spread_region(regions.at(rid));
             }
 #if 0
             if (ctx->debug) {
@@ -1256,12 +1429,25 @@ class HeAPPlacer
         std::vector<std::vector<ChainExtent>> chaines;
         std::map<IdString, ChainExtent> cell_extents;
 
+        // Everything cut_region needs to know about a cell, looked up once in init() so that regions can be cut on
+        // worker threads without touching any hash tables
+        struct SpreadCell
+        {
+            CellInfo *cell;
+            CellLocation *loc;
+            BoundingBox *region_bounds; // constraint region, or nullptr
+            int size;                   // number of cells, including any chain children
+            int extent_x, extent_y;     // chain extent
+            int type;                   // index into buckets
+        };
+        std::vector<SpreadCell> spread_cells;
+
         std::vector<std::vector<std::vector<std::vector<BelId>>> *> fb;
 
         std::vector<SpreaderRegion> regions;
         pool<int> merged_regions;
         // Cells at a location, sorted by real (not integer) x and y
-        std::vector<std::vector<std::vector<CellInfo *>>> cells_at_location;
+        std::vector<std::vector<std::vector<SpreadCell *>>> cells_at_location;
 
         int occ_at(int x, int y, int type) { return occupancy.at(x).at(y).at(type); }
 
@@ -1285,7 +1471,7 @@ class HeAPPlacer
                              std::vector<std::vector<int>>(p->max_y + 1, std::vector<int>(buckets.size(), 0)));
             groups.resize(p->max_x + 1, std::vector<int>(p->max_y + 1, -1));
             chaines.resize(p->max_x + 1, std::vector<ChainExtent>(p->max_y + 1));
-            cells_at_location.resize(p->max_x + 1, std::vector<std::vector<CellInfo *>>(p->max_y + 1));
+            cells_at_location.resize(p->max_x + 1, std::vector<std::vector<SpreadCell *>>(p->max_y + 1));
             for (int x = 0; x <= p->max_x; x++)
                 for (int y = 0; y <= p->max_y; y++) {
                     for (int t = 0; t < int(buckets.size()); t++) {
@@ -1358,8 +1544,19 @@ class HeAPPlacer
                     continue;
                 }
 
-                cells_at_location.at(p->cell_locs.at(cell->name).x).at(p->cell_locs.at(cell->name).y).push_back(cell);
+                SpreadCell sc;
+                sc.cell = cell;
+                sc.loc = &p->cell_locs.at(cell->name);
+                sc.region_bounds = cell->region ? &p->constraint_region_bounds[cell->region->name] : nullptr;
+                sc.size = p->chain_size.count(cell->name) ? p->chain_size.at(cell->name) : 1;
+                auto ce = cell_extents.find(cell->name);
+                sc.extent_x = (ce != cell_extents.end()) ? (ce->second.x1 - ce->second.x0 + 1) : 1;
+                sc.extent_y = (ce != cell_extents.end()) ? (ce->second.y1 - ce->second.y0 + 1) : 1;
+                sc.type = int(cell_index(*cell));
+                spread_cells.push_back(sc);
             }
+            for (auto &sc : spread_cells)
+                cells_at_location.at(sc.loc->x).at(sc.loc->y).push_back(&sc);
         }
 
         void merge_regions(SpreaderRegion &merged, SpreaderRegion &mergee)
@@ -1557,9 +1754,35 @@ class HeAPPlacer
         // Implementation of the recursive cut-based spreading as described in the HeAP paper
         // Note we use "left" to mean "-x/-y" depending on dir and "right" to mean "+x/+y" depending on dir
 
-        std::vector<CellInfo *> cut_cells;
+        // Recursively cut one of the top level regions until its cells are spread out
+        void spread_region(const SpreaderRegion &top)
+        {
+            std::vector<SpreadCell *> cut_cells;
+            std::queue<std::pair<SpreaderRegion, bool>> workqueue;
+            workqueue.emplace(top, false);
+            while (!workqueue.empty()) {
+                auto front = std::move(workqueue.front());
+                workqueue.pop();
+                auto &r = front.first;
+                if (std::all_of(r.cells.begin(), r.cells.end(), [](int x) { return x == 0; }))
+                    continue;
+                auto res = cut_region(r, front.second, cut_cells);
+                if (res) {
+                    workqueue.emplace(std::move(res->first), !front.second);
+                    workqueue.emplace(std::move(res->second), !front.second);
+                } else {
+                    // Try the other dir, in case stuck in one direction only
+                    auto res2 = cut_region(r, !front.second, cut_cells);
+                    if (res2) {
+                        workqueue.emplace(std::move(res2->first), front.second);
+                        workqueue.emplace(std::move(res2->second), front.second);
+                    }
+                }
+            }
+        }
 
-        boost::optional<std::pair<int, int>> cut_region(SpreaderRegion &r, bool dir)
+        boost::optional<std::pair<SpreaderRegion, SpreaderRegion>> cut_region(const SpreaderRegion &r, bool dir,
+                                                                               std::vector<SpreadCell *> &cut_cells)
         {
             cut_cells.clear();
             auto &cal = cells_at_location;
@@ -1569,12 +1792,11 @@ class HeAPPlacer
                     std::copy(cal.at(x).at(y).begin(), cal.at(x).at(y).end(), std::back_inserter(cut_cells));
                 }
             }
-            for (auto &cell : cut_cells) {
-                total_cells += p->chain_size.count(cell->name) ? p->chain_size.at(cell->name) : 1;
+            for (auto cell : cut_cells) {
+                total_cells += cell->size;
             }
-            std::sort(cut_cells.begin(), cut_cells.end(), [&](const CellInfo *a, const CellInfo *b) {
-                return dir ? (p->cell_locs.at(a->name).rawy < p->cell_locs.at(b->name).rawy)
-                           : (p->cell_locs.at(a->name).rawx < p->cell_locs.at(b->name).rawx);
+            std::sort(cut_cells.begin(), cut_cells.end(), [&](const SpreadCell *a, const SpreadCell *b) {
+                return dir ? (a->loc->rawy < b->loc->rawy) : (a->loc->rawx < b->loc->rawx);
             });
 
             if (cut_cells.size() < 2)
@@ -1582,8 +1804,8 @@ class HeAPPlacer
             // Find the cells midpoint, counting chains in terms of their total size - making the initial source cut
             int pivot_cells = 0;
             int pivot = 0;
-            for (auto &cell : cut_cells) {
-                pivot_cells += p->chain_size.count(cell->name) ? p->chain_size.at(cell->name) : 1;
+            for (auto cell : cut_cells) {
+                pivot_cells += cell->size;
                 if (pivot_cells >= total_cells / 2)
                     break;
                 pivot++;
@@ -1597,13 +1819,7 @@ class HeAPPlacer
             // Find the clearance required either side of the pivot
             int clearance_l = 0, clearance_r = 0;
             for (size_t i = 0; i < cut_cells.size(); i++) {
-                int size;
-                if (cell_extents.count(cut_cells.at(i)->name)) {
-                    auto &ce = cell_extents.at(cut_cells.at(i)->name);
-                    size = dir ? (ce.y1 - ce.y0 + 1) : (ce.x1 - ce.x0 + 1);
-                } else {
-                    size = 1;
-                }
+                int size = dir ? cut_cells.at(i)->extent_y : cut_cells.at(i)->extent_x;
                 if (int(i) < pivot)
                     clearance_l = std::max(clearance_l, size);
                 else
@@ -1655,11 +1871,9 @@ class HeAPPlacer
             std::vector<int> left_cells_v(buckets.size(), 0), right_cells_v(buckets.size(), 0);
             std::vector<int> left_bels_v(buckets.size(), 0), right_bels_v(r.bels);
             for (int i = 0; i <= pivot; i++)
-                left_cells_v.at(cell_index(*cut_cells.at(i))) +=
-                        p->chain_size.count(cut_cells.at(i)->name) ? p->chain_size.at(cut_cells.at(i)->name) : 1;
+                left_cells_v.at(cut_cells.at(i)->type) += cut_cells.at(i)->size;
             for (int i = pivot + 1; i < int(cut_cells.size()); i++)
-                right_cells_v.at(cell_index(*cut_cells.at(i))) +=
-                        p->chain_size.count(cut_cells.at(i)->name) ? p->chain_size.at(cut_cells.at(i)->name) : 1;
+                right_cells_v.at(cut_cells.at(i)->type) += cut_cells.at(i)->size;
 
             int best_tgt_cut = -1;
             double best_deltaU = std::numeric_limits<double>::max();
@@ -1725,16 +1939,16 @@ class HeAPPlacer
             };
             while (pivot > 0 && is_part_overutil(false)) {
                 auto &move_cell = cut_cells.at(pivot);
-                int size = p->chain_size.count(move_cell->name) ? p->chain_size.at(move_cell->name) : 1;
-                left_cells_v.at(cell_index(*cut_cells.at(pivot))) -= size;
-                right_cells_v.at(cell_index(*cut_cells.at(pivot))) += size;
+                int size = move_cell->size;
+                left_cells_v.at(cut_cells.at(pivot)->type) -= size;
+                right_cells_v.at(cut_cells.at(pivot)->type) += size;
                 pivot--;
             }
             while (pivot < int(cut_cells.size()) - 1 && is_part_overutil(true)) {
                 auto &move_cell = cut_cells.at(pivot + 1);
-                int size = p->chain_size.count(move_cell->name) ? p->chain_size.at(move_cell->name) : 1;
-                left_cells_v.at(cell_index(*cut_cells.at(pivot))) += size;
-                right_cells_v.at(cell_index(*cut_cells.at(pivot))) -= size;
+                int size = move_cell->size;
+                left_cells_v.at(cut_cells.at(pivot)->type) += size;
+                right_cells_v.at(cut_cells.at(pivot)->type) -= size;
                 pivot++;
             }
 
@@ -1743,8 +1957,7 @@ class HeAPPlacer
                 int N = cells_end - cells_start;
                 if (N <= 2) {
                     for (int i = cells_start; i < cells_end; i++) {
-                        auto &pos = dir ? p->cell_locs.at(cut_cells.at(i)->name).rawy
-                                        : p->cell_locs.at(cut_cells.at(i)->name).rawx;
+                        auto &pos = dir ? cut_cells.at(i)->loc->rawy : cut_cells.at(i)->loc->rawx;
                         pos = area_l + i * ((area_r - area_l) / N);
                     }
                     return;
@@ -1758,25 +1971,26 @@ class HeAPPlacer
                 bin_bounds.emplace_back(cells_end, area_r + 0.99);
                 for (int i = 0; i < K; i++) {
                     auto &bl = bin_bounds.at(i), br = bin_bounds.at(i + 1);
-                    double orig_left = dir ? p->cell_locs.at(cut_cells.at(bl.first)->name).rawy
-                                           : p->cell_locs.at(cut_cells.at(bl.first)->name).rawx;
-                    double orig_right = dir ? p->cell_locs.at(cut_cells.at(br.first - 1)->name).rawy
-                                            : p->cell_locs.at(cut_cells.at(br.first - 1)->name).rawx;
+                    double orig_left = dir ? cut_cells.at(bl.first)->loc->rawy : cut_cells.at(bl.first)->loc->rawx;
+                    double orig_right =
+                            dir ? cut_cells.at(br.first - 1)->loc->rawy : cut_cells.at(br.first - 1)->loc->rawx;
                     double m = (br.second - bl.second) / std::max(0.00001, orig_right - orig_left);
                     for (int j = bl.first; j < br.first; j++) {
-                        Region *cr = cut_cells.at(j)->region;
+                        const BoundingBox *cr = cut_cells.at(j)->region_bounds;
                         if (cr != nullptr) {
                             // Limit spreading bounds to constraint region; if applicable
-                            double brsc = p->limit_to_reg(cr, br.second, dir);
-                            double blsc = p->limit_to_reg(cr, bl.second, dir);
+                            auto limit_to_reg = [&](double val) {
+                                return std::max<double>(std::min<double>(val, dir ? cr->y1 : cr->x1),
+                                                        dir ? cr->y0 : cr->x0);
+                            };
+                            double brsc = limit_to_reg(br.second);
+                            double blsc = limit_to_reg(bl.second);
                             double mr = (brsc - blsc) / std::max(0.00001, orig_right - orig_left);
-                            auto &pos = dir ? p->cell_locs.at(cut_cells.at(j)->name).rawy
-                                            : p->cell_locs.at(cut_cells.at(j)->name).rawx;
+                            auto &pos = dir ? cut_cells.at(j)->loc->rawy : cut_cells.at(j)->loc->rawx;
                             NPNR_ASSERT(pos >= orig_left && pos <= orig_right);
                             pos = blsc + mr * (pos - orig_left);
                         } else {
-                            auto &pos = dir ? p->cell_locs.at(cut_cells.at(j)->name).rawy
-                                            : p->cell_locs.at(cut_cells.at(j)->name).rawx;
+                            auto &pos = dir ? cut_cells.at(j)->loc->rawy : cut_cells.at(j)->loc->rawx;
                             NPNR_ASSERT(pos >= orig_left && pos <= orig_right);
                             pos = bl.second + m * (pos - orig_left);
                         }
@@ -1791,35 +2005,25 @@ class HeAPPlacer
                     cells_at_location.at(x).at(y).clear();
                 }
             for (auto cell : cut_cells) {
-                auto &cl = p->cell_locs.at(cell->name);
+                auto &cl = *cell->loc;
                 cl.x = std::min(r.x1, std::max(r.x0, int(cl.rawx)));
                 cl.y = std::min(r.y1, std::max(r.y0, int(cl.rawy)));
                 cells_at_location.at(cl.x).at(cl.y).push_back(cell);
             }
             SpreaderRegion rl, rr;
-            rl.id = int(regions.size());
             rl.x0 = r.x0;
             rl.y0 = r.y0;
             rl.x1 = dir ? r.x1 : best_tgt_cut;
             rl.y1 = dir ? best_tgt_cut : r.y1;
             rl.cells = left_cells_v;
             rl.bels = left_bels_v;
-            rr.id = int(regions.size()) + 1;
             rr.x0 = dir ? r.x0 : (best_tgt_cut + 1);
             rr.y0 = dir ? (best_tgt_cut + 1) : r.y0;
             rr.x1 = r.x1;
             rr.y1 = r.y1;
             rr.cells = right_cells_v;
             rr.bels = right_bels_v;
-            regions.push_back(rl);
-            regions.push_back(rr);
-            for (int x = rl.x0; x <= rl.x1; x++)
-                for (int y = rl.y0; y <= rl.y1; y++)
-                    groups.at(x).at(y) = rl.id;
-            for (int x = rr.x0; x <= rr.x1; x++)
-                for (int y = rr.y0; y <= rr.y1; y++)
-                    groups.at(x).at(y) = rr.id;
-            return std::make_pair(rl.id, rr.id);
+            return std::make_pair(std::move(rl), std::move(rr));
         };
     };
     typedef decltype(CellInfo::udata) cell_udata_t;
@@ -1840,6 +2044,13 @@ PlacerHeapCfg::PlacerHeapCfg(Context *ctx)
 
     timing_driven = ctx->setting<bool>("timing_driven");
     solverTolerance = 1e-5;
+    if (ctx->settings.count(ctx->id("placerHeap/solver")))
+        solver = ctx->settings.at(ctx->id("placerHeap/solver")).as_string();
+    else
+        solver = "pcg";
+    if (solver != "pcg" && solver != "eigen")
+        log_error("Unknown placerHeap/solver '%s', expected 'pcg' or 'eigen'\n", solver.c_str());
+    threads = ctx->getThreadCount();
     placeAllAtOnce = false;
 
     int timeout_divisor = ctx->setting<int>("placerHeap/cellPlacementTimeout", 8);
@@ -42,6 +42,9 @@ struct PlacerHeapCfg
     float timingWeight;
     bool timing_driven;
     float solverTolerance;
+    // Equation solver backend: "pcg" (built-in, multithreaded) or "eigen"
+    std::string solver;
+    int threads;
     bool placeAllAtOnce;
     float netShareWeight;
     bool parallelRefine;
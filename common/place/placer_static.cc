@@ -35,19 +35,12 @@
 #include "place_common.h"
 #include "placer1.h"
 #include "scope_lock.h"
+#include "thread_pool.h"
 #include "timing.h"
 #include "util.h"
 
 #include "fftsg.h"
 
-#ifndef NPNR_DISABLE_THREADS
-#include <atomic>
-#include <condition_variable>
-#include <mutex>
-#include <thread>
-
-#endif
-
 NEXTPNR_NAMESPACE_BEGIN
 
 using namespace StaticUtil;
@@ -152,92 +145,6 @@ struct PlacerNet
     int hpwl() { return (b1.x - b0.x) + (b1.y - b0.y); }
 };
 
-#ifdef NPNR_DISABLE_THREADS
-struct ThreadPool
-{
-    ThreadPool(int) {};
-
-    void run(int N, std::function<void(int)> func)
-    {
-        for (int i = 0; i < N; i++)
-            func(i);
-    };
-};
-#else
-struct ThreadPool
-{
-    ThreadPool(int thread_count)
-    {
-        done.resize(thread_count, false);
-        for (int i = 0; i < thread_count; i++) {
-            threads.emplace_back([this, i]() { this->worker(i); });
-        }
-    }
-    std::vector<std::thread> threads;
-    std::condition_variable cv_start, cv_done;
-    std::mutex mutex;
-
-    bool work_available = false;
-    bool shutdown = false;
-    std::vector<bool> done;
-    std::function<void(int)> work;
-    int work_count;
-
-    ~ThreadPool()
-    {
-        {
-            std::lock_guard lk(mutex);
-            shutdown = true;
-        }
-        cv_start.notify_all();
-        for (auto &t : threads)
-            t.join();
-    }
-
-    void run(int N, std::function<void(int)> func)
-    {
-        {
-            std::lock_guard lk(mutex);
-            work = func;
-            work_count = N;
-            work_available = true;
-            std::fill(done.begin(), done.end(), false);
-        }
-        cv_start.notify_all();
-        {
-            std::unique_lock lk(mutex);
-            cv_done.wait(lk, [this] { return std::all_of(done.begin(), done.end(), [](bool x) { return x; }); });
-            work_available = false;
-        }
-    }
-
-    void worker(int idx)
-    {
-        while (true) {
-            std::unique_lock lk(mutex);
-            cv_start.wait(lk, [this, idx] { return (work_available && !done.at(idx)) || shutdown; });
-            if (shutdown) {
-                lk.unlock();
-                break;
-            } else if (work_available && !done.at(idx)) {
-                int work_per_thread = (work_count + int(threads.size()) - 1) / threads.size();
-                int begin = work_per_thread * idx;
-                int end = std::min(work_count, work_per_thread * (idx + 1));
-                lk.unlock();
-
-                for (int j = begin; j < end; j++) {
-                    work(j);
-                }
-
-                lk.lock();
-                done.at(idx) = true;
-                lk.unlock();
-                cv_done.notify_one();
-            }
-        }
-    }
-};
-#endif
 
 class StaticPlacer
 {
@@ -253,7 +160,8 @@ class StaticPlacer
 
     FastBels fast_bels;
     TimingAnalyser tmg;
-    ThreadPool pool;
+    // The context's shared worker threads
+    ThreadPool &pool;
 
     int width, height;
     int iter = 0;
@@ -587,6 +495,41 @@ class StaticPlacer
         cs_table_fft.resize(m * 3 / 2, 0);
         work_area_fft.resize(std::round(std::sqrt(m)) + 2, 0);
         work_area_fft.at(0) = 0;
+        // The 1D transforms fill in their tables on first use; do that now, as they are shared between threads
+        std::vector<float> dummy(m, 0);
+        ddct(m, -1, dummy.data(), work_area_fft.data(), cs_table_fft.data());
+        fft_columns.reset(m, m, 0);
+    }
+
+    // Transpose buffer for the column pass of transform_2d
+    FFTArray fft_columns;
+
+    // 2D cosine/sine transform of a (m x m) matrix a[x][y], as the ooura ddct2d/ddsct2d/ddcst2d but with the
+    // rows and then the columns spread across the thread pool. sine_x/sine_y pick a DST instead of a DCT along
+    // that axis.
+    void transform_2d(FFTArray &a, int isgn, bool sine_x, bool sine_y)
+    {
+        int *ip = work_area_fft.data();
+        float *w = cs_table_fft.data();
+        // Along y; rows are contiguous
+        pool.run(m, [&](int x) {
+            if (sine_y)
+                ddst(m, isgn, a.row(x), ip, w);
+            else
+                ddct(m, isgn, a.row(x), ip, w);
+        });
+        // Along x; each column is gathered into a contiguous row of the transpose buffer and back again
+        pool.run(m, [&](int y) {
+            float *col = fft_columns.row(y);
+            for (int x = 0; x < m; x++)
+                col[x] = a.row(x)[y];
+            if (sine_x)
+                ddst(m, isgn, col, ip, w);
+            else
+                ddct(m, isgn, col, ip, w);
+            for (int x = 0; x < m; x++)
+                a.row(x)[y] = col[x];
+        });
     }
 
     template <typename TFunc> void iter_slithers(RealPair pos, StaticRect rect, TFunc func)
@@ -624,23 +567,51 @@ class StaticPlacer
         }
     };
 
+    // Cells touching each stripe of density bin rows, for compute_density
+    static constexpr int density_stripes = 64;
+    std::vector<std::vector<int>> stripe_cells;
+
     void compute_density(int group, bool ref)
     {
         auto &g = groups.at(group);
-        // reset
-        for (auto entry : g.density)
-            entry.value = 0;
-        // populate
+        // The bins are split into stripes of rows that are filled in parallel. A cell is listed in every stripe it
+        // touches, and only adds to the bins of the stripe being filled; so each bin still sums its cells in index
+        // order, and the result doesn't depend on the number of threads.
+        int stripe_h = std::max(1, m / density_stripes);
+        int stripes = (m + stripe_h - 1) / stripe_h;
+        stripe_cells.resize(stripes);
+        for (auto &sc : stripe_cells)
+            sc.clear();
         for (int idx = 0; idx < int(mcells.size()); idx++) {
             auto &mc = mcells.at(idx);
             if (mc.group != group)
                 continue;
-            // scale width and height to be at least one bin (local density smoothing from the eplace paper)
-            // TODO: should we really do this every iteration?
-
+            // same rows as iter_slithers visits
             auto pos = ref ? mc.ref_pos : mc.pos;
-            iter_slithers(pos, mc.rect, [&](int x, int y, float area) { g.density.at(x, y) += area; });
+            double height = std::max<double>(mc.rect.h, bin_h);
+            int y0 = std::max(0, int(pos.y / bin_h)), y1 = std::min(m - 1, int((pos.y + height) / bin_h));
+            for (int s = y0 / stripe_h; s <= y1 / stripe_h; s++)
+                stripe_cells.at(s).push_back(idx);
         }
+        pool.run(stripes, [&](int s) {
+            int y0 = s * stripe_h, y1 = std::min(m, (s + 1) * stripe_h);
+            // reset
+            for (int y = y0; y < y1; y++)
+                for (int x = 0; x < m; x++)
+                    g.density.at(x, y) = 0;
+            // populate
+            for (int idx : stripe_cells.at(s)) {
+                auto &mc = mcells.at(idx);
+                // scale width and height to be at least one bin (local density smoothing from the eplace paper)
+                // TODO: should we really do this every iteration?
+
+                auto pos = ref ? mc.ref_pos : mc.pos;
+                iter_slithers(pos, mc.rect, [&](int x, int y, float area) {
+                    if (y >= y0 && y < y1)
+                        g.density.at(x, y) += area;
+                });
+            }
+        });
     }
 
     void compute_conc_density()
@@ -700,41 +671,33 @@ class StaticPlacer
         // Based on
         // https://github.com/ALIGN-analoglayout/ALIGN-public/blob/master/PlaceRouteHierFlow/EA_placer/FFT/fft.cpp
         // initial DCT for coefficients
-        ddct2d(m, m, -1, g.density_fft.data(), nullptr, work_area_fft.data(), cs_table_fft.data());
+        transform_2d(g.density_fft, -1, false, false);
         // postprocess coefficients
         for (int x = 0; x < m; x++)
             g.density_fft.at(x, 0) *= 0.5f;
         for (int y = 0; y < m; y++)
             g.density_fft.at(0, y) *= 0.5f;
-        for (int x = 0; x < m; x++)
-            for (int y = 0; y < m; y++)
-                g.density_fft.at(x, y) *= (4.0f / (m * m));
-        // scale inputs to IDCT for potentials and field
-        for (int x = 0; x < m; x++) {
+        // scale inputs to IDCT for potentials and field; one row at a time over contiguous storage
+        pool.run(m, [&](int x) {
             float wx = pi * (x / float(m));
             float wx2 = wx * wx;
+            float *dens = g.density_fft.row(x);
+            float *phi = g.electro_phi.row(x), *ex = g.electro_fx.row(x), *ey = g.electro_fy.row(x);
+            for (int y = 0; y < m; y++)
+                dens[y] *= (4.0f / (m * m));
             for (int y = 0; y < m; y++) {
                 float wy = pi * (y / float(m));
                 float wy2 = wy * wy;
-
-                float dens = g.density_fft.at(x, y);
-                float phi = 0, ex = 0, ey = 0;
-
-                if (x != 0 || y != 0) { // avoid divide by zero...
-                    phi = dens / (wx2 + wy2);
-                    ex = phi * wx;
-                    ey = phi * wy;
-                }
-
-                g.electro_phi.at(x, y) = phi;
-                g.electro_fx.at(x, y) = ex;
-                g.electro_fy.at(x, y) = ey;
+                // avoid divide by zero...
+                phi[y] = (x != 0 || y != 0) ? (dens[y] / (wx2 + wy2)) : 0;
+                ex[y] = phi[y] * wx;
+                ey[y] = phi[y] * wy;
             }
-        }
+        });
         // IDCT for potential; 2D derivatives for field
-        ddct2d(m, m, 1, g.electro_phi.data(), nullptr, work_area_fft.data(), cs_table_fft.data());
-        ddsct2d(m, m, 1, g.electro_fx.data(), nullptr, work_area_fft.data(), cs_table_fft.data());
-        ddcst2d(m, m, 1, g.electro_fy.data(), nullptr, work_area_fft.data(), cs_table_fft.data());
+        transform_2d(g.electro_phi, 1, false, false);
+        transform_2d(g.electro_fx, 1, true, false);
+        transform_2d(g.electro_fy, 1, false, true);
         if (fft_debug) {
             g.electro_phi.write_csv(stringf("out_bin_phi_%d_%d.csv", iter, group));
             g.electro_fx.write_csv(stringf("out_bin_ex_%d_%d.csv", iter, group));
@@ -854,16 +817,28 @@ class StaticPlacer
     std::vector<float> dens_penalty;
     float nesterov_a = 1.0f;
 
+    // Apply func to every MoveCell, in blocks spread over the thread pool
+    template <typename TFunc> void for_each_cell(TFunc func)
+    {
+        static constexpr int block = 1024;
+        int blocks = (int(mcells.size()) + block - 1) / block;
+        pool.run(blocks, [&](int b) {
+            for (int i = b * block; i < std::min(int(mcells.size()), (b + 1) * block); i++)
+                func(mcells.at(i));
+        });
+    }
+
     void update_gradients(bool ref = true, bool set_prev = true, bool init_penalty = false)
     {
         // TODO: skip non-group cells more efficiently?
-        pool.run(groups.size(), [&](int group) {
+        // Density and FFT are parallel within each group
+        for (int group = 0; group < int(groups.size()); group++) {
             compute_density(group, ref);
             run_fft(group);
-        });
+        }
         update_nets(ref);
         // First loop: back up gradients if required; set to zero; and compute density gradient
-        for (auto &cell : mcells) {
+        for_each_cell([&](MoveCell &cell) {
             auto &g = groups.at(cell.group);
             if (set_prev && ref) {
                 cell.last_wl_grad = cell.ref_wl_grad;
@@ -880,7 +855,7 @@ class StaticPlacer
             });
             // total gradient computed at the end
             (ref ? cell.ref_total_grad : cell.total_grad) = RealPair(0, 0);
-        }
+        });
         if (gathered_wirelen_grad.empty()) {
             for (auto &cell : ctx->cells) {
                 CellInfo *ci = cell.second.get();
@@ -918,7 +893,7 @@ class StaticPlacer
         }
         // Third loop: compute total gradient, and precondition
         // TODO: ALM as well as simple penalty
-        for (auto &cell : mcells) {
+        for_each_cell([&](MoveCell &cell) {
 #if 0
             if (!cell.is_spacer) {
                 printf("%d (%f, %f) wirelen_grad: (%f,%f) density_grad: (%f,%f)\n", iter, cell.ref_pos.x,
@@ -935,7 +910,7 @@ class StaticPlacer
             } else {
                 cell.total_grad = ((cell.wl_grad * -1) - cell.dens_grad * dens_penalty[cell.group]) / precond;
             }
-        }
+        });
     }
 
     float steplen = 0.01;
@@ -1121,9 +1096,9 @@ class StaticPlacer
         log_info("iter=%d steplen=%f a=%f penalty=[%s]\n", iter, steplen, nesterov_a, penalty_str.c_str());
         float a_next = (1.0f + std::sqrt(4.0f * nesterov_a * nesterov_a + 1)) / 2.0f;
         // Update positions using Nesterov's
-        for (auto &cell : mcells) {
+        for_each_cell([&](MoveCell &cell) {
             if (cell.is_fixed || cell.is_dark)
-                continue;
+                return;
             // save current position in last_pos
             cell.last_ref_pos = cell.ref_pos;
             cell.last_pos = cell.pos;
@@ -1131,7 +1106,7 @@ class StaticPlacer
             cell.pos = clamp_loc(cell.ref_pos - cell.ref_total_grad * steplen);
             // compute reference position
             cell.ref_pos = clamp_loc(cell.pos + (cell.pos - cell.last_pos) * ((nesterov_a - 1) / a_next));
-        }
+        });
         nesterov_a = a_next;
         update_chains();
         update_gradients(true);
@@ -1461,7 +1436,7 @@ class StaticPlacer
 
   public:
     StaticPlacer(Context *ctx, PlacerStaticCfg cfg)
-            : ctx(ctx), cfg(cfg), fast_bels(ctx, true, 8), tmg(ctx), pool(ctx->setting<int>("threads", 8))
+            : ctx(ctx), cfg(cfg), fast_bels(ctx, true, 8), tmg(ctx), pool(ctx->getThreadPool())
     {
         groups.resize(cfg.cell_groups.size());
         tmg.setup_only = true;
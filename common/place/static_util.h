@@ -20,6 +20,7 @@
 #ifndef STATIC_UTIL_H
 #define STATIC_UTIL_H
 
+#include <algorithm>
 #include <fstream>
 #include "nextpnr_assertions.h"
 #include "nextpnr_namespaces.h"
@@ -63,7 +64,7 @@ struct RealPair
 inline RealPair operator+(RealPair a, RealPair b) { return RealPair(a.x + b.x, a.y + b.y); }
 inline RealPair operator-(RealPair a, RealPair b) { return RealPair(a.x - b.x, a.y - b.y); }
 
-// array2d; but as ourafft wants it
+// array2d; but as ourafft wants it: an array of row pointers, into one contiguous block so rows can be streamed
 struct FFTArray
 {
     FFTArray(int width = 0, int height = 0) : m_width(width), m_height(height)
@@ -72,16 +73,11 @@ struct FFTArray
         fill(0);
     }
 
-    void fill(float value)
-    {
-        for (int x = 0; x < m_width; x++)
-            for (int y = 0; y < m_height; y++)
-                m_data[x][y] = value;
-    }
+    void fill(float value) { std::fill(m_storage, m_storage + size_t(m_width) * m_height, value); }
 
     void reset(int width, int height, float value = 0)
     {
-        if (width != m_height || height != m_height) {
+        if (width != m_width || height != m_height) {
             destroy();
             m_width = width;
             m_height = height;
@@ -101,6 +97,12 @@ struct FFTArray
         return m_data[x][y];
     }
     float **data() { return m_data; }
+    // Contiguous row x, of length height
+    float *row(int x)
+    {
+        NPNR_ASSERT(x >= 0 && x < m_width);
+        return m_data[x];
+    }
 
     void write_csv(const std::string &filename) const
     {
@@ -119,19 +121,22 @@ struct FFTArray
   private:
     int m_width, m_height;
     float **m_data = nullptr;
+    float *m_storage = nullptr;
     void alloc()
     {
         if (m_width == 0)
             return;
         m_data = new float *[m_width];
+        m_storage = new float[size_t(m_width) * m_height];
         for (int x = 0; x < m_width; x++)
-            m_data[x] = (m_height > 0) ? (new float[m_height]) : nullptr;
+            m_data[x] = m_storage + size_t(x) * m_height;
     }
     void destroy()
     {
-        for (int x = 0; x < m_width; x++)
-            delete[] m_data[x];
+        delete[] m_storage;
         delete[] m_data;
+        m_storage = nullptr;
+        m_data = nullptr;
     }
 };
 
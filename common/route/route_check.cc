@@ -0,0 +1,183 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2024  The nextpnr Authors.
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "route_check.h"
+
+#include "log.h"
+#include "thread_pool.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+
+// The first thing found wrong with a net. This is only turned into a message once back on the main thread, as naming
+// wires isn't thread safe.
+struct NetProblem
+{
+    const char *what = nullptr; // nullptr if the net is fine, otherwise a format string taking the wire name if set
+    WireId wire;
+};
+
+NetProblem check_net(const Context *ctx, const NetInfo *net)
+{
+    if (route_skip_net(net))
+        return {};
+
+    if (net->users.empty()) {
+        if (!net->wires.empty())
+            return {"net without sinks still has wire %s bound", net->wires.begin()->first};
+        return {};
+    }
+
+    bool is_const = net->constant_value != IdString();
+    WireId src_wire = ctx->getNetinfoSourceWire(net);
+    if (!is_const) {
+        if (src_wire == WireId())
+            return {"no source wire", WireId()};
+        if (!net->wires.count(src_wire))
+            return {"source wire %s not bound to net", src_wire};
+    }
+
+    // Every bound wire has exactly one parent: the source of its pip, or nothing if it is a root. So checking that each
+    // parent is also bound, that the roots are in the right places, and that following parents never goes round in a
+    // circle, shows that the wires form a tree hanging from the source.
+    dict<WireId, int> child_count;
+    child_count.reserve(net->wires.size());
+    for (auto &w : net->wires) {
+        if (ctx->getBoundWireNet(w.first) != net)
+            return {"wire %s is not bound to the net in the arch", w.first};
+        PipId pip = w.second.pip;
+        if (pip == PipId()) {
+            // A constant net may also have a real driver, whose source wire is then a root too
+            bool is_root = (src_wire != WireId() && w.first == src_wire) ||
+                           (is_const && ctx->getWireConstantValue(w.first) == net->constant_value);
+            if (!is_root)
+                return {"dangling wire %s", w.first};
+            continue;
+        }
+        if (ctx->getBoundPipNet(pip) != net)
+            return {"pip driving wire %s is not bound to the net in the arch", w.first};
+        if (ctx->getPipDstWire(pip) != w.first)
+            return {"pip bound to wire %s drives a different wire", w.first};
+        WireId parent = ctx->getPipSrcWire(pip);
+        if (!net->wires.count(parent))
+            return {"wire %s is driven from an unbound wire", w.first};
+        child_count[parent]++;
+    }
+
+    // 0 = not seen yet, 1 = on the path being followed, 2 = known to lead back to a root
+    dict<WireId, uint8_t> state;
+    state.reserve(net->wires.size());
+    std::vector<WireId> path;
+    for (auto &w : net->wires) {
+        WireId cursor = w.first;
+        while (true) {
+            uint8_t &s = state[cursor];
+            if (s == 2)
+                break;
+            if (s == 1)
+                return {"loop through wire %s", cursor};
+            s = 1;
+            path.push_back(cursor);
+            PipId pip = net->wires.at(cursor).pip;
+            if (pip == PipId())
+                break;
+            cursor = ctx->getPipSrcWire(pip);
+        }
+        for (WireId p : path)
+            state[p] = 2;
+        path.clear();
+    }
+
+    pool<WireId> sink_wires;
+    for (auto &usr : net->users) {
+        for (WireId dst_wire : ctx->getNetinfoSinkWires(net, usr)) {
+            if (!net->wires.count(dst_wire))
+                return {"sink wire %s not bound to net", dst_wire};
+            sink_wires.insert(dst_wire);
+        }
+    }
+
+    // As the wires are a tree, any wire that isn't on the way to a sink would end in a leaf that isn't a sink. Locked
+    // wires are left alone, as ripping up the net wouldn't remove them either.
+    for (auto &w : net->wires) {
+        if (w.second.strength >= STRENGTH_LOCKED)
+            continue;
+        if (!child_count.count(w.first) && !sink_wires.count(w.first))
+            return {"stub ending in wire %s", w.first};
+    }
+
+    return {};
+}
+
+} // namespace
+
+bool route_skip_net(const NetInfo *net)
+{
+#ifdef ARCH_ECP5
+    // ECP5 global nets currently appear part-unrouted due to arch database limitations
+    if (net->is_global)
+        return true;
+#endif
+    // Undriven nets aren't routed
+    return net->driver.cell == nullptr && net->constant_value == IdString();
+}
+
+std::vector<NetInfo *> check_route_legal(const Context *ctx, int max_logged)
+{
+    std::vector<NetInfo *> nets;
+    nets.reserve(ctx->nets.size());
+    for (auto &net : ctx->nets)
+        nets.push_back(net.second.get());
+
+    std::vector<NetProblem> problems(nets.size());
+    ctx->getThreadPool().parallel_for(int(nets.size()), 64, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+            problems.at(i) = check_net(ctx, nets.at(i));
+    });
+
+    std::vector<NetInfo *> failed;
+    for (size_t i = 0; i < nets.size(); i++) {
+        const NetProblem &p = problems.at(i);
+        if (p.what == nullptr)
+            continue;
+        if (int(failed.size()) < max_logged) {
+            std::string what = (p.wire == WireId()) ? p.what : stringf(p.what, ctx->nameOfWire(p.wire));
+            log_info("    net %s: %s\n", ctx->nameOf(nets.at(i)), what.c_str());
+        }
+        failed.push_back(nets.at(i));
+    }
+    if (int(failed.size()) > max_logged)
+        log_info("    ...and %d more nets\n", int(failed.size()) - max_logged);
+    return failed;
+}
+
+void ripup_nets(Context *ctx, const std::vector<NetInfo *> &nets)
+{
+    for (NetInfo *net : nets) {
+        std::vector<WireId> to_unbind;
+        for (auto &w : net->wires)
+            if (w.second.strength < STRENGTH_LOCKED)
+                to_unbind.push_back(w.first);
+        for (WireId w : to_unbind)
+            ctx->unbindWire(w);
+    }
+}
+
+NEXTPNR_NAMESPACE_END
@@ -0,0 +1,43 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2024  The nextpnr Authors.
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef ROUTE_CHECK_H
+#define ROUTE_CHECK_H
+
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// Whether routers should leave a net alone: nets with neither a driver nor a constant value, and on ECP5 global nets
+bool route_skip_net(const NetInfo *net);
+
+// Checks that the wires of every net form a tree, bound to that net, that starts at the net's source wire (or at wires
+// tied to its constant value, for constant nets) and reaches all of its sink wires, with no loops, stubs or wires left
+// dangling. Nets are checked in parallel on the context's thread pool, without needing a router set up.
+//
+// Returns the nets that fail, in the order of ctx->nets. Up to max_logged of them are logged along with the first
+// problem found on each.
+std::vector<NetInfo *> check_route_legal(const Context *ctx, int max_logged = 20);
+
+// Unbinds all routing of the given nets, except for locked wires, so that a router will route them again from scratch
+void ripup_nets(Context *ctx, const std::vector<NetInfo *> &nets);
+
+NEXTPNR_NAMESPACE_END
+
+#endif // ROUTE_CHECK_H
@@ -17,11 +17,14 @@
  *
  */
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <queue>
+#include <tuple>
 
 #include "log.h"
+#include "route_check.h"
 #include "router1.h"
 #include "scope_lock.h"
 #include "timing.h"
@@ -60,7 +63,7 @@ struct arc_key
 
 struct arc_entry
 {
-    arc_key arc;
+    int arc;
     delay_t pri;
     int randtag = 0;
 
@@ -103,63 +106,177 @@ struct Router1
     Context *ctx;
     const Router1Cfg &cfg;
 
+    // Arcs are numbered once during setup, and wires the first time the router comes across them, so that which arcs
+    // use which wires can be kept in flat arrays. An arc uses a handful of wires and most wires are used by one or two
+    // arcs, so short vectors are cheaper to keep up to date than sets.
+    struct ArcInfo
+    {
+        arc_key key;
+        // Wires currently used by this arc
+        std::vector<int> wires;
+        bool queued = false;
+    };
+
+    struct WireInfo
+    {
+        WireId wire;
+        // Arcs currently using this wire
+        std::vector<int> arcs;
+        // Number of times this wire has been ripped up
+        int score = 0;
+        // Where the search for the current arc reached this wire from, if visit_id is that search's
+        int visit_id = -1;
+        QueuedWire visit;
+    };
+
+    std::vector<ArcInfo> arcs;
+    std::vector<WireInfo> wires;
+    // Where each wire is in wires, or -1. Looked up by the arch's dense wire index where it has one, which costs 4
+    // bytes per device wire rather than a whole WireInfo; otherwise by WireId.
+    std::vector<int> wire_slot;
+    dict<WireId, int> wire_to_idx;
+    int curr_visit_id = 0;
+
+    // Nets are numbered in the order of ctx->nets. This is kept here rather than in udata, so as not to clobber
+    // anything else keeping its own data there.
+    dict<NetInfo *, int, hash_ptr_ops> net_to_idx;
+    std::vector<int> net_scores;
+
     std::priority_queue<arc_entry, std::vector<arc_entry>, arc_entry::Less> arc_queue;
-    dict<WireId, pool<arc_key>> wire_to_arcs;
-    dict<arc_key, pool<WireId>> arc_to_wires;
-    pool<arc_key> queued_arcs;
 
     std::priority_queue<QueuedWire, std::vector<QueuedWire>, QueuedWire::Greater> queue;
 
-    dict<WireId, int> wireScores;
-    dict<NetInfo *, int, hash_ptr_ops> netScores;
-
     int arcs_with_ripup = 0;
     int arcs_without_ripup = 0;
     bool ripup_flag;
 
+    // Timing analysis is only needed once there is something to route; which, when checking the result of another
+    // router, there usually isn't
     TimingAnalyser tmg;
+    bool tmg_ready = false;
 
     bool timing_driven = true;
 
     Router1(Context *ctx, const Router1Cfg &cfg) : ctx(ctx), cfg(cfg), tmg(ctx)
     {
         timing_driven = ctx->setting<bool>("timing_driven");
+        wire_slot.resize(ctx->getWireIndexCount(), -1);
+    }
+
+    // Returns true if this call ran the analysis, i.e. the results are already up to date
+    bool setup_timing()
+    {
+        if (tmg_ready)
+            return false;
         tmg.setup_only = false;
         tmg.with_clock_skew = true;
         tmg.setup();
         tmg.run();
+        tmg_ready = true;
+        return true;
+    }
+
+    int find_wire(WireId wire) const
+    {
+        if (!wire_slot.empty())
+            return wire_slot[ctx->getWireIndex(wire)];
+        auto fnd = wire_to_idx.find(wire);
+        return fnd == wire_to_idx.end() ? -1 : fnd->second;
+    }
+
+    int wire_index(WireId wire)
+    {
+        int &slot =
+                wire_slot.empty() ? wire_to_idx.emplace(wire, -1).first->second : wire_slot[ctx->getWireIndex(wire)];
+        if (slot == -1) {
+            slot = int(wires.size());
+            wires.emplace_back();
+            wires.back().wire = wire;
+        }
+        return slot;
     }
 
-    void arc_queue_insert(const arc_key &arc, WireId src_wire, WireId dst_wire)
+    int net_index(NetInfo *net) const { return net_to_idx.at(net); }
+
+    void add_arc_wire(int arc, int wire)
     {
-        if (queued_arcs.count(arc))
+        arcs.at(arc).wires.push_back(wire);
+        wires.at(wire).arcs.push_back(arc);
+    }
+
+    void set_visited(int wire, const QueuedWire &qw)
+    {
+        auto &wi = wires.at(wire);
+        wi.visit_id = curr_visit_id;
+        wi.visit = qw;
+    }
+
+    // Where the current search reached a wire from, or nullptr if it hasn't
+    const QueuedWire *get_visited(WireId wire) const
+    {
+        int idx = find_wire(wire);
+        if (idx == -1 || wires.at(idx).visit_id != curr_visit_id)
+            return nullptr;
+        return &wires.at(idx).visit;
+    }
+
+    static void erase_index(std::vector<int> &v, int value)
+    {
+        auto it = std::find(v.begin(), v.end(), value);
+        NPNR_ASSERT(it != v.end());
+        *it = v.back();
+        v.pop_back();
+    }
+
+    // As ctx->sorted_shuffle, but ordering by arc rather than index so the result doesn't depend on how the arcs were
+    // numbered
+    void shuffle_arcs(std::vector<int> &arc_list)
+    {
+        std::sort(arc_list.begin(), arc_list.end(), [&](int a, int b) { return arcs.at(a).key < arcs.at(b).key; });
+        ctx->shuffle(arc_list);
+    }
+
+    void reset_scores()
+    {
+        for (auto &wi : wires)
+            wi.score = 0;
+        std::fill(net_scores.begin(), net_scores.end(), 0);
+    }
+
+    void arc_queue_insert(int arc_idx, WireId src_wire, WireId dst_wire)
+    {
+        auto &ai = arcs.at(arc_idx);
+        if (ai.queued)
             return;
 
+        setup_timing();
+        const arc_key &arc = ai.key;
         delay_t pri = (arc.net_info->constant_value == IdString())
                               ? (ctx->estimateDelay(src_wire, dst_wire) *
                                  (100 * tmg.get_criticality(CellPortKey(arc.net_info->users.at(arc.user_idx)))))
                               : 0;
 
         arc_entry entry;
-        entry.arc = arc;
+        entry.arc = arc_idx;
         entry.pri = pri;
         entry.randtag = ctx->rng();
 
 #if 0
         if (ctx->debug)
-            log("[arc_queue_insert] %s (%d) %s %s [%d %d]\n", ctx->nameOf(entry.arc.net_info), entry.arc.user_idx,
+            log("[arc_queue_insert] %s (%d) %s %s [%d %d]\n", ctx->nameOf(arc.net_info), arc.user_idx,
                 ctx->nameOfWire(src_wire), ctx->nameOfWire(dst_wire), (int)entry.pri, entry.randtag);
 #endif
 
         arc_queue.push(entry);
-        queued_arcs.insert(arc);
+        ai.queued = true;
     }
 
-    void arc_queue_insert(const arc_key &arc)
+    void arc_queue_insert(int arc_idx)
     {
-        if (queued_arcs.count(arc))
+        if (arcs.at(arc_idx).queued)
             return;
 
+        const arc_key &arc = arcs.at(arc_idx).key;
         NetInfo *net_info = arc.net_info;
         auto user_idx = arc.user_idx;
         unsigned phys_idx = arc.phys_idx;
@@ -167,56 +284,60 @@ struct Router1
         auto src_wire = ctx->getNetinfoSourceWire(net_info);
         auto dst_wire = ctx->getNetinfoSinkWire(net_info, net_info->users[user_idx], phys_idx);
 
-        arc_queue_insert(arc, src_wire, dst_wire);
+        arc_queue_insert(arc_idx, src_wire, dst_wire);
     }
 
-    arc_key arc_queue_pop()
+    int arc_queue_pop()
     {
         arc_entry entry = arc_queue.top();
 
 #if 0
         if (ctx->debug)
-            log("[arc_queue_pop] %s (%d) [%d %d]\n", ctx->nameOf(entry.arc.net_info), entry.arc.user_idx,
-                (int)entry.pri, entry.randtag);
+            log("[arc_queue_pop] %s (%d) [%d %d]\n", ctx->nameOf(arcs.at(entry.arc).key.net_info),
+                arcs.at(entry.arc).key.user_idx, (int)entry.pri, entry.randtag);
 #endif
 
         arc_queue.pop();
-        queued_arcs.erase(entry.arc);
+        arcs.at(entry.arc).queued = false;
         return entry.arc;
     }
 
-    void ripup_net(NetInfo *net)
+    // Unbind a wire, putting the arcs that were using it back in the queue
+    void ripup_arcs_wire(WireId w, int indent)
     {
-        if (ctx->debug)
-            log("      ripup net %s\n", ctx->nameOf(net));
+        int idx = wire_index(w);
+        std::vector<int> ripped_arcs;
+        ripped_arcs.swap(wires.at(idx).arcs);
+        for (int arc : ripped_arcs)
+            erase_index(arcs.at(arc).wires, idx);
 
-        netScores[net]++;
+        shuffle_arcs(ripped_arcs);
 
-        std::vector<WireId> wires;
-        for (auto &it : net->wires)
-            wires.push_back(it.first);
+        for (int arc : ripped_arcs)
+            arc_queue_insert(arc);
 
-        ctx->sorted_shuffle(wires);
+        if (ctx->debug)
+            log("%*sunbind wire %s\n", indent, "", ctx->nameOfWire(w));
 
-        for (WireId w : wires) {
-            std::vector<arc_key> arcs;
-            for (auto &it : wire_to_arcs[w]) {
-                arc_to_wires[it].erase(w);
-                arcs.push_back(it);
-            }
-            wire_to_arcs[w].clear();
+        ctx->unbindWire(w);
+        wires.at(idx).score++;
+    }
 
-            ctx->sorted_shuffle(arcs);
+    void ripup_net(NetInfo *net)
+    {
+        if (ctx->debug)
+            log("      ripup net %s\n", ctx->nameOf(net));
 
-            for (auto &it : arcs)
-                arc_queue_insert(it);
+        net_scores.at(net_index(net))++;
 
-            if (ctx->debug)
-                log("        unbind wire %s\n", ctx->nameOfWire(w));
+        std::vector<WireId> net_wires;
+        for (auto &it : net->wires)
+            net_wires.push_back(it.first);
 
-            ctx->unbindWire(w);
-            wireScores[w]++;
-        }
+        ctx->sorted_shuffle(net_wires);
+
+        for (WireId w : net_wires)
+            ripup_arcs_wire(w, 8);
 
         ripup_flag = true;
     }
@@ -233,23 +354,7 @@ struct Router1
             if (n != nullptr)
                 ripup_net(n);
         } else {
-            std::vector<arc_key> arcs;
-            for (auto &it : wire_to_arcs[w]) {
-                arc_to_wires[it].erase(w);
-                arcs.push_back(it);
-            }
-            wire_to_arcs[w].clear();
-
-            ctx->sorted_shuffle(arcs);
-
-            for (auto &it : arcs)
-                arc_queue_insert(it);
-
-            if (ctx->debug)
-                log("      unbind wire %s\n", ctx->nameOfWire(w));
-
-            ctx->unbindWire(w);
-            wireScores[w]++;
+            ripup_arcs_wire(w, 6);
         }
 
         ripup_flag = true;
@@ -267,108 +372,55 @@ struct Router1
             if (n != nullptr)
                 ripup_net(n);
         } else {
-            std::vector<arc_key> arcs;
-            for (auto &it : wire_to_arcs[w]) {
-                arc_to_wires[it].erase(w);
-                arcs.push_back(it);
-            }
-            wire_to_arcs[w].clear();
-
-            ctx->sorted_shuffle(arcs);
-
-            for (auto &it : arcs)
-                arc_queue_insert(it);
-
-            if (ctx->debug)
-                log("      unbind wire %s\n", ctx->nameOfWire(w));
-
-            ctx->unbindWire(w);
-            wireScores[w]++;
+            ripup_arcs_wire(w, 6);
         }
 
         ripup_flag = true;
     }
 
-    bool skip_net(NetInfo *net_info)
-    {
-#ifdef ARCH_ECP5
-        // ECP5 global nets currently appear part-unrouted due to arch database limitations
-        // Don't touch them in the router
-        if (net_info->is_global)
-            return true;
-#endif
-        if (net_info->driver.cell == nullptr && net_info->constant_value == IdString())
-            return true;
-
-        return false;
-    }
-
     void check()
     {
-        pool<arc_key> valid_arcs;
+        std::vector<pool<WireId>> valid_wires_for_net(net_scores.size());
+
+        for (int arc = 0; arc < int(arcs.size()); arc++) {
+            NetInfo *net_info = arcs.at(arc).key.net_info;
+            for (int wire : arcs.at(arc).wires) {
+                WireId w = wires.at(wire).wire;
+                valid_wires_for_net.at(net_index(net_info)).insert(w);
+                log_assert(std::count(wires.at(wire).arcs.begin(), wires.at(wire).arcs.end(), arc) == 1);
+                log_assert(net_info->wires.count(w));
+            }
+        }
+
+        for (int wire = 0; wire < int(wires.size()); wire++) {
+            for (int arc : wires.at(wire).arcs)
+                log_assert(std::count(arcs.at(arc).wires.begin(), arcs.at(arc).wires.end(), wire) == 1);
+        }
 
         for (auto &net_it : ctx->nets) {
             NetInfo *net_info = net_it.second.get();
-            pool<WireId> valid_wires_for_net;
 
-            if (skip_net(net_info))
+            if (route_skip_net(net_info))
                 continue;
 
-#if 0
-            if (ctx->debug)
-                log("[check] net: %s\n", ctx->nameOf(net_info));
-#endif
-
-            auto src_wire = ctx->getNetinfoSourceWire(net_info);
-            log_assert(src_wire != WireId());
-
-            for (auto user : net_info->users.enumerate()) {
-                unsigned phys_idx = 0;
-                for (auto dst_wire : ctx->getNetinfoSinkWires(net_info, user.value)) {
-                    log_assert(dst_wire != WireId());
-
-                    arc_key arc;
-                    arc.net_info = net_info;
-                    arc.user_idx = user.index;
-                    arc.phys_idx = phys_idx++;
-                    valid_arcs.insert(arc);
-#if 0
-                    if (ctx->debug)
-                    log("[check]   arc: %s %s\n", ctx->nameOfWire(src_wire), ctx->nameOfWire(dst_wire));
-#endif
-
-                    for (WireId wire : arc_to_wires[arc]) {
-#if 0
-                        if (ctx->debug)
-                        log("[check]     wire: %s\n", ctx->nameOfWire(wire));
-#endif
-                        valid_wires_for_net.insert(wire);
-                        log_assert(wire_to_arcs[wire].count(arc));
-                        log_assert(net_info->wires.count(wire));
-                    }
-                }
-            }
-
             for (auto &it : net_info->wires) {
                 WireId w = it.first;
-                log_assert(valid_wires_for_net.count(w));
+                log_assert(valid_wires_for_net.at(net_index(net_info)).count(w));
             }
         }
-
-        for (auto &it : wire_to_arcs) {
-            for (auto &arc : it.second)
-                log_assert(valid_arcs.count(arc));
-        }
-
-        for (auto &it : arc_to_wires) {
-            log_assert(valid_arcs.count(it.first));
-        }
     }
 
     void setup()
     {
         dict<WireId, NetInfo *> src_to_net;
-        dict<WireId, arc_key> dst_to_arc;
+        dict<WireId, int> dst_to_arc;
+        // Arcs that need routing are only queued once everything has been looked at, as that needs timing analysis
+        std::vector<std::tuple<int, WireId, WireId>> unrouted;
+
+        net_to_idx.reserve(ctx->nets.size());
+        for (auto &net_it : ctx->nets)
+            net_to_idx.emplace(net_it.second.get(), int(net_to_idx.size()));
+        net_scores.resize(net_to_idx.size());
 
         std::vector<IdString> net_names;
         for (auto &net_it : ctx->nets)
@@ -379,7 +431,7 @@ struct Router1
         for (IdString net_name : net_names) {
             NetInfo *net_info = ctx->nets.at(net_name).get();
 
-            if (skip_net(net_info))
+            if (route_skip_net(net_info))
                 continue;
 
             auto src_wire = ctx->getNetinfoSourceWire(net_info);
@@ -395,7 +447,8 @@ struct Router1
             if (dst_to_arc.count(src_wire))
                 log_error("Wire %s is used as source and sink in different nets: %s vs %s (%d)\n",
                           ctx->nameOfWire(src_wire), ctx->nameOf(net_info),
-                          ctx->nameOf(dst_to_arc.at(src_wire).net_info), dst_to_arc.at(src_wire).user_idx.idx());
+                          ctx->nameOf(arcs.at(dst_to_arc.at(src_wire)).key.net_info),
+                          arcs.at(dst_to_arc.at(src_wire)).key.user_idx.idx());
 
             for (auto user : net_info->users.enumerate()) {
                 unsigned phys_idx = 0;
@@ -410,12 +463,12 @@ struct Router1
                                   ctx->nameOf(user.value.cell));
 
                     if (dst_to_arc.count(dst_wire)) {
-                        if (dst_to_arc.at(dst_wire).net_info == net_info)
+                        const arc_key &other = arcs.at(dst_to_arc.at(dst_wire)).key;
+                        if (other.net_info == net_info)
                             continue;
                         log_error("Found two arcs with same sink wire %s: %s (%d) vs %s (%d)\n",
                                   ctx->nameOfWire(dst_wire), ctx->nameOf(net_info), user.index.idx(),
-                                  ctx->nameOf(dst_to_arc.at(dst_wire).net_info),
-                                  dst_to_arc.at(dst_wire).user_idx.idx());
+                                  ctx->nameOf(other.net_info), other.user_idx.idx());
                     }
 
                     if (src_to_net.count(dst_wire))
@@ -423,29 +476,30 @@ struct Router1
                                   ctx->nameOfWire(dst_wire), ctx->nameOf(src_to_net.at(dst_wire)),
                                   ctx->nameOf(net_info), user.index.idx());
 
-                    dst_to_arc[dst_wire] = arc;
+                    int arc_idx = int(arcs.size());
+                    arcs.emplace_back();
+                    arcs.back().key = arc;
+                    dst_to_arc[dst_wire] = arc_idx;
 
                     if (net_info->wires.count(dst_wire) == 0) {
-                        arc_queue_insert(arc, src_wire, dst_wire);
+                        unrouted.emplace_back(arc_idx, src_wire, dst_wire);
                         continue;
                     }
 
                     WireId cursor = dst_wire;
-                    wire_to_arcs[cursor].insert(arc);
-                    arc_to_wires[arc].insert(cursor);
+                    add_arc_wire(arc_idx, wire_index(cursor));
 
                     while (src_wire != cursor && (net_info->constant_value == IdString() ||
                                                   ctx->getWireConstantValue(cursor) != net_info->constant_value)) {
                         auto it = net_info->wires.find(cursor);
                         if (it == net_info->wires.end()) {
-                            arc_queue_insert(arc, src_wire, dst_wire);
+                            unrouted.emplace_back(arc_idx, src_wire, dst_wire);
                             break;
                         }
 
                         NPNR_ASSERT(it->second.pip != PipId());
                         cursor = ctx->getPipSrcWire(it->second.pip);
-                        wire_to_arcs[cursor].insert(arc);
-                        arc_to_wires[arc].insert(cursor);
+                        add_arc_wire(arc_idx, wire_index(cursor));
                     }
                 }
                 // TODO: this matches the situation before supporting multiple cell->bel pins, but do we want to keep
@@ -459,17 +513,25 @@ struct Router1
 
             std::vector<WireId> unbind_wires;
 
-            for (auto &it : net_info->wires)
-                if (it.second.strength < STRENGTH_LOCKED && wire_to_arcs.count(it.first) == 0)
+            for (auto &it : net_info->wires) {
+                if (it.second.strength >= STRENGTH_LOCKED)
+                    continue;
+                int idx = find_wire(it.first);
+                if (idx == -1 || wires.at(idx).arcs.empty())
                     unbind_wires.push_back(it.first);
+            }
 
             for (auto it : unbind_wires)
                 ctx->unbindWire(it);
         }
+
+        for (auto &arc : unrouted)
+            arc_queue_insert(std::get<0>(arc), std::get<1>(arc), std::get<2>(arc));
     }
 
-    bool route_arc(const arc_key &arc, bool ripup)
+    bool route_arc(int arc_idx, bool ripup)
     {
+        const arc_key &arc = arcs.at(arc_idx).key;
 
         NetInfo *net_info = arc.net_info;
         auto user_idx = arc.user_idx;
@@ -489,17 +551,18 @@ struct Router1
 
         // unbind wires that are currently used exclusively by this arc
 
-        pool<WireId> old_arc_wires;
-        old_arc_wires.swap(arc_to_wires[arc]);
+        std::vector<int> old_arc_wires;
+        old_arc_wires.swap(arcs.at(arc_idx).wires);
 
-        for (WireId wire : old_arc_wires) {
-            auto &arc_wires = wire_to_arcs.at(wire);
-            NPNR_ASSERT(arc_wires.count(arc));
-            arc_wires.erase(arc);
+        // Release the most recently bound wires first
+        for (auto it = old_arc_wires.rbegin(); it != old_arc_wires.rend(); ++it) {
+            int wire = *it;
+            auto &arc_wires = wires.at(wire).arcs;
+            erase_index(arc_wires, arc_idx);
             if (arc_wires.empty()) {
                 if (ctx->debug)
-                    log("  unbind %s\n", ctx->nameOfWire(wire));
-                ctx->unbindWire(wire);
+                    log("  unbind %s\n", ctx->nameOfWire(wires.at(wire).wire));
+                ctx->unbindWire(wires.at(wire).wire);
             }
         }
 
@@ -512,8 +575,7 @@ struct Router1
             else {
                 ctx->bindWire(src_wire, net_info, STRENGTH_WEAK);
             }
-            arc_to_wires[arc].insert(src_wire);
-            wire_to_arcs[src_wire].insert(arc);
+            add_arc_wire(arc_idx, wire_index(src_wire));
             return true;
         }
 
@@ -523,7 +585,7 @@ struct Router1
             std::priority_queue<QueuedWire, std::vector<QueuedWire>, QueuedWire::Greater> new_queue;
             queue.swap(new_queue);
         }
-        dict<WireId, QueuedWire> visited;
+        ++curr_visit_id;
 
         // A* main loop
 
@@ -546,7 +608,7 @@ struct Router1
             qw.randtag = ctx->rng();
 
             queue.push(qw);
-            visited[qw.wire] = qw;
+            set_visited(wire_index(qw.wire), qw);
         }
 
         while (visitCnt++ < maxVisitCnt && !queue.empty()) {
@@ -629,31 +691,27 @@ struct Router1
                         conflictWireNet = nullptr;
 
                     if (conflictWireWire != WireId()) {
-                        auto scores_it = wireScores.find(conflictWireWire);
-                        if (scores_it != wireScores.end())
-                            penalty_delta += scores_it->second * cfg.wireRipupPenalty;
+                        int conflict_idx = find_wire(conflictWireWire);
+                        if (conflict_idx != -1)
+                            penalty_delta += wires.at(conflict_idx).score * cfg.wireRipupPenalty;
                         penalty_delta += cfg.wireRipupPenalty;
                     }
 
                     if (conflictPipWire != WireId()) {
-                        auto scores_it = wireScores.find(conflictPipWire);
-                        if (scores_it != wireScores.end())
-                            penalty_delta += scores_it->second * cfg.wireRipupPenalty;
+                        int conflict_idx = find_wire(conflictPipWire);
+                        if (conflict_idx != -1)
+                            penalty_delta += wires.at(conflict_idx).score * cfg.wireRipupPenalty;
                         penalty_delta += cfg.wireRipupPenalty;
                     }
 
                     if (conflictWireNet != nullptr) {
-                        auto scores_it = netScores.find(conflictWireNet);
-                        if (scores_it != netScores.end())
-                            penalty_delta += scores_it->second * cfg.netRipupPenalty;
+                        penalty_delta += net_scores.at(net_index(conflictWireNet)) * cfg.netRipupPenalty;
                         penalty_delta += cfg.netRipupPenalty;
                         penalty_delta += conflictWireNet->wires.size() * cfg.wireRipupPenalty;
                     }
 
                     if (conflictPipNet != nullptr) {
-                        auto scores_it = netScores.find(conflictPipNet);
-                        if (scores_it != netScores.end())
-                            penalty_delta += scores_it->second * cfg.netRipupPenalty;
+                        penalty_delta += net_scores.at(net_index(conflictPipNet)) * cfg.netRipupPenalty;
                         penalty_delta += cfg.netRipupPenalty;
                         penalty_delta += conflictPipNet->wires.size() * cfg.wireRipupPenalty;
                     }
@@ -667,10 +725,11 @@ struct Router1
                 if ((best_score >= 0) && (next_score - next_bonus - cfg.estimatePrecision > best_score))
                     continue;
 
-                auto old_visited_it = visited.find(next_wire);
-                if (old_visited_it != visited.end()) {
-                    delay_t old_delay = old_visited_it->second.delay;
-                    delay_t old_score = old_delay + old_visited_it->second.penalty;
+                int next_idx = wire_index(next_wire);
+                const WireInfo &next_wi = wires.at(next_idx);
+                if (next_wi.visit_id == curr_visit_id) {
+                    delay_t old_delay = next_wi.visit.delay;
+                    delay_t old_score = old_delay + next_wi.visit.penalty;
                     NPNR_ASSERT(old_score >= 0);
 
                     if (next_score + ctx->getDelayEpsilon() >= old_score)
@@ -681,7 +740,7 @@ struct Router1
                         log("Found better route to %s. Old vs new delay estimate: %.3f (%.3f) %.3f (%.3f)\n",
                             ctx->nameOfWire(next_wire),
                             ctx->getDelayNS(old_score),
-                            ctx->getDelayNS(old_visited_it->second.delay),
+                            ctx->getDelayNS(next_wi.visit.delay),
                             ctx->getDelayNS(next_score),
                             ctx->getDelayNS(next_delay));
 #endif
@@ -712,7 +771,7 @@ struct Router1
                         ctx->getDelayNS(next_delay));
 #endif
 
-                visited[next_qw.wire] = next_qw;
+                set_visited(next_idx, next_qw);
                 queue.push(next_qw);
 
                 if (next_wire == dst_wire) {
@@ -725,27 +784,26 @@ struct Router1
         if (ctx->debug)
             log("  total number of visited nodes: %d\n", visitCnt);
 
-        if (visited.count(dst_wire) == 0) {
+        if (get_visited(dst_wire) == nullptr) {
             if (ctx->debug)
                 log("  no route found for this arc\n");
             return false;
         }
 
         if (ctx->debug) {
-            log("  final route delay:   %8.2f\n", ctx->getDelayNS(visited[dst_wire].delay));
-            log("  final route penalty: %8.2f\n", ctx->getDelayNS(visited[dst_wire].penalty));
-            log("  final route bonus:   %8.2f\n", ctx->getDelayNS(visited[dst_wire].bonus));
+            const QueuedWire *dst_visit = get_visited(dst_wire);
+            log("  final route delay:   %8.2f\n", ctx->getDelayNS(dst_visit->delay));
+            log("  final route penalty: %8.2f\n", ctx->getDelayNS(dst_visit->penalty));
+            log("  final route bonus:   %8.2f\n", ctx->getDelayNS(dst_visit->bonus));
         }
 
         // bind resulting route (and maybe unroute other nets)
 
-        pool<WireId> unassign_wires = arc_to_wires[arc];
-
         WireId cursor = dst_wire;
         delay_t accumulated_path_delay = 0;
         delay_t last_path_delay_delta = 0;
         while (1) {
-            auto pip = visited[cursor].pip;
+            auto pip = get_visited(cursor)->pip;
 
             if (ctx->debug) {
                 delay_t path_delay_delta = ctx->estimateDelay(cursor, dst_wire) - accumulated_path_delay;
@@ -785,8 +843,7 @@ struct Router1
                 }
             }
 
-            wire_to_arcs[cursor].insert(arc);
-            arc_to_wires[arc].insert(cursor);
+            add_arc_wire(arc_idx, wire_index(cursor));
 
             if (pip == PipId())
                 break;
@@ -802,8 +859,9 @@ struct Router1
         return true;
     }
 
-    bool route_const_arc(const arc_key &arc, bool ripup)
+    bool route_const_arc(int arc_idx, bool ripup)
     {
+        const arc_key &arc = arcs.at(arc_idx).key;
 
         NetInfo *net_info = arc.net_info;
         auto user_idx = arc.user_idx;
@@ -820,17 +878,18 @@ struct Router1
 
         // unbind wires that are currently used exclusively by this arc
 
-        pool<WireId> old_arc_wires;
-        old_arc_wires.swap(arc_to_wires[arc]);
+        std::vector<int> old_arc_wires;
+        old_arc_wires.swap(arcs.at(arc_idx).wires);
 
-        for (WireId wire : old_arc_wires) {
-            auto &arc_wires = wire_to_arcs.at(wire);
-            NPNR_ASSERT(arc_wires.count(arc));
-            arc_wires.erase(arc);
+        // Release the most recently bound wires first
+        for (auto it = old_arc_wires.rbegin(); it != old_arc_wires.rend(); ++it) {
+            int wire = *it;
+            auto &arc_wires = wires.at(wire).arcs;
+            erase_index(arc_wires, arc_idx);
             if (arc_wires.empty()) {
                 if (ctx->debug)
-                    log("  unbind %s\n", ctx->nameOfWire(wire));
-                ctx->unbindWire(wire);
+                    log("  unbind %s\n", ctx->nameOfWire(wires.at(wire).wire));
+                ctx->unbindWire(wires.at(wire).wire);
             }
         }
 
@@ -843,8 +902,7 @@ struct Router1
             else {
                 ctx->bindWire(dst_wire, net_info, STRENGTH_WEAK);
             }
-            arc_to_wires[arc].insert(dst_wire);
-            wire_to_arcs[dst_wire].insert(arc);
+            add_arc_wire(arc_idx, wire_index(dst_wire));
             return true;
         }
 
@@ -854,7 +912,7 @@ struct Router1
             std::priority_queue<QueuedWire, std::vector<QueuedWire>, QueuedWire::Greater> new_queue;
             queue.swap(new_queue);
         }
-        dict<WireId, QueuedWire> visited;
+        ++curr_visit_id;
 
         // A* main loop
 
@@ -873,7 +931,7 @@ struct Router1
             qw.randtag = ctx->rng();
 
             queue.push(qw);
-            visited[qw.wire] = qw;
+            set_visited(wire_index(qw.wire), qw);
         }
 
         while (visitCnt++ < maxVisitCnt && !queue.empty()) {
@@ -958,31 +1016,27 @@ struct Router1
                         conflictWireNet = nullptr;
 
                     if (conflictWireWire != WireId()) {
-                        auto scores_it = wireScores.find(conflictWireWire);
-                        if (scores_it != wireScores.end())
-                            penalty_delta += scores_it->second * cfg.wireRipupPenalty;
+                        int conflict_idx = find_wire(conflictWireWire);
+                        if (conflict_idx != -1)
+                            penalty_delta += wires.at(conflict_idx).score * cfg.wireRipupPenalty;
                         penalty_delta += cfg.wireRipupPenalty;
                     }
 
                     if (conflictPipWire != WireId()) {
-                        auto scores_it = wireScores.find(conflictPipWire);
-                        if (scores_it != wireScores.end())
-                            penalty_delta += scores_it->second * cfg.wireRipupPenalty;
+                        int conflict_idx = find_wire(conflictPipWire);
+                        if (conflict_idx != -1)
+                            penalty_delta += wires.at(conflict_idx).score * cfg.wireRipupPenalty;
                         penalty_delta += cfg.wireRipupPenalty;
                     }
 
                     if (conflictWireNet != nullptr) {
-                        auto scores_it = netScores.find(conflictWireNet);
-                        if (scores_it != netScores.end())
-                            penalty_delta += scores_it->second * cfg.netRipupPenalty;
+                        penalty_delta += net_scores.at(net_index(conflictWireNet)) * cfg.netRipupPenalty;
                         penalty_delta += cfg.netRipupPenalty;
                         penalty_delta += conflictWireNet->wires.size() * cfg.wireRipupPenalty;
                     }
 
                     if (conflictPipNet != nullptr) {
-                        auto scores_it = netScores.find(conflictPipNet);
-                        if (scores_it != netScores.end())
-                            penalty_delta += scores_it->second * cfg.netRipupPenalty;
+                        penalty_delta += net_scores.at(net_index(conflictPipNet)) * cfg.netRipupPenalty;
                         penalty_delta += cfg.netRipupPenalty;
                         penalty_delta += conflictPipNet->wires.size() * cfg.wireRipupPenalty;
                     }
@@ -996,8 +1050,8 @@ struct Router1
                 if ((best_score >= 0) && (next_score - next_bonus - cfg.estimatePrecision > best_score))
                     continue;
 
-                auto old_visited_it = visited.find(next_wire);
-                if (old_visited_it != visited.end()) {
+                int next_idx = wire_index(next_wire);
+                if (wires.at(next_idx).visit_id == curr_visit_id) {
                     continue;
                 }
 
@@ -1009,7 +1063,7 @@ struct Router1
                 next_qw.bonus = next_bonus;
                 next_qw.randtag = ctx->rng();
 
-                visited[next_qw.wire] = next_qw;
+                set_visited(next_idx, next_qw);
                 queue.push(next_qw);
 
                 if (ctx->getWireConstantValue(next_wire) == net_info->constant_value) {
@@ -1032,15 +1086,14 @@ struct Router1
         }
 
         if (ctx->debug) {
-            log("  final route delay:   %8.2f\n", ctx->getDelayNS(visited[dst_wire].delay));
-            log("  final route penalty: %8.2f\n", ctx->getDelayNS(visited[dst_wire].penalty));
-            log("  final route bonus:   %8.2f\n", ctx->getDelayNS(visited[dst_wire].bonus));
+            const QueuedWire *dst_visit = get_visited(dst_wire);
+            log("  final route delay:   %8.2f\n", ctx->getDelayNS(dst_visit->delay));
+            log("  final route penalty: %8.2f\n", ctx->getDelayNS(dst_visit->penalty));
+            log("  final route bonus:   %8.2f\n", ctx->getDelayNS(dst_visit->bonus));
         }
 
         // bind resulting route (and maybe unroute other nets)
 
-        pool<WireId> unassign_wires = arc_to_wires[arc];
-
         WireId cursor = best_src;
 
         if (!net_info->wires.count(cursor)) {
@@ -1051,11 +1104,10 @@ struct Router1
             ctx->bindWire(cursor, net_info, STRENGTH_WEAK);
         }
 
-        wire_to_arcs[cursor].insert(arc);
-        arc_to_wires[arc].insert(cursor);
+        add_arc_wire(arc_idx, wire_index(cursor));
 
         while (1) {
-            auto pip = visited[cursor].pip;
+            auto pip = get_visited(cursor)->pip;
 
             if (pip == PipId()) {
                 NPNR_ASSERT(cursor == dst_wire);
@@ -1080,8 +1132,7 @@ struct Router1
                 ctx->bindPip(pip, net_info, STRENGTH_WEAK);
             }
 
-            wire_to_arcs[next].insert(arc);
-            arc_to_wires[arc].insert(next);
+            add_arc_wire(arc_idx, wire_index(next));
 
             cursor = next;
         }
@@ -1103,7 +1154,7 @@ struct Router1
 
         for (auto &net : ctx->nets) {
             NetInfo *ni = net.second.get();
-            if (skip_net(ni))
+            if (route_skip_net(ni))
                 continue;
             for (auto &usr : ni->users) {
                 ++arc_count;
@@ -1122,7 +1173,7 @@ struct Router1
         std::vector<delay_t> slacks;
         for (auto &net : ctx->nets) {
             NetInfo *ni = net.second.get();
-            if (skip_net(ni))
+            if (route_skip_net(ni))
                 continue;
             for (auto &usr : ni->users) {
                 delay_t slack = tmg.get_setup_slack(CellPortKey(usr));
@@ -1207,9 +1258,10 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
             if (ctx->debug)
                 log("-- %d --\n", iter_cnt);
 
-            arc_key arc = router.arc_queue_pop();
+            int arc_idx = router.arc_queue_pop();
+            const arc_key &arc = router.arcs.at(arc_idx).key;
             if (arc.net_info->constant_value != IdString()) {
-                if (!router.route_const_arc(arc, true)) {
+                if (!router.route_const_arc(arc_idx, true)) {
                     log_warning("Failed to find a route for arc %d of net %s.\n", arc.user_idx.idx(),
                                 ctx->nameOf(arc.net_info));
 #ifndef NDEBUG
@@ -1219,7 +1271,7 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
                     return false;
                 }
             } else {
-                if (!router.route_arc(arc, true)) {
+                if (!router.route_arc(arc_idx, true)) {
                     log_warning("Failed to find a route for arc %d of net %s.\n", arc.user_idx.idx(),
                                 ctx->nameOf(arc.net_info));
 #ifndef NDEBUG
@@ -1232,13 +1284,14 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
             // Timing driven ripup
             if (timing_ripup && router.arc_queue.empty() && timing_fail_count < 50) {
                 ++timing_fail_count;
-                router.tmg.run();
+                if (!router.setup_timing())
+                    router.tmg.run();
                 delay_t wns = 0, tns = 0;
                 if (timing_fail_count == 1)
                     ripup_slack = router.find_slack_thresh();
                 for (auto &net : ctx->nets) {
                     NetInfo *ni = net.second.get();
-                    if (router.skip_net(ni))
+                    if (route_skip_net(ni))
                         continue;
                     bool is_locked = false;
                     for (auto &wire : ni->wires) {
@@ -1267,8 +1320,7 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
                 log_info("    %d arcs ripped up due to negative slack WNS=%.02fns TNS=%.02fns.\n",
                          int(router.arc_queue.size()), ctx->getDelayNS(wns), ctx->getDelayNS(tns));
                 iter_cnt = 0;
-                router.wireScores.clear();
-                router.netScores.clear();
+                router.reset_scores();
             }
         }
         auto rend = std::chrono::high_resolution_clock::now();
@@ -29,16 +29,19 @@
 #include "router2.h"
 
 #include <algorithm>
+#include <array>
 #include <boost/container/flat_map.hpp>
 #include <chrono>
 #include <deque>
 #include <fstream>
 #include <limits>
+#include <map>
 #include <queue>
 #include <set>
 
 #include "log.h"
 #include "nextpnr.h"
+#include "route_check.h"
 #include "router1.h"
 #include "scope_lock.h"
 #include "timing.h"
@@ -80,23 +83,27 @@ struct Router2
         float total() const { return cost + togo_cost; }
     };
 
+    // Per-wire data is split into separate arrays by how often it is accessed, all indexed by the same flat wire
+    // index: the WireId itself (only needed when expanding a wire), the congestion and reservation state (needed for
+    // every wire considered), and the visit state of the current search (reset after every arc)
     struct PerWireData
     {
-        // nextpnr
-        WireId w;
         // Historical congestion cost
-        int curr_cong = 0;
         float hist_cong_cost = 1.0;
-        // Wire is unavailable as locked to another arc
-        bool unavailable = false;
+        int curr_cong = 0;
         // This wire has to be used for this net
         int reserved_net = -1;
         // The notional location of the wire, to guarantee thread safety
         int16_t x = 0, y = 0;
-        // Visit data
+        // Wire is unavailable as locked to another arc
+        bool unavailable = false;
+    };
+
+    struct WireVisitData
+    {
         PipId pip_fwd, pip_bwd;
-        bool visited_fwd = false, visited_bwd = false;
         float cost_fwd = 0.0, cost_bwd = 0.0;
+        bool visited_fwd = false, visited_bwd = false;
     };
 
     Context *ctx;
@@ -188,18 +195,40 @@ struct Router2
         }
     }
 
-    dict<WireId, int> wire_to_idx;
+    std::vector<WireId> flat_wire_ids;
     std::vector<PerWireData> flat_wires;
+    std::vector<WireVisitData> wire_visit;
 
-    PerWireData &wire_data(WireId w) { return flat_wires[wire_to_idx.at(w)]; }
+    // Only used for arches that don't provide a dense wire index
+    bool arch_wire_index = false;
+    dict<WireId, int> wire_to_idx;
+
+    int wire_index(WireId w) const { return arch_wire_index ? ctx->getWireIndex(w) : wire_to_idx.at(w); }
+    PerWireData &wire_data(WireId w) { return flat_wires[wire_index(w)]; }
 
     void setup_wires()
     {
         // Set up per-wire structures, so that MT parts don't have to do any memory allocation
-        // This is possibly quite wasteful and not cache-optimal; further consideration necessary
+        int index_count = ctx->getWireIndexCount();
+        arch_wire_index = (index_count > 0);
+        if (arch_wire_index) {
+            flat_wire_ids.resize(index_count);
+            flat_wires.resize(index_count);
+        }
+        int wire_count = 0;
         for (auto wire : ctx->getWires()) {
-            PerWireData pwd;
-            pwd.w = wire;
+            int idx;
+            if (arch_wire_index) {
+                idx = ctx->getWireIndex(wire);
+            } else {
+                idx = int(flat_wire_ids.size());
+                wire_to_idx[wire] = idx;
+                flat_wire_ids.emplace_back();
+                flat_wires.emplace_back();
+            }
+            flat_wire_ids.at(idx) = wire;
+            auto &pwd = flat_wires.at(idx);
+            ++wire_count;
             NetInfo *bound = ctx->getBoundWireNet(wire);
             if (bound != nullptr) {
                 auto iter = bound->wires.find(wire);
@@ -218,10 +247,16 @@ struct Router2
             BoundingBox wire_loc = ctx->getRouteBoundingBox(wire, wire);
             pwd.x = (wire_loc.x0 + wire_loc.x1) / 2;
             pwd.y = (wire_loc.y0 + wire_loc.y1) / 2;
-
-            wire_to_idx[wire] = int(flat_wires.size());
-            flat_wires.push_back(pwd);
         }
+        wire_visit.resize(flat_wires.size());
+
+        size_t state_bytes = flat_wire_ids.capacity() * sizeof(WireId) +
+                             flat_wires.capacity() * sizeof(PerWireData) +
+                             wire_visit.capacity() * sizeof(WireVisitData);
+        if (!arch_wire_index) // approximately, one entry and one hashtable slot per wire
+            state_bytes += wire_to_idx.size() * (sizeof(std::pair<WireId, int>) + 2 * sizeof(int));
+        log_info("    %d wires in %d %s indices, %.1f MiB of per-wire routing state\n", wire_count,
+                 int(flat_wires.size()), arch_wire_index ? "arch" : "hashed", state_bytes / (1024.0 * 1024.0));
 
         for (auto &net_pair : ctx->nets) {
             auto *net = net_pair.second.get();
@@ -258,6 +293,103 @@ struct Router2
         };
     };
 
+    // Priority queue of wires for the A* search, selected by router2/queue. "heap" is an exact binary heap;
+    // "radix" is a monotone radix heap keyed on the total cost quantised to `resolution`, with O(1) push and
+    // amortised O(log C) pop. The radix heap requires keys to never go below the last popped key, which A* with an
+    // inconsistent estimate does not guarantee; such entries are clamped to the current minimum. Storage is kept
+    // across clear() so the queues are reused by every arc without reallocation.
+    struct WireQueue
+    {
+        enum QueueKind
+        {
+            QUEUE_HEAP,
+            QUEUE_RADIX
+        } kind = QUEUE_HEAP;
+
+        std::vector<QueuedWire> heap;
+
+        float inv_resolution = 1.0f;
+        std::array<std::vector<std::pair<uint64_t, QueuedWire>>, 65> buckets;
+        uint64_t last_key = 0;
+        size_t radix_count = 0;
+
+        void setup(QueueKind k, float resolution)
+        {
+            kind = k;
+            inv_resolution = 1.0f / resolution;
+            clear();
+        }
+
+        bool empty() const { return size() == 0; }
+        size_t size() const { return (kind == QUEUE_HEAP) ? heap.size() : radix_count; }
+
+        void clear()
+        {
+            heap.clear();
+            for (auto &b : buckets)
+                b.clear();
+            last_key = 0;
+            radix_count = 0;
+        }
+
+        // Bucket 0 holds entries equal to the last popped key, bucket i > 0 those whose highest bit that differs
+        // from it is bit i-1
+        int radix_bucket(uint64_t key) const
+        {
+            if (key == last_key)
+                return 0;
+            int bucket = 0;
+            for (uint64_t diff = key ^ last_key; diff != 0; diff >>= 1)
+                ++bucket;
+            return bucket;
+        }
+
+        void push(const QueuedWire &w)
+        {
+            if (kind == QUEUE_HEAP) {
+                heap.push_back(w);
+                std::push_heap(heap.begin(), heap.end(), QueuedWire::Greater());
+                return;
+            }
+            float score = std::max(0.0f, w.score.cost + w.score.togo_cost) * inv_resolution;
+            uint64_t key = (score >= float(std::numeric_limits<uint32_t>::max()))
+                                   ? std::numeric_limits<uint32_t>::max()
+                                   : uint64_t(score);
+            key = std::max(key, last_key);
+            buckets.at(radix_bucket(key)).emplace_back(key, w);
+            ++radix_count;
+        }
+
+        QueuedWire pop()
+        {
+            if (kind == QUEUE_HEAP) {
+                std::pop_heap(heap.begin(), heap.end(), QueuedWire::Greater());
+                QueuedWire result = heap.back();
+                heap.pop_back();
+                return result;
+            }
+            NPNR_ASSERT(radix_count > 0);
+            if (buckets.front().empty()) {
+                // Redistribute the first non-empty bucket around its minimum, which becomes the new last key
+                size_t i = 1;
+                while (buckets.at(i).empty())
+                    ++i;
+                auto &bucket = buckets.at(i);
+                last_key = std::min_element(bucket.begin(), bucket.end(),
+                                            [](const std::pair<uint64_t, QueuedWire> &a,
+                                               const std::pair<uint64_t, QueuedWire> &b) { return a.first < b.first; })
+                                   ->first;
+                for (auto &entry : bucket)
+                    buckets.at(radix_bucket(entry.first)).push_back(entry);
+                bucket.clear();
+            }
+            QueuedWire result = buckets.front().back().second;
+            buckets.front().pop_back();
+            --radix_count;
+            return result;
+        }
+    };
+
     bool hit_test_pip(BoundingBox &bb, Loc l) { return l.x >= bb.x0 && l.x <= bb.x1 && l.y >= bb.y0 && l.y <= bb.y1; }
 
     double curr_cong_weight, hist_cong_weight, estimate_weight;
@@ -271,7 +403,7 @@ struct Router2
 
         std::vector<std::pair<store_index<PortRef>, size_t>> route_arcs;
 
-        std::priority_queue<QueuedWire, std::vector<QueuedWire>, QueuedWire::Greater> fwd_queue, bwd_queue;
+        WireQueue fwd_queue, bwd_queue;
         // Special case where one net has multiple logical arcs to the same physical sink
         pool<WireId> processed_sinks;
 
@@ -287,6 +419,13 @@ struct Router2
         dict<std::pair<int, int>, pool<WireId>> wire_by_loc;
     };
 
+    void setup_queues(ThreadContext &t)
+    {
+        auto kind = (cfg.queue == "radix") ? WireQueue::QUEUE_RADIX : WireQueue::QUEUE_HEAP;
+        t.fwd_queue.setup(kind, cfg.queue_resolution);
+        t.bwd_queue.setup(kind, cfg.queue_resolution);
+    }
+
     bool thread_test_wire(ThreadContext &t, PerWireData &w)
     {
         return w.x >= t.bb.x0 && w.x <= t.bb.x1 && w.y >= t.bb.y0 && w.y <= t.bb.y1;
@@ -316,10 +455,11 @@ struct Router2
     void bind_pip_internal(PerNetData &net, store_index<PortRef> user, int wire, PipId pip)
     {
         auto &wd = flat_wires.at(wire);
-        auto found = net.wires.find(wd.w);
+        WireId w = flat_wire_ids.at(wire);
+        auto found = net.wires.find(w);
         if (found == net.wires.end()) {
             // Not yet used for any arcs of this net, add to list
-            net.wires.emplace(wd.w, std::make_pair(pip, 1));
+            net.wires.emplace(w, std::make_pair(pip, 1));
             // Increase bound count of wire by 1
             ++wd.curr_cong;
         } else {
@@ -334,12 +474,12 @@ struct Router2
     void unbind_pip_internal(PerNetData &net, store_index<PortRef> user, WireId wire)
     {
         auto &wd = wire_data(wire);
-        auto &b = net.wires.at(wd.w);
+        auto &b = net.wires.at(wire);
         --b.second;
         if (b.second == 0) {
             // No remaining arcs of this net bound to this wire
             --wd.curr_cong;
-            net.wires.erase(wd.w);
+            net.wires.erase(wire);
         }
     }
 
@@ -386,13 +526,14 @@ struct Router2
     float get_togo_cost(NetInfo *net, store_index<PortRef> user, int wire, WireId src_sink, bool bwd, float crit_weight)
     {
         auto &nd = nets.at(net->udata);
-        auto &wd = flat_wires[wire];
+        WireId w = flat_wire_ids[wire];
         int source_uses = 0;
-        if (nd.wires.count(wd.w)) {
-            source_uses = nd.wires.at(wd.w).second;
+        auto fnd = nd.wires.find(w);
+        if (fnd != nd.wires.end()) {
+            source_uses = fnd->second.second;
         }
         // FIXME: timing/wirelength balance?
-        delay_t est_delay = ctx->estimateDelay(bwd ? src_sink : wd.w, bwd ? wd.w : src_sink);
+        delay_t est_delay = ctx->estimateDelay(bwd ? src_sink : w, bwd ? w : src_sink);
         return (ctx->getDelayNS(est_delay) / (1 + source_uses * crit_weight)) + cfg.ipin_cost_adder;
     }
 
@@ -423,7 +564,7 @@ struct Router2
         WireId src = nets.at(net->udata).src_wire;
         WireId cursor = ad.sink_wire;
         while (cursor != src) {
-            size_t wire_idx = wire_to_idx.at(cursor);
+            int wire_idx = wire_index(cursor);
             PipId pip = nd.wires.at(cursor).first;
             bind_pip_internal(nd, usr, wire_idx, pip);
             cursor = ctx->getPipSrcWire(pip);
@@ -588,14 +729,8 @@ struct Router2
 
     void reset_wires(ThreadContext &t)
     {
-        for (auto w : t.dirty_wires) {
-            flat_wires[w].pip_fwd = PipId();
-            flat_wires[w].pip_bwd = PipId();
-            flat_wires[w].visited_fwd = false;
-            flat_wires[w].visited_bwd = false;
-            flat_wires[w].cost_fwd = 0.0;
-            flat_wires[w].cost_bwd = 0.0;
-        }
+        for (auto w : t.dirty_wires)
+            wire_visit[w] = WireVisitData();
         t.dirty_wires.clear();
     }
 
@@ -627,7 +762,7 @@ struct Router2
     // Functions for marking wires as visited, and checking if they have already been visited
     void set_visited_fwd(ThreadContext &t, int wire, PipId pip, float cost)
     {
-        auto &wd = flat_wires.at(wire);
+        auto &wd = wire_visit[wire];
         if (!wd.visited_fwd && !wd.visited_bwd)
             t.dirty_wires.push_back(wire);
         wd.pip_fwd = pip;
@@ -636,7 +771,7 @@ struct Router2
     }
     void set_visited_bwd(ThreadContext &t, int wire, PipId pip, float cost)
     {
-        auto &wd = flat_wires.at(wire);
+        auto &wd = wire_visit[wire];
         if (!wd.visited_fwd && !wd.visited_bwd)
             t.dirty_wires.push_back(wire);
         wd.pip_bwd = pip;
@@ -646,11 +781,11 @@ struct Router2
 
     bool was_visited_fwd(int wire, float cost)
     {
-        return flat_wires.at(wire).visited_fwd && flat_wires.at(wire).cost_fwd <= cost;
+        return wire_visit[wire].visited_fwd && wire_visit[wire].cost_fwd <= cost;
     }
     bool was_visited_bwd(int wire, float cost)
     {
-        return flat_wires.at(wire).visited_bwd && flat_wires.at(wire).cost_bwd <= cost;
+        return wire_visit[wire].visited_bwd && wire_visit[wire].cost_bwd <= cost;
     }
 
     float get_arc_crit(NetInfo *net, store_index<PortRef> i)
@@ -684,8 +819,8 @@ struct Router2
         if (dst_wire == WireId())
             ARC_LOG_ERR("No wire found for port %s on destination cell %s.\n", ctx->nameOf(usr.port),
                         ctx->nameOf(usr.cell));
-        int src_wire_idx = const_mode ? -1 : wire_to_idx.at(src_wire);
-        int dst_wire_idx = wire_to_idx.at(dst_wire);
+        int src_wire_idx = const_mode ? -1 : wire_index(src_wire);
+        int dst_wire_idx = wire_index(dst_wire);
         // Calculate a timing weight based on criticality
         float crit = get_arc_crit(net, i);
         float crit_weight = std::max<float>(0.05f, (1.0f - std::pow(crit, 2)));
@@ -706,15 +841,9 @@ struct Router2
         int explored = 1;
 
         for (; mode < 2; mode++) {
-            // Clear out the queues
-            if (!t.fwd_queue.empty()) {
-                std::priority_queue<QueuedWire, std::vector<QueuedWire>, QueuedWire::Greater> new_queue;
-                t.fwd_queue.swap(new_queue);
-            }
-            if (!t.bwd_queue.empty()) {
-                std::priority_queue<QueuedWire, std::vector<QueuedWire>, QueuedWire::Greater> new_queue;
-                t.bwd_queue.swap(new_queue);
-            }
+            // Clear out the queues, keeping their storage for the next arc
+            t.fwd_queue.clear();
+            t.bwd_queue.clear();
             // Unvisit any previously visited wires
             reset_wires(t);
 
@@ -725,7 +854,7 @@ struct Router2
                 WireScore base_score;
                 base_score.delay = 0;
                 base_score.cost = 0;
-                int wire_idx = wire_to_idx.at(wire);
+                int wire_idx = wire_index(wire);
                 base_score.togo_cost = get_togo_cost(net, i, wire_idx, dst_wire, false, crit_weight);
                 t.fwd_queue.push(QueuedWire(wire_idx, base_score));
                 set_visited_fwd(t, wire_idx, PipId(), 0.0);
@@ -757,7 +886,7 @@ struct Router2
                 WireScore base_score;
                 base_score.delay = 0;
                 base_score.cost = 0;
-                int wire_idx = wire_to_idx.at(wire);
+                int wire_idx = wire_index(wire);
                 base_score.togo_cost = get_togo_cost(net, i, wire_idx, src_wire, true, crit_weight);
                 t.bwd_queue.push(QueuedWire(wire_idx, base_score));
                 set_visited_bwd(t, wire_idx, PipId(), 0.0);
@@ -776,23 +905,21 @@ struct Router2
                 ++iter;
                 if (!t.fwd_queue.empty() && !const_mode) {
                     // Explore forwards
-                    auto curr = t.fwd_queue.top();
-                    t.fwd_queue.pop();
+                    auto curr = t.fwd_queue.pop();
                     ++explored;
                     if (was_visited_bwd(curr.wire, std::numeric_limits<float>::max())) {
                         // Meet in the middle; done
                         midpoint_wire = curr.wire;
                         break;
                     }
-                    auto &curr_data = flat_wires.at(curr.wire);
-                    for (PipId dh : ctx->getPipsDownhill(curr_data.w)) {
+                    for (PipId dh : ctx->getPipsDownhill(flat_wire_ids[curr.wire])) {
                         // Skip pips outside of box in bounding-box mode
                         if (is_bb && !hit_test_pip(nd.bb, ctx->getPipLocation(dh)))
                             continue;
                         if (!ctx->checkPipAvailForNet(dh, net))
                             continue;
                         WireId next = ctx->getPipDstWire(dh);
-                        int next_idx = wire_to_idx.at(next);
+                        int next_idx = wire_index(next);
                         WireScore next_score;
                         next_score.delay = curr.score.delay + cfg.get_base_cost(ctx, next, dh, crit_weight);
                         next_score.cost = curr.score.cost + score_wire_for_arc(net, i, phys_pin, next, dh, crit_weight);
@@ -820,23 +947,22 @@ struct Router2
                 }
                 if (!t.bwd_queue.empty()) {
                     // Explore backwards
-                    auto curr = t.bwd_queue.top();
-                    t.bwd_queue.pop();
+                    auto curr = t.bwd_queue.pop();
                     ++explored;
-                    auto &curr_data = flat_wires.at(curr.wire);
+                    WireId curr_w = flat_wire_ids[curr.wire];
                     if (was_visited_fwd(curr.wire, std::numeric_limits<float>::max()) ||
-                        (const_mode && ctx->getWireConstantValue(curr_data.w) == net->constant_value)) {
+                        (const_mode && ctx->getWireConstantValue(curr_w) == net->constant_value)) {
                         // Meet in the middle; done
                         midpoint_wire = curr.wire;
                         break;
                     }
                     // Don't allow the same wire to be bound to the same net with a different driving pip
                     PipId bound_pip;
-                    auto fnd_wire = nd.wires.find(curr_data.w);
+                    auto fnd_wire = nd.wires.find(curr_w);
                     if (fnd_wire != nd.wires.end())
                         bound_pip = fnd_wire->second.first;
 
-                    for (PipId uh : ctx->getPipsUphill(curr_data.w)) {
+                    for (PipId uh : ctx->getPipsUphill(curr_w)) {
                         if (bound_pip != PipId() && bound_pip != uh)
                             continue;
                         if (is_bb && !hit_test_pip(nd.bb, ctx->getPipLocation(uh)))
@@ -844,7 +970,7 @@ struct Router2
                         if (!ctx->checkPipAvailForNet(uh, net))
                             continue;
                         WireId next = ctx->getPipSrcWire(uh);
-                        int next_idx = wire_to_idx.at(next);
+                        int next_idx = wire_index(next);
                         WireScore next_score;
                         next_score.delay = curr.score.delay + cfg.get_base_cost(ctx, next, uh, crit_weight);
                         next_score.cost = curr.score.cost + score_wire_for_arc(net, i, phys_pin, next, uh, crit_weight);
@@ -880,39 +1006,40 @@ struct Router2
             } else {
                 int cursor_bwd = midpoint_wire;
                 while (was_visited_fwd(cursor_bwd, std::numeric_limits<float>::max())) {
-                    PipId pip = flat_wires.at(cursor_bwd).pip_fwd;
+                    PipId pip = wire_visit[cursor_bwd].pip_fwd;
                     if (pip == PipId() && cursor_bwd != src_wire_idx)
                         break;
                     bind_pip_internal(nd, i, cursor_bwd, pip);
                     if (ctx->debug && !is_mt) {
                         auto &wd = flat_wires.at(cursor_bwd);
-                        ROUTE_LOG_DBG("      fwd wire: %s (curr %d hist %f share %d)\n", ctx->nameOfWire(wd.w),
-                                      wd.curr_cong - 1, wd.hist_cong_cost, nd.wires.at(wd.w).second);
+                        WireId w = flat_wire_ids.at(cursor_bwd);
+                        ROUTE_LOG_DBG("      fwd wire: %s (curr %d hist %f share %d)\n", ctx->nameOfWire(w),
+                                      wd.curr_cong - 1, wd.hist_cong_cost, nd.wires.at(w).second);
                     }
                     if (pip == PipId()) {
                         break;
                     }
                     ROUTE_LOG_DBG("         fwd pip: %s (%d, %d)\n", ctx->nameOfPip(pip), ctx->getPipLocation(pip).x,
                                   ctx->getPipLocation(pip).y);
-                    cursor_bwd = wire_to_idx.at(ctx->getPipSrcWire(pip));
+                    cursor_bwd = wire_index(ctx->getPipSrcWire(pip));
                 }
 
                 while (cursor_bwd != src_wire_idx) {
                     // Tack onto existing routing
-                    WireId bwd_w = flat_wires.at(cursor_bwd).w;
+                    WireId bwd_w = flat_wire_ids.at(cursor_bwd);
                     if (!nd.wires.count(bwd_w))
                         break;
                     auto &bound = nd.wires.at(bwd_w);
                     PipId pip = bound.first;
                     if (ctx->debug && !is_mt) {
                         auto &wd = flat_wires.at(cursor_bwd);
-                        ROUTE_LOG_DBG("      ext wire: %s (curr %d hist %f share %d)\n", ctx->nameOfWire(wd.w),
+                        ROUTE_LOG_DBG("      ext wire: %s (curr %d hist %f share %d)\n", ctx->nameOfWire(bwd_w),
                                       wd.curr_cong - 1, wd.hist_cong_cost, bound.second);
                     }
                     bind_pip_internal(nd, i, cursor_bwd, pip);
                     if (pip == PipId())
                         break;
-                    cursor_bwd = wire_to_idx.at(ctx->getPipSrcWire(pip));
+                    cursor_bwd = wire_index(ctx->getPipSrcWire(pip));
                 }
 
                 NPNR_ASSERT(cursor_bwd == src_wire_idx);
@@ -920,18 +1047,19 @@ struct Router2
 
             int cursor_fwd = midpoint_wire;
             while (was_visited_bwd(cursor_fwd, std::numeric_limits<float>::max())) {
-                PipId pip = flat_wires.at(cursor_fwd).pip_bwd;
+                PipId pip = wire_visit[cursor_fwd].pip_bwd;
                 if (pip == PipId()) {
                     break;
                 }
                 ROUTE_LOG_DBG("         bwd pip: %s (%d, %d)\n", ctx->nameOfPip(pip), ctx->getPipLocation(pip).x,
                               ctx->getPipLocation(pip).y);
-                cursor_fwd = wire_to_idx.at(ctx->getPipDstWire(pip));
+                cursor_fwd = wire_index(ctx->getPipDstWire(pip));
                 bind_pip_internal(nd, i, cursor_fwd, pip);
                 if (ctx->debug && !is_mt) {
                     auto &wd = flat_wires.at(cursor_fwd);
-                    ROUTE_LOG_DBG("      bwd wire: %s (curr %d hist %f share %d)\n", ctx->nameOfWire(wd.w),
-                                  wd.curr_cong - 1, wd.hist_cong_cost, nd.wires.at(wd.w).second);
+                    WireId w = flat_wire_ids.at(cursor_fwd);
+                    ROUTE_LOG_DBG("      bwd wire: %s (curr %d hist %f share %d)\n", ctx->nameOfWire(w),
+                                  wd.curr_cong - 1, wd.hist_cong_cost, nd.wires.at(w).second);
                 }
             }
             NPNR_ASSERT(cursor_fwd == dst_wire_idx);
@@ -1219,9 +1347,11 @@ struct Router2
         dict<IdString, std::vector<int>> cong_by_type;
         size_t max_cong = 0;
         // Build histogram
-        for (auto &wd : flat_wires) {
-            size_t val = wd.curr_cong;
-            IdString type = ctx->getWireType(wd.w);
+        for (size_t i = 0; i < flat_wires.size(); i++) {
+            if (flat_wire_ids.at(i) == WireId())
+                continue;
+            size_t val = flat_wires.at(i).curr_cong;
+            IdString type = ctx->getWireType(flat_wire_ids.at(i));
             max_cong = std::max(max_cong, val);
             if (cong_by_type[type].size() <= max_cong)
                 cong_by_type[type].resize(max_cong + 1);
@@ -1243,10 +1373,10 @@ struct Router2
     void write_utilisation_by_wiretype_heatmap(std::ostream &out)
     {
         dict<IdString, int> util_by_type;
-        for (auto &wd : flat_wires) {
-            IdString type = ctx->getWireType(wd.w);
+        for (size_t i = 0; i < flat_wires.size(); i++) {
+            auto &wd = flat_wires.at(i);
             if (wd.curr_cong > 0)
-                util_by_type[type] += wd.curr_cong;
+                util_by_type[ctx->getWireType(flat_wire_ids.at(i))] += wd.curr_cong;
         }
         // Write csv
         for (auto &u : util_by_type)
@@ -1268,51 +1398,125 @@ struct Router2
         }
     }
 
-    int mid_x = 0, mid_y = 0;
+    // A node of the k-d tree used to split routing across threads. Leaf regions are routed first, all in parallel;
+    // then each successive level routes the nets crossing the split of its (now larger) region, until the root,
+    // which routes the remaining nets singlethreaded.
+    struct PartitionNode
+    {
+        // Region that threads routing this node's nets are confined to
+        BoundingBox bb;
+        int parent = -1;
+        std::array<int, 2> children{-1, -1};
+        // Split axis (0 = x, 1 = y) and coordinate; the first child gets coordinates <= split
+        int axis = -1, split = 0;
+        // Height above the leaves, nodes with the same level are routed in parallel
+        int level = 0;
+    };
+
+    std::vector<PartitionNode> partition;
+    int partition_levels = 1;
 
-    void partition_nets()
+    int split_partition(const BoundingBox &region, std::vector<int> &members, int leaves, int parent)
     {
-        // Create a histogram of positions in X and Y positions
-        std::map<int, int> cxs, cys;
-        for (auto &n : nets) {
-            if (n.cx != -1)
-                ++cxs[n.cx];
-            if (n.cy != -1)
-                ++cys[n.cy];
+        int idx = int(partition.size());
+        partition.emplace_back();
+        partition.back().bb = region;
+        partition.back().parent = parent;
+        if (leaves <= 1 || members.size() < 2)
+            return idx;
+        // Region extents clamped to the device, as the outermost regions are open-ended
+        int lo[2] = {region.x0, region.y0};
+        int hi[2] = {std::min(region.x1, ctx->getGridDimX() - 1), std::min(region.y1, ctx->getGridDimY() - 1)};
+        // Split along the longest axis first; falling back to the other if it can't be split any further
+        int axis = ((hi[0] - lo[0]) >= (hi[1] - lo[1])) ? 0 : 1;
+        if (hi[axis] <= lo[axis])
+            axis ^= 1;
+        if (hi[axis] <= lo[axis])
+            return idx;
+        // Split at the point where the number of nets on each side is proportional to the number of leaves
+        int left_leaves = leaves / 2;
+        std::map<int, int> hist;
+        for (int n : members)
+            ++hist[(axis == 0) ? nets.at(n).cx : nets.at(n).cy];
+        int target = int((int64_t(members.size()) * left_leaves) / leaves);
+        int split = lo[axis], accum = 0;
+        for (auto &p : hist) {
+            if (accum < target && (accum + p.second) >= target)
+                split = p.first;
+            accum += p.second;
         }
-        // 4-way split for now
-        int accum_x = 0, accum_y = 0;
-        int halfway = int(nets.size()) / 2;
-        for (auto &p : cxs) {
-            if (accum_x < halfway && (accum_x + p.second) >= halfway)
-                mid_x = p.first;
-            accum_x += p.second;
+        split = std::max(lo[axis], std::min(hi[axis] - 1, split));
+
+        BoundingBox left_bb = region, right_bb = region;
+        std::vector<int> left_members, right_members;
+        if (axis == 0) {
+            left_bb.x1 = split;
+            right_bb.x0 = split + 1;
+        } else {
+            left_bb.y1 = split;
+            right_bb.y0 = split + 1;
         }
-        for (auto &p : cys) {
-            if (accum_y < halfway && (accum_y + p.second) >= halfway)
-                mid_y = p.first;
-            accum_y += p.second;
+        for (int n : members)
+            (((axis == 0) ? nets.at(n).cx : nets.at(n).cy) <= split ? left_members : right_members).push_back(n);
+        members.clear();
+        members.shrink_to_fit();
+
+        int left = split_partition(left_bb, left_members, left_leaves, idx);
+        int right = split_partition(right_bb, right_members, leaves - left_leaves, idx);
+        auto &node = partition.at(idx);
+        node.axis = axis;
+        node.split = split;
+        node.children = {left, right};
+        node.level = 1 + std::max(partition.at(left).level, partition.at(right).level);
+        return idx;
+    }
+
+    // Finds the smallest partition that fully contains a net's bounding box
+    int get_net_partition(const PerNetData &nd)
+    {
+        int curr = 0;
+        while (partition.at(curr).axis != -1) {
+            auto &node = partition.at(curr);
+            int lo = (node.axis == 0) ? nd.bb.x0 : nd.bb.y0;
+            int hi = (node.axis == 0) ? nd.bb.x1 : nd.bb.y1;
+            if (hi <= node.split)
+                curr = node.children[0];
+            else if (lo > node.split)
+                curr = node.children[1];
+            else
+                break;
         }
+        return curr;
+    }
+
+    void partition_nets()
+    {
+        partition.clear();
+        std::vector<int> members;
+        for (int i = 0; i < int(nets.size()); i++)
+            if (nets.at(i).cx != -1 && nets.at(i).cy != -1)
+                members.push_back(i);
+        split_partition(BoundingBox(0, 0, std::numeric_limits<int>::max(), std::numeric_limits<int>::max()), members,
+                        std::max(1, cfg.threads), -1);
+        partition_levels = partition.at(0).level + 1;
+
+        // Histogram of which region nets initially fall into
+        std::vector<int> bins(partition.size(), 0);
+        for (auto &n : nets)
+            ++bins.at(get_net_partition(n));
         if (ctx->verbose) {
-            log_info("    x splitpoint: %d\n", mid_x);
-            log_info("    y splitpoint: %d\n", mid_y);
-        }
-        std::vector<int> bins(5, 0);
-        for (auto &n : nets) {
-            if (n.bb.x0 < mid_x && n.bb.x1 < mid_x && n.bb.y0 < mid_y && n.bb.y1 < mid_y)
-                ++bins[0]; // TL
-            else if (n.bb.x0 >= mid_x && n.bb.x1 >= mid_x && n.bb.y0 < mid_y && n.bb.y1 < mid_y)
-                ++bins[1]; // TR
-            else if (n.bb.x0 < mid_x && n.bb.x1 < mid_x && n.bb.y0 >= mid_y && n.bb.y1 >= mid_y)
-                ++bins[2]; // BL
-            else if (n.bb.x0 >= mid_x && n.bb.x1 >= mid_x && n.bb.y0 >= mid_y && n.bb.y1 >= mid_y)
-                ++bins[3]; // BR
-            else
-                ++bins[4]; // cross-boundary
+            log_info("    split into %d regions over %d levels\n", int(partition.size()), partition_levels);
+            for (int i = 0; i < int(partition.size()); i++) {
+                auto &node = partition.at(i);
+                if (node.axis == -1)
+                    log_info("        region %d (%d, %d)->(%d, %d) level %d N=%d\n", i, node.bb.x0, node.bb.y0,
+                             std::min(node.bb.x1, ctx->getGridDimX() - 1), std::min(node.bb.y1, ctx->getGridDimY() - 1),
+                             node.level, bins.at(i));
+                else
+                    log_info("        region %d %c splitpoint %d level %d N=%d\n", i, node.axis == 0 ? 'x' : 'y',
+                             node.split, node.level, bins.at(i));
+            }
         }
-        if (ctx->verbose)
-            for (int i = 0; i < 5; i++)
-                log_info("        bin %d N=%d\n", i, bins[i]);
     }
 
     void router_thread(ThreadContext &t, bool is_mt)
@@ -1327,112 +1531,70 @@ struct Router2
     void do_route()
     {
         // Don't multithread if fewer than 200 nets (heuristic)
-        if (route_queue.size() < 200) {
+        if (route_queue.size() < 200 || partition.size() == 1) {
             ThreadContext st;
             st.rng.rngseed(ctx->rng64());
             st.bb = BoundingBox(0, 0, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
+            setup_queues(st);
             for (size_t j = 0; j < route_queue.size(); j++) {
                 route_net(st, nets_by_udata[route_queue[j]], false);
             }
             return;
         }
-        const int Nq = 4, Nv = 2, Nh = 2;
-        const int N = Nq + Nv + Nh;
-        std::vector<ThreadContext> tcs(N + 1);
-        for (auto &th : tcs) {
-            th.rng.rngseed(ctx->rng64());
-        }
-        int le_x = mid_x;
-        int rs_x = mid_x;
-        int le_y = mid_y;
-        int rs_y = mid_y;
-        // Set up thread bounding boxes
-        tcs.at(0).bb = BoundingBox(0, 0, mid_x, mid_y);
-        tcs.at(1).bb = BoundingBox(mid_x + 1, 0, std::numeric_limits<int>::max(), le_y);
-        tcs.at(2).bb = BoundingBox(0, mid_y + 1, mid_x, std::numeric_limits<int>::max());
-        tcs.at(3).bb =
-                BoundingBox(mid_x + 1, mid_y + 1, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-
-        tcs.at(4).bb = BoundingBox(0, 0, std::numeric_limits<int>::max(), mid_y);
-        tcs.at(5).bb = BoundingBox(0, mid_y + 1, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-
-        tcs.at(6).bb = BoundingBox(0, 0, mid_x, std::numeric_limits<int>::max());
-        tcs.at(7).bb = BoundingBox(mid_x + 1, 0, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-
-        tcs.at(8).bb = BoundingBox(0, 0, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-
-        for (auto n : route_queue) {
-            auto &nd = nets.at(n);
-            auto ni = nets_by_udata.at(n);
-            int bin = N;
-            // Quadrants
-            if (nd.bb.x0 < le_x && nd.bb.x1 < le_x && nd.bb.y0 < le_y && nd.bb.y1 < le_y)
-                bin = 0;
-            else if (nd.bb.x0 >= rs_x && nd.bb.x1 >= rs_x && nd.bb.y0 < le_y && nd.bb.y1 < le_y)
-                bin = 1;
-            else if (nd.bb.x0 < le_x && nd.bb.x1 < le_x && nd.bb.y0 >= rs_y && nd.bb.y1 >= rs_y)
-                bin = 2;
-            else if (nd.bb.x0 >= rs_x && nd.bb.x1 >= rs_x && nd.bb.y0 >= rs_y && nd.bb.y1 >= rs_y)
-                bin = 3;
-            // Vertical split
-            else if (nd.bb.y0 < le_y && nd.bb.y1 < le_y)
-                bin = Nq + 0;
-            else if (nd.bb.y0 >= rs_y && nd.bb.y1 >= rs_y)
-                bin = Nq + 1;
-            // Horizontal split
-            else if (nd.bb.x0 < le_x && nd.bb.x1 < le_x)
-                bin = Nq + Nv + 0;
-            else if (nd.bb.x0 >= rs_x && nd.bb.x1 >= rs_x)
-                bin = Nq + Nv + 1;
-            tcs.at(bin).route_nets.push_back(ni);
+        std::vector<ThreadContext> tcs(partition.size());
+        for (size_t i = 0; i < partition.size(); i++) {
+            tcs.at(i).rng.rngseed(ctx->rng64());
+            tcs.at(i).bb = partition.at(i).bb;
+            setup_queues(tcs.at(i));
         }
+        for (auto n : route_queue)
+            tcs.at(get_net_partition(nets.at(n))).route_nets.push_back(nets_by_udata.at(n));
         if (ctx->verbose)
-            log_info("%d/%d nets not multi-threadable\n", int(tcs.at(N).route_nets.size()), int(route_queue.size()));
+            log_info("%d/%d nets not multi-threadable\n", int(tcs.at(0).route_nets.size()), int(route_queue.size()));
+
+        // Route each level in turn, starting from the leaves. The root level is the whole device and routed
+        // singlethreaded, so nets that failed inside a region can be retried without the bounding box constraint.
+        for (int level = 0; level < partition_levels; level++) {
+            auto lstart = std::chrono::high_resolution_clock::now();
+            bool is_mt = (level != partition.at(0).level);
+            std::vector<int> level_nodes;
+            int level_nets = 0;
+            for (int i = 0; i < int(partition.size()); i++) {
+                if (partition.at(i).level != level || tcs.at(i).route_nets.empty())
+                    continue;
+                level_nodes.push_back(i);
+                level_nets += int(tcs.at(i).route_nets.size());
+            }
 #ifdef NPNR_DISABLE_THREADS
-        // Singlethreaded routing - quadrants
-        for (int i = 0; i < Nq; i++) {
-            router_thread(tcs.at(i), /*is_mt=*/false);
-        }
-        // Vertical splits
-        for (int i = Nq; i < Nq + Nv; i++) {
-            router_thread(tcs.at(i), /*is_mt=*/false);
-        }
-        // Horizontal splits
-        for (int i = Nq + Nv; i < Nq + Nv + Nh; i++) {
-            router_thread(tcs.at(i), /*is_mt=*/false);
-        }
+            for (int i : level_nodes)
+                router_thread(tcs.at(i), /*is_mt=*/false);
 #else
-        // Multithreaded part of routing - quadrants
-        std::vector<boost::thread> threads;
-        for (int i = 0; i < Nq; i++) {
-            threads.emplace_back([this, &tcs, i]() { router_thread(tcs.at(i), /*is_mt=*/true); });
-        }
-        for (auto &t : threads)
-            t.join();
-        threads.clear();
-        // Vertical splits
-        for (int i = Nq; i < Nq + Nv; i++) {
-            threads.emplace_back([this, &tcs, i]() { router_thread(tcs.at(i), /*is_mt=*/true); });
-        }
-        for (auto &t : threads)
-            t.join();
-        threads.clear();
-        // Horizontal splits
-        for (int i = Nq + Nv; i < Nq + Nv + Nh; i++) {
-            threads.emplace_back([this, &tcs, i]() { router_thread(tcs.at(i), /*is_mt=*/true); });
-        }
-        for (auto &t : threads)
-            t.join();
-        threads.clear();
+            if (!is_mt) {
+                for (int i : level_nodes)
+                    router_thread(tcs.at(i), /*is_mt=*/false);
+            } else {
+                // Regions vary a lot in size, so they are handed out one at a time as threads become free
+                ctx->getThreadPool().parallel_for(int(level_nodes.size()), 1, [&](int begin, int end) {
+                    for (int i = begin; i < end; i++)
+                        router_thread(tcs.at(level_nodes.at(i)), /*is_mt=*/true);
+                });
+            }
 #endif
-        // Singlethreaded part of routing - nets that cross partitions
-        // or don't fit within bounding box
-        for (auto st_net : tcs.at(N).route_nets)
-            route_net(tcs.at(N), st_net, false);
-        // Failed nets
-        for (int i = 0; i < N; i++)
-            for (auto fail : tcs.at(i).failed_nets)
-                route_net(tcs.at(N), fail, false);
+            // Failed nets get retried in the enclosing region, now that all of its subregions are done
+            int level_failed = 0;
+            for (int i : level_nodes) {
+                int parent = partition.at(i).parent;
+                level_failed += int(tcs.at(i).failed_nets.size());
+                // The root is routed singlethreaded, where failures are fatal instead
+                NPNR_ASSERT(parent != -1 || tcs.at(i).failed_nets.empty());
+                for (auto fail : tcs.at(i).failed_nets)
+                    tcs.at(parent).route_nets.push_back(fail);
+            }
+            auto lend = std::chrono::high_resolution_clock::now();
+            if (ctx->verbose)
+                log_info("        level %d: %d regions, %d nets, %d failed, %.02fs\n", level, int(level_nodes.size()),
+                         level_nets, level_failed, std::chrono::duration<float>(lend - lstart).count());
+        }
     }
 
     delay_t get_route_delay(int net, store_index<PortRef> usr_idx, int phys_idx)
@@ -1601,7 +1763,22 @@ struct Router2
         auto rend = std::chrono::high_resolution_clock::now();
         log_info("Router2 time %.02fs\n", std::chrono::duration<float>(rend - rstart).count());
 
-        log_info("Running router1 to check that route is legal...\n");
+        log_info("Checking that route is legal...\n");
+        auto illegal_nets = check_route_legal(ctx);
+        if (illegal_nets.empty()) {
+            ctx->yield();
+#ifndef NDEBUG
+            ctx->check();
+            log_assert(ctx->checkRoutedDesign());
+#endif
+            log_info("Checksum: 0x%08x\n", ctx->checksum());
+            timing_analysis(ctx, true /* slack_histogram */, true /* print_fmax */, true /* print_path */,
+                            true /* warn_on_failure */, true /* update_results */);
+            return;
+        }
+
+        log_info("Running router1 to reroute %d illegally routed nets...\n", int(illegal_nets.size()));
+        ripup_nets(ctx, illegal_nets);
 
         lock.unlock_early();
 
@@ -1636,6 +1813,16 @@ Router2Cfg::Router2Cfg(Context *ctx)
         curr_cong_mult = ctx->setting<float>("router2/currCongWeightMult", 2.0f);
         estimate_weight = ctx->setting<float>("router2/estimateWeight", 1.25f);
     }
+    threads = ctx->getThreadCount();
+    if (ctx->settings.count(ctx->id("router2/queue")))
+        queue = ctx->settings.at(ctx->id("router2/queue")).as_string();
+    else
+        queue = "heap";
+    if (queue != "heap" && queue != "radix")
+        log_error("Unknown router2/queue '%s', expected 'heap' or 'radix'\n", queue.c_str());
+    queue_resolution = ctx->setting<float>("router2/queueResolution", 1e-3f);
+    if (queue_resolution <= 0)
+        log_error("router2/queueResolution must be positive\n");
     perf_profile = ctx->setting<bool>("router2/perfProfile", false);
     if (ctx->settings.count(ctx->id("router2/heatmap")))
         heatmap = ctx->settings.at(ctx->id("router2/heatmap")).as_string();
@@ -54,6 +54,14 @@ struct Router2Cfg
     // of choosing a less congestion/delay-optimal route
     float estimate_weight;
 
+    // Number of leaf regions the device is partitioned into for multithreaded routing
+    int threads;
+
+    // Priority queue used for the A* search: "heap" (binary heap) or "radix" (monotone radix heap,
+    // with costs quantised to queue_resolution)
+    std::string queue;
+    float queue_resolution;
+
     // Print additional performance profiling information
     bool perf_profile = false;
 
@@ -458,6 +458,8 @@ template <typename FrontendType> struct GenericFrontend
         // Import port directions
         dict<IdString, PortType> port_dirs;
         impl.foreach_port_dir(cd, [&](const std::string &port, PortType dir) { port_dirs[ctx->id(port)] = dir; });
+        // Most ports are single bits, so this is usually exact and saves growing the port map one doubling at a time
+        ci->ports.reserve(port_dirs.size());
         // Import port connectivity
         impl.foreach_port_conn(cd, [&](const std::string &name, const bitvector_t &bits) {
             if (!port_dirs.count(ctx->id(name)))
@@ -19,192 +19,748 @@
 
 #include "json_frontend.h"
 #include "frontend_base.h"
-#include "json11.hpp"
 #include "log.h"
 #include "nextpnr.h"
 
+#include <algorithm>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <streambuf>
 
 NEXTPNR_NAMESPACE_BEGIN
 
-using namespace json11;
+namespace {
+
+// A compact, read-only JSON document. Instead of a tree of separately allocated values, every value is a Node in a
+// single array, in document order: a container is directly followed by its contents (for objects, each member is its
+// key string followed by its value) and records the index just past its last descendant, so siblings can be
+// skipped over without any pointers. Strings without escapes are not copied, but refer to the input text, which is
+// normally a memory-mapped file.
+struct JsonDocument
+{
+    enum NodeType : uint8_t
+    {
+        J_NULL,
+        J_BOOL,
+        J_NUMBER,
+        J_STRING,
+        J_ARRAY,
+        J_OBJECT,
+    };
+
+    // Node flags
+    static constexpr uint8_t F_DECODED = 0x01; // string: stored in decoded_strings rather than the text
+    static constexpr uint8_t F_INTEGER = 0x02; // number: exactly representable as int64_t
+    static constexpr uint8_t F_FLAT = 0x04;    // container: contains only scalars, so element i is at index + 1 + i
+    static constexpr uint8_t F_WIDE = 0x08;    // number: doesn't fit in the payload, which indexes wide_numbers
+
+    // Kept to 16 bytes, as a netlist has a node for every few bytes of text
+    struct Node
+    {
+        // Index just past the last node of this value
+        uint32_t end;
+        // Number of elements or members for containers, length for strings
+        uint32_t size;
+        // 48-bit payload: the offset of a string's characters (in either the text or decoded_strings), an integer
+        // (sign extended), a bool, or an index into wide_numbers
+        uint32_t payload_lo;
+        uint16_t payload_hi;
+        NodeType type;
+        uint8_t flags;
+    };
+    static_assert(sizeof(Node) == 16, "JSON node should be 16 bytes");
+
+    union WideNumber
+    {
+        int64_t ival;
+        double dval;
+    };
+
+    const char *text = nullptr;
+    size_t text_size = 0;
+    std::vector<Node> nodes;
+    std::string decoded_strings;
+    // Numbers that aren't integers, or don't fit in 48 bits
+    std::vector<WideNumber> wide_numbers;
+
+    struct ParseError
+    {
+        std::string message;
+        size_t offset;
+    };
+
+    void parse(const char *data, size_t size)
+    {
+        text = data;
+        text_size = size;
+        pos = 0;
+        // Every value but the outermost follows a '[', ',' or ':', and every object key follows a '{' or ','. Counting
+        // those (including any inside strings) gives an upper bound on the number of nodes, so the array is never
+        // reallocated, without reserving much more than it needs.
+        size_t max_nodes = 1;
+        for (size_t i = 0; i < size; i++) {
+            char c = data[i];
+            max_nodes += (c == ',' || c == ':' || c == '[' || c == '{');
+        }
+        nodes.reserve(std::min<size_t>(max_nodes, std::numeric_limits<uint32_t>::max()));
+        skip_ws();
+        parse_value(0);
+        skip_ws();
+        if (pos != text_size)
+            error("unexpected trailing content");
+    }
+
+    // Position in the text in lines, for error messages
+    int line_of(size_t offset) const { return 1 + int(std::count(text, text + std::min(offset, text_size), '\n')); }
+
+    static uint64_t payload(const Node &n) { return uint64_t(n.payload_lo) | (uint64_t(n.payload_hi) << 32); }
+
+    const char *str_data(int idx) const
+    {
+        const Node &n = nodes[idx];
+        return ((n.flags & F_DECODED) ? decoded_strings.data() : text) + payload(n);
+    }
+
+    // For numbers with F_INTEGER set
+    int64_t int_value(int idx) const
+    {
+        const Node &n = nodes[idx];
+        if (n.flags & F_WIDE)
+            return wide_numbers[payload(n)].ival;
+        return int64_t(payload(n) << 16) >> 16;
+    }
+
+    // For numbers without F_INTEGER set
+    double real_value(int idx) const { return wide_numbers[payload(nodes[idx])].dval; }
+
+    std::string str(int idx) const
+    {
+        if (nodes[idx].type != J_STRING)
+            return std::string();
+        return std::string(str_data(idx), nodes[idx].size);
+    }
+
+    bool str_equals(int idx, const char *s, size_t len) const
+    {
+        return nodes[idx].type == J_STRING && nodes[idx].size == len && std::memcmp(str_data(idx), s, len) == 0;
+    }
+
+    int str_compare(int a, int b) const
+    {
+        int result = std::memcmp(str_data(a), str_data(b), std::min(nodes[a].size, nodes[b].size));
+        if (result != 0)
+            return result;
+        return (nodes[a].size < nodes[b].size) ? -1 : (nodes[a].size > nodes[b].size) ? 1 : 0;
+    }
+
+    // The value of an object member, or -1 if idx isn't an object or has no such member. If a key is repeated, the
+    // last value is used.
+    int member(int idx, const char *key) const
+    {
+        if (idx < 0 || nodes[idx].type != J_OBJECT)
+            return -1;
+        size_t key_len = std::strlen(key);
+        int found = -1;
+        for (int i = idx + 1; i < int(nodes[idx].end); i = nodes[i + 1].end) {
+            if (str_equals(i, key, key_len))
+                found = i + 1;
+        }
+        return found;
+    }
+
+    // Calls func(key_idx, value_idx) for each member of an object, doing nothing if idx isn't an object. Members are
+    // visited in key order, skipping all but the last of any repeated key, as the order cells and nets are created
+    // in affects the result of placement and routing; this keeps that the same as it always has been.
+    template <typename TFunc> void foreach_member(int idx, TFunc func) const
+    {
+        if (idx < 0 || nodes[idx].type != J_OBJECT)
+            return;
+        std::vector<int> keys;
+        keys.reserve(nodes[idx].size);
+        bool sorted = true;
+        for (int i = idx + 1; i < int(nodes[idx].end); i = nodes[i + 1].end) {
+            if (!keys.empty() && str_compare(keys.back(), i) >= 0)
+                sorted = false;
+            keys.push_back(i);
+        }
+        if (!sorted) {
+            std::stable_sort(keys.begin(), keys.end(), [&](int a, int b) { return str_compare(a, b) < 0; });
+            // keep the last of each run of equal keys
+            int out = 0;
+            for (int i = 0; i < int(keys.size()); i++) {
+                if (i + 1 < int(keys.size()) && str_compare(keys.at(i), keys.at(i + 1)) == 0)
+                    continue;
+                keys.at(out++) = keys.at(i);
+            }
+            keys.resize(out);
+        }
+        for (int key : keys)
+            func(key, key + 1);
+    }
+
+    int array_size(int idx) const { return (idx >= 0 && nodes[idx].type == J_ARRAY) ? int(nodes[idx].size) : 0; }
+
+    int array_element(int idx, int i) const
+    {
+        NPNR_ASSERT(i >= 0 && i < array_size(idx));
+        if (nodes[idx].flags & F_FLAT)
+            return idx + 1 + i;
+        int elem = idx + 1;
+        for (int j = 0; j < i; j++)
+            elem = nodes[elem].end;
+        return elem;
+    }
+
+  private:
+    size_t pos = 0;
+
+    [[noreturn]] void error(const std::string &message) { throw ParseError{message, pos}; }
+
+    static constexpr int64_t payload_max = (int64_t(1) << 47) - 1;
+
+    int add_node(NodeType type)
+    {
+        if (nodes.size() >= size_t(std::numeric_limits<uint32_t>::max()))
+            error("too many values");
+        nodes.emplace_back();
+        Node &n = nodes.back();
+        n.type = type;
+        n.flags = 0;
+        n.size = 0;
+        set_payload(n, 0);
+        return int(nodes.size()) - 1;
+    }
+
+    static void set_payload(Node &n, uint64_t value)
+    {
+        n.payload_lo = uint32_t(value);
+        n.payload_hi = uint16_t(value >> 32);
+    }
+
+    void set_wide_number(int idx, WideNumber value)
+    {
+        nodes[idx].flags |= F_WIDE;
+        set_payload(nodes[idx], wide_numbers.size());
+        wide_numbers.push_back(value);
+    }
+
+    void skip_ws()
+    {
+        while (pos < text_size) {
+            char c = text[pos];
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                ++pos;
+            } else if (c == '/' && pos + 1 < text_size && text[pos + 1] == '/') {
+                while (pos < text_size && text[pos] != '\n')
+                    ++pos;
+            } else if (c == '/' && pos + 1 < text_size && text[pos + 1] == '*') {
+                pos += 2;
+                while (pos + 1 < text_size && !(text[pos] == '*' && text[pos + 1] == '/'))
+                    ++pos;
+                if (pos + 1 >= text_size)
+                    error("unterminated comment");
+                pos += 2;
+            } else {
+                break;
+            }
+        }
+    }
+
+    void expect_literal(const char *lit)
+    {
+        size_t len = std::strlen(lit);
+        if (text_size - pos < len || std::memcmp(text + pos, lit, len) != 0)
+            error("invalid literal");
+        pos += len;
+    }
+
+    void parse_value(int depth)
+    {
+        if (depth > 1000)
+            error("values nested too deeply");
+        if (pos >= text_size)
+            error("unexpected end of input");
+        char c = text[pos];
+        int idx;
+        if (c == '{') {
+            idx = add_node(J_OBJECT);
+            parse_object(idx, depth);
+        } else if (c == '[') {
+            idx = add_node(J_ARRAY);
+            parse_array(idx, depth);
+        } else if (c == '"') {
+            idx = add_node(J_STRING);
+            parse_string(idx);
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            idx = add_node(J_NUMBER);
+            parse_number(idx);
+        } else if (c == 't' || c == 'f') {
+            idx = add_node(J_BOOL);
+            set_payload(nodes[idx], c == 't');
+            expect_literal((c == 't') ? "true" : "false");
+        } else if (c == 'n') {
+            idx = add_node(J_NULL);
+            expect_literal("null");
+        } else {
+            error(stringf("unexpected character '%c'", c));
+        }
+        nodes[idx].end = uint32_t(nodes.size());
+    }
+
+    void parse_object(int idx, int depth)
+    {
+        ++pos; // {
+        skip_ws();
+        uint32_t count = 0;
+        if (pos < text_size && text[pos] == '}') {
+            ++pos;
+        } else {
+            while (true) {
+                skip_ws();
+                if (pos >= text_size || text[pos] != '"')
+                    error("expected object key");
+                int key = add_node(J_STRING);
+                parse_string(key);
+                nodes[key].end = uint32_t(nodes.size());
+                skip_ws();
+                if (pos >= text_size || text[pos] != ':')
+                    error("expected ':' in object");
+                ++pos;
+                skip_ws();
+                parse_value(depth + 1);
+                ++count;
+                skip_ws();
+                if (pos < text_size && text[pos] == ',') {
+                    ++pos;
+                } else if (pos < text_size && text[pos] == '}') {
+                    ++pos;
+                    break;
+                } else {
+                    error("expected ',' or '}' in object");
+                }
+            }
+        }
+        nodes[idx].size = count;
+    }
+
+    void parse_array(int idx, int depth)
+    {
+        ++pos; // [
+        skip_ws();
+        uint32_t count = 0;
+        bool flat = true;
+        if (pos < text_size && text[pos] == ']') {
+            ++pos;
+        } else {
+            while (true) {
+                skip_ws();
+                int elem = int(nodes.size());
+                parse_value(depth + 1);
+                if (nodes[elem].end != uint32_t(elem) + 1)
+                    flat = false;
+                ++count;
+                skip_ws();
+                if (pos < text_size && text[pos] == ',') {
+                    ++pos;
+                } else if (pos < text_size && text[pos] == ']') {
+                    ++pos;
+                    break;
+                } else {
+                    error("expected ',' or ']' in array");
+                }
+            }
+        }
+        nodes[idx].size = count;
+        if (flat)
+            nodes[idx].flags |= F_FLAT;
+    }
+
+    static void encode_utf8(std::string &out, uint32_t cp)
+    {
+        if (cp < 0x80) {
+            out += char(cp);
+        } else if (cp < 0x800) {
+            out += char(0xC0 | (cp >> 6));
+            out += char(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += char(0xE0 | (cp >> 12));
+            out += char(0x80 | ((cp >> 6) & 0x3F));
+            out += char(0x80 | (cp & 0x3F));
+        } else {
+            out += char(0xF0 | (cp >> 18));
+            out += char(0x80 | ((cp >> 12) & 0x3F));
+            out += char(0x80 | ((cp >> 6) & 0x3F));
+            out += char(0x80 | (cp & 0x3F));
+        }
+    }
+
+    uint32_t parse_hex4()
+    {
+        if (text_size - pos < 4)
+            error("truncated \\u escape");
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = text[pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9')
+                value |= (c - '0');
+            else if (c >= 'a' && c <= 'f')
+                value |= (c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F')
+                value |= (c - 'A' + 10);
+            else
+                error("invalid \\u escape");
+        }
+        return value;
+    }
+
+    void parse_string(int idx)
+    {
+        ++pos; // opening quote
+        size_t start = pos;
+        // Fast path: most strings have no escapes, and can be used in place
+        while (pos < text_size && text[pos] != '"' && text[pos] != '\\')
+            ++pos;
+        if (pos >= text_size)
+            error("unterminated string");
+        if (text[pos] == '"') {
+            set_payload(nodes[idx], start);
+            nodes[idx].size = uint32_t(pos - start);
+            ++pos;
+            return;
+        }
+        // Slow path: decode into decoded_strings
+        size_t decoded_start = decoded_strings.size();
+        decoded_strings.append(text + start, pos - start);
+        while (true) {
+            if (pos >= text_size)
+                error("unterminated string");
+            char c = text[pos++];
+            if (c == '"')
+                break;
+            if (c != '\\') {
+                decoded_strings += c;
+                continue;
+            }
+            if (pos >= text_size)
+                error("unterminated string");
+            char e = text[pos++];
+            switch (e) {
+            case '"':
+            case '\\':
+            case '/':
+                decoded_strings += e;
+                break;
+            case 'b':
+                decoded_strings += '\b';
+                break;
+            case 'f':
+                decoded_strings += '\f';
+                break;
+            case 'n':
+                decoded_strings += '\n';
+                break;
+            case 'r':
+                decoded_strings += '\r';
+                break;
+            case 't':
+                decoded_strings += '\t';
+                break;
+            case 'u': {
+                uint32_t cp = parse_hex4();
+                if (cp >= 0xD800 && cp <= 0xDBFF && text_size - pos >= 6 && text[pos] == '\\' &&
+                    text[pos + 1] == 'u') {
+                    pos += 2;
+                    uint32_t lo = parse_hex4();
+                    if (lo >= 0xDC00 && lo <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    } else {
+                        encode_utf8(decoded_strings, cp);
+                        cp = lo;
+                    }
+                }
+                encode_utf8(decoded_strings, cp);
+                break;
+            }
+            default:
+                error("invalid escape sequence");
+            }
+        }
+        nodes[idx].flags |= F_DECODED;
+        set_payload(nodes[idx], decoded_start);
+        nodes[idx].size = uint32_t(decoded_strings.size() - decoded_start);
+    }
+
+    void parse_number(int idx)
+    {
+        size_t start = pos;
+        bool negative = false;
+        if (text[pos] == '-') {
+            negative = true;
+            ++pos;
+        }
+        uint64_t value = 0;
+        bool overflow = false;
+        size_t digits_start = pos;
+        while (pos < text_size && text[pos] >= '0' && text[pos] <= '9') {
+            uint64_t digit = text[pos] - '0';
+            if (value > (uint64_t(INT64_MAX) - digit) / 10)
+                overflow = true;
+            else
+                value = value * 10 + digit;
+            ++pos;
+        }
+        if (pos == digits_start)
+            error("invalid number");
+        bool integer = !overflow;
+        if (pos < text_size && (text[pos] == '.' || text[pos] == 'e' || text[pos] == 'E')) {
+            integer = false;
+            while (pos < text_size &&
+                   ((text[pos] >= '0' && text[pos] <= '9') || text[pos] == '.' || text[pos] == 'e' ||
+                    text[pos] == 'E' || text[pos] == '+' || text[pos] == '-'))
+                ++pos;
+        }
+        if (integer) {
+            nodes[idx].flags |= F_INTEGER;
+            int64_t ival = negative ? -int64_t(value) : int64_t(value);
+            if (ival >= -payload_max - 1 && ival <= payload_max) {
+                set_payload(nodes[idx], uint64_t(ival));
+            } else {
+                WideNumber wide;
+                wide.ival = ival;
+                set_wide_number(idx, wide);
+            }
+        } else {
+            WideNumber wide;
+            wide.dval = std::strtod(std::string(text + start, pos - start).c_str(), nullptr);
+            set_wide_number(idx, wide);
+        }
+    }
+};
 
 struct JsonFrontendImpl
 {
     // See specification in frontend_base.h
-    JsonFrontendImpl(Json &root) : root(root) {};
-    Json &root;
-    typedef const Json &ModuleDataType;
-    typedef const Json &ModulePortDataType;
-    typedef const Json &CellDataType;
-    typedef const Json &NetnameDataType;
-    typedef const Json::array &BitVectorDataType;
+    JsonFrontendImpl(const JsonDocument &doc, int modules) : doc(doc), modules(modules) {};
+    const JsonDocument &doc;
+    int modules;
+    // All of these are node indices into doc
+    typedef int ModuleDataType;
+    typedef int ModulePortDataType;
+    typedef int CellDataType;
+    typedef int NetnameDataType;
+    typedef int BitVectorDataType;
 
     template <typename TFunc> void foreach_module(TFunc Func) const
     {
-        for (const auto &mod : root.object_items())
-            Func(mod.first, mod.second);
+        doc.foreach_member(modules, [&](int key, int mod) { Func(doc.str(key), mod); });
     }
 
-    template <typename TFunc> void foreach_port(ModuleDataType &mod, TFunc Func) const
+    template <typename TFunc> void foreach_port(ModuleDataType mod, TFunc Func) const
     {
-        const auto &ports = mod["ports"];
-        if (ports.is_null())
-            return;
-        for (const auto &port : ports.object_items())
-            Func(port.first, port.second);
+        doc.foreach_member(doc.member(mod, "ports"), [&](int key, int port) { Func(doc.str(key), port); });
     }
 
-    template <typename TFunc> void foreach_cell(ModuleDataType &mod, TFunc Func) const
+    template <typename TFunc> void foreach_cell(ModuleDataType mod, TFunc Func) const
     {
-        const auto &cells = mod["cells"];
-        if (cells.is_null())
-            return;
-        for (const auto &cell : cells.object_items())
-            Func(cell.first, cell.second);
+        doc.foreach_member(doc.member(mod, "cells"), [&](int key, int cell) { Func(doc.str(key), cell); });
     }
 
-    template <typename TFunc> void foreach_netname(ModuleDataType &mod, TFunc Func) const
+    template <typename TFunc> void foreach_netname(ModuleDataType mod, TFunc Func) const
     {
-        const auto &netnames = mod["netnames"];
-        if (netnames.is_null())
-            return;
-        for (const auto &netname : netnames.object_items())
-            Func(netname.first, netname.second);
+        doc.foreach_member(doc.member(mod, "netnames"), [&](int key, int net) { Func(doc.str(key), net); });
     }
 
-    PortType lookup_portdir(const std::string &dir) const
+    PortType lookup_portdir(int dir) const
     {
-        if (dir == "input")
+        if (doc.str_equals(dir, "input", 5))
             return PORT_IN;
-        else if (dir == "inout")
+        else if (doc.str_equals(dir, "inout", 5))
             return PORT_INOUT;
-        else if (dir == "output")
+        else if (doc.str_equals(dir, "output", 6))
             return PORT_OUT;
         else
             NPNR_ASSERT_FALSE("invalid json port direction");
     }
 
-    PortType get_port_dir(ModulePortDataType &port) const { return lookup_portdir(port["direction"].string_value()); }
+    PortType get_port_dir(ModulePortDataType port) const { return lookup_portdir(doc.member(port, "direction")); }
 
-    int get_array_offset(const Json &obj) const
+    int64_t int_value(int idx) const
     {
-        auto offset = obj["offset"];
-        return offset.is_null() ? 0 : offset.int_value();
+        if (idx < 0 || doc.nodes[idx].type != JsonDocument::J_NUMBER)
+            return 0;
+        return (doc.nodes[idx].flags & JsonDocument::F_INTEGER) ? doc.int_value(idx) : int64_t(doc.real_value(idx));
     }
 
-    bool is_array_upto(const Json &obj) const
-    {
-        auto upto = obj["upto"];
-        return upto.is_null() ? false : bool(upto.int_value());
-    }
+    int get_array_offset(int obj) const { return int(int_value(doc.member(obj, "offset"))); }
+
+    bool is_array_upto(int obj) const { return bool(int_value(doc.member(obj, "upto"))); }
 
-    BitVectorDataType &get_port_bits(ModulePortDataType &port) const { return port["bits"].array_items(); }
+    BitVectorDataType get_port_bits(ModulePortDataType port) const { return doc.member(port, "bits"); }
 
-    const std::string &get_cell_type(CellDataType &cell) const { return cell["type"].string_value(); }
+    std::string get_cell_type(CellDataType cell) const { return doc.str(doc.member(cell, "type")); }
 
-    Property parse_property(const Json &val) const
+    Property parse_property(int val) const
     {
-        if (val.is_number()) {
-            if (val.int_value() != val.number_value())
+        if (doc.nodes[val].type == JsonDocument::J_NUMBER) {
+            // Like json11 did, accept any number with an integer value, such as 1.0
+            bool in_range;
+            int value = 0;
+            if (doc.nodes[val].flags & JsonDocument::F_INTEGER) {
+                int64_t ival = doc.int_value(val);
+                in_range = (ival >= INT_MIN && ival <= INT_MAX);
+                value = int(ival);
+            } else {
+                double dval = doc.real_value(val);
+                in_range = (dval >= INT_MIN && dval <= INT_MAX && dval == std::trunc(dval));
+                value = in_range ? int(dval) : 0;
+            }
+            if (!in_range)
                 log_error("Found an out-of-range integer parameter in the JSON file.\n"
                           "Please regenerate the input file with an up-to-date version of yosys.\n");
-            return Property(val.int_value(), 32);
+            return Property(value, 32);
         } else {
-            return Property::from_string(val.string_value());
+            return Property::from_string(doc.str(val));
         }
     }
 
-    template <typename TFunc> void foreach_attr(const Json &obj, TFunc Func) const
+    template <typename TFunc> void foreach_attr(int obj, TFunc Func) const
     {
-        const auto &attrs = obj["attributes"];
-        if (attrs.is_null())
-            return;
-        for (const auto &attr : attrs.object_items()) {
-            Func(attr.first, parse_property(attr.second));
-        }
+        doc.foreach_member(doc.member(obj, "attributes"),
+                           [&](int key, int value) { Func(doc.str(key), parse_property(value)); });
     }
 
-    template <typename TFunc> void foreach_param(const Json &obj, TFunc Func) const
+    template <typename TFunc> void foreach_param(int obj, TFunc Func) const
     {
-        const auto &params = obj["parameters"];
-        if (params.is_null())
-            return;
-        for (const auto &param : params.object_items()) {
-            Func(param.first, parse_property(param.second));
-        }
+        doc.foreach_member(doc.member(obj, "parameters"),
+                           [&](int key, int value) { Func(doc.str(key), parse_property(value)); });
     }
 
-    template <typename TFunc> void foreach_setting(const Json &obj, TFunc Func) const
+    template <typename TFunc> void foreach_setting(int obj, TFunc Func) const
     {
-        const auto &settings = obj["settings"];
-        if (settings.is_null())
-            return;
-        for (const auto &setting : settings.object_items()) {
-            Func(setting.first, parse_property(setting.second));
-        }
+        doc.foreach_member(doc.member(obj, "settings"),
+                           [&](int key, int value) { Func(doc.str(key), parse_property(value)); });
     }
 
-    template <typename TFunc> void foreach_port_dir(CellDataType &cell, TFunc Func) const
+    template <typename TFunc> void foreach_port_dir(CellDataType cell, TFunc Func) const
     {
-        for (const auto &pdir : cell["port_directions"].object_items())
-            Func(pdir.first, lookup_portdir(pdir.second.string_value()));
+        doc.foreach_member(doc.member(cell, "port_directions"),
+                           [&](int key, int dir) { Func(doc.str(key), lookup_portdir(dir)); });
     }
 
-    template <typename TFunc> void foreach_port_conn(CellDataType &cell, TFunc Func) const
+    template <typename TFunc> void foreach_port_conn(CellDataType cell, TFunc Func) const
     {
-        for (const auto &pconn : cell["connections"].object_items())
-            Func(pconn.first, pconn.second.array_items());
+        doc.foreach_member(doc.member(cell, "connections"), [&](int key, int bits) { Func(doc.str(key), bits); });
     }
 
-    BitVectorDataType &get_net_bits(NetnameDataType &net) const { return net["bits"].array_items(); }
+    BitVectorDataType get_net_bits(NetnameDataType net) const { return doc.member(net, "bits"); }
 
-    int get_vector_length(BitVectorDataType &bits) const { return int(bits.size()); }
+    int get_vector_length(BitVectorDataType bits) const { return doc.array_size(bits); }
 
-    bool is_vector_bit_undef(BitVectorDataType &bits, int i) const
+    bool is_vector_bit_undef(BitVectorDataType bits, int i) const
     {
-        NPNR_ASSERT(i < int(bits.size()));
-        return bits[i] == "x";
+        return doc.str_equals(doc.array_element(bits, i), "x", 1);
     }
 
-    bool is_vector_bit_constant(BitVectorDataType &bits, int i) const
+    bool is_vector_bit_constant(BitVectorDataType bits, int i) const
     {
-        NPNR_ASSERT(i < int(bits.size()));
-        return bits[i].is_string();
+        return doc.nodes[doc.array_element(bits, i)].type == JsonDocument::J_STRING;
     }
 
-    char get_vector_bit_constval(BitVectorDataType &bits, int i) const
+    char get_vector_bit_constval(BitVectorDataType bits, int i) const
     {
-        auto s = bits.at(i).string_value();
-        NPNR_ASSERT(s.size() == 1);
-        return s.at(0);
+        int bit = doc.array_element(bits, i);
+        NPNR_ASSERT(doc.nodes[bit].type == JsonDocument::J_STRING && doc.nodes[bit].size == 1);
+        return doc.str_data(bit)[0];
     }
 
-    int get_vector_bit_signal(BitVectorDataType &bits, int i) const
+    int get_vector_bit_signal(BitVectorDataType bits, int i) const
     {
-        NPNR_ASSERT(bits.at(i).is_number());
-        return bits.at(i).int_value();
+        int bit = doc.array_element(bits, i);
+        NPNR_ASSERT(doc.nodes[bit].type == JsonDocument::J_NUMBER);
+        return int(int_value(bit));
     }
 };
 
-bool parse_json(std::istream &in, const std::string &filename, Context *ctx)
+bool load_json_document(const char *data, size_t size, const std::string &filename, Context *ctx)
 {
-    Json root;
-    {
-        if (!in)
-            log_error("Failed to open JSON file '%s'.\n", filename.c_str());
-        std::string json_str((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
-        std::string error;
-        root = Json::parse(json_str, error, JsonParse::COMMENTS);
-        if (root.is_null())
-            log_error("Failed to parse JSON file '%s': %s.\n", filename.c_str(), error.c_str());
-        root = root["modules"];
-        if (root.is_null())
-            log_error("JSON file '%s' doesn't look like a netlist (doesn't contain \"modules\" key)\n",
-                      filename.c_str());
-    }
-    GenericFrontend<JsonFrontendImpl>(ctx, JsonFrontendImpl(root), /*split_io=*/true)();
+    auto start = std::chrono::steady_clock::now();
+    JsonDocument doc;
+    try {
+        doc.parse(data, size);
+    } catch (const JsonDocument::ParseError &e) {
+        log_error("Failed to parse JSON file '%s': %s at line %d.\n", filename.c_str(), e.message.c_str(),
+                  doc.line_of(e.offset));
+    }
+    int modules = doc.member(0, "modules");
+    if (modules == -1 || doc.nodes[modules].type != JsonDocument::J_OBJECT)
+        log_error("JSON file '%s' doesn't look like a netlist (doesn't contain \"modules\" key)\n", filename.c_str());
+    auto parsed = std::chrono::steady_clock::now();
+
+    GenericFrontend<JsonFrontendImpl>(ctx, JsonFrontendImpl(doc, modules), /*split_io=*/true)();
+
+    if (ctx->verbose) {
+        auto end = std::chrono::steady_clock::now();
+        log_info("Loaded %.1f MiB JSON netlist in %.2fs (parse %.2fs, import %.2fs).\n", size / (1024.0 * 1024.0),
+                 std::chrono::duration<double>(end - start).count(),
+                 std::chrono::duration<double>(parsed - start).count(),
+                 std::chrono::duration<double>(end - parsed).count());
+        log_info("    %d JSON values (%.1f MiB), %.1f MiB of decoded strings\n", int(doc.nodes.size()),
+                 doc.nodes.size() * sizeof(JsonDocument::Node) / (1024.0 * 1024.0),
+                 doc.decoded_strings.size() / (1024.0 * 1024.0));
+        double peak = peak_memory_mib();
+        if (peak >= 0)
+            log_info("    peak memory usage %.1f MiB\n", peak);
+    }
     return true;
 }
 
+} // namespace
+
+bool parse_json(std::istream &in, const std::string &filename, Context *ctx)
+{
+    if (!in)
+        log_error("Failed to open JSON file '%s'.\n", filename.c_str());
+    std::string json_str((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return load_json_document(json_str.data(), json_str.size(), filename, ctx);
+}
+
+bool parse_json(const std::string &filename, Context *ctx)
+{
+    boost::iostreams::mapped_file_source file;
+    try {
+        file.open(filename);
+    } catch (...) {
+        // Mapping fails for empty files and some special files such as pipes; fall back to reading it
+        std::ifstream in(filename, std::ios::binary);
+        return parse_json(in, filename, ctx);
+    }
+    if (!file.is_open())
+        log_error("Failed to open JSON file '%s'.\n", filename.c_str());
+    if (file.size() >= 2 && uint8_t(file.data()[0]) == 0x1f && uint8_t(file.data()[1]) == 0x8b) {
+        // gzip compressed, as written by --write with a .gz name
+        namespace io = boost::iostreams;
+        io::filtering_istream in;
+        in.push(io::gzip_decompressor());
+        in.push(io::array_source(file.data(), file.size()));
+        std::string json_str;
+        try {
+            json_str.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        } catch (const io::gzip_error &e) {
+            log_error("Failed to decompress JSON file '%s': %s.\n", filename.c_str(), e.what());
+        }
+        return load_json_document(json_str.data(), json_str.size(), filename, ctx);
+    }
+    return load_json_document(file.data(), file.size(), filename, ctx);
+}
+
 NEXTPNR_NAMESPACE_END
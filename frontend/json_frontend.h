@@ -22,5 +22,7 @@
 NEXTPNR_NAMESPACE_BEGIN
 
 bool parse_json(std::istream &in, const std::string &filename, Context *ctx);
+// Reads the netlist straight from a memory mapping of the file, rather than copying it through a stream first
+bool parse_json(const std::string &filename, Context *ctx);
 
 NEXTPNR_NAMESPACE_END
@@ -384,8 +384,7 @@ void BaseMainWindow::save_json()
     QString fileName = QFileDialog::getSaveFileName(this, QString("Save JSON"), QString(), QString("*.json"));
     if (!fileName.isEmpty()) {
         std::string fn = fileName.toStdString();
-        std::ofstream f(fn);
-        if (write_json_file(f, fn, ctx.get()))
+        if (write_json_file(fn, ctx.get()))
             log("Saving JSON successful.\n");
         else
             log("Saving JSON failed.\n");
@@ -17,6 +17,7 @@
  *
  */
 
+#include <algorithm>
 #include <cstdio>
 #include <math.h>
 
@@ -224,26 +225,7 @@ void FPGAViewWidget::renderDecal(LineShaderData &out, PickQuadTree::BoundingBox
     }
 }
 
-void FPGAViewWidget::renderArchDecal(LineShaderData out[GraphicElement::STYLE_MAX], PickQuadTree::BoundingBox &bb,
-                                     const DecalXY &decal)
-{
-    float offsetX = decal.x;
-    float offsetY = decal.y;
-
-    for (auto &el : ctx_->getDecalGraphics(decal.decal)) {
-        switch (el.style) {
-        case GraphicElement::STYLE_FRAME:
-        case GraphicElement::STYLE_INACTIVE:
-        case GraphicElement::STYLE_ACTIVE:
-            renderGraphicElement(out[el.style], bb, el, offsetX, offsetY);
-            break;
-        default:
-            break;
-        }
-    }
-}
-
-void FPGAViewWidget::populateQuadTree(RendererData *data, const DecalXY &decal, const PickedElement &element)
+bool FPGAViewWidget::populateQuadTree(RendererData *data, const DecalXY &decal, const PickedElement &element)
 {
     float x = decal.x;
     float y = decal.y;
@@ -279,10 +261,79 @@ void FPGAViewWidget::populateQuadTree(RendererData *data, const DecalXY &decal,
             res = data->qt->insert(PickQuadTree::BoundingBox(x0, y0, x1, y1), element);
         }
 
-        if (!res) {
-            NPNR_ASSERT_FALSE("populateQuadTree: could not insert element");
+        if (!res)
+            return false;
+    }
+    return true;
+}
+
+int FPGAViewWidget::chunkAt(const DecalXY &decal) const
+{
+    // Many arches leave DecalXY at (0, 0) and draw in absolute coordinates, so go by the middle of the graphics
+    // themselves rather than by the decal's origin.
+    float x0 = decal.x, y0 = decal.y, x1 = decal.x, y1 = decal.y;
+    bool first = true;
+    for (auto &el : ctx_->getDecalGraphics(decal.decal)) {
+        if (el.style == GraphicElement::STYLE_HIDDEN)
+            continue;
+        float ex0 = decal.x + std::min(el.x1, el.x2), ex1 = decal.x + std::max(el.x1, el.x2);
+        float ey0 = decal.y + std::min(el.y1, el.y2), ey1 = decal.y + std::max(el.y1, el.y2);
+        x0 = first ? ex0 : std::min(x0, ex0);
+        y0 = first ? ey0 : std::min(y0, ey0);
+        x1 = first ? ex1 : std::max(x1, ex1);
+        y1 = first ? ey1 : std::max(y1, ey1);
+        first = false;
+    }
+    int cx = std::min(std::max(int(std::floor((x0 + x1) / 2)) / chunkTiles_, 0), decalCache_.chunksX - 1);
+    int cy = std::min(std::max(int(std::floor((y0 + y1) / 2)) / chunkTiles_, 0), decalCache_.chunksY - 1);
+    return cy * decalCache_.chunksX + cx;
+}
+
+void FPGAViewWidget::renderChunk(int chunk, ChunkData &out, PickQuadTree::BoundingBox &bb)
+{
+    const DecalCache &cache = decalCache_;
+    int gridX = std::max(1, ctx_->getGridDimX()), gridY = std::max(1, ctx_->getGridDimY());
+
+    // Active graphics in each tile, counted where each graphic element is. These are mostly in the chunk's own
+    // tiles, but an element whose decal straddles chunks is counted in the tile it is actually drawn in.
+    dict<std::pair<int, int>, int> density;
+
+    for (int idx : cache.chunkElements.at(chunk)) {
+        const DecalXY &decal = cache.decals.at(idx);
+        for (auto &el : ctx_->getDecalGraphics(decal.decal)) {
+            if (el.style == GraphicElement::STYLE_ACTIVE) {
+                int tx = std::min(std::max(int(std::floor(decal.x + (el.x1 + el.x2) / 2)), 0), gridX - 1);
+                int ty = std::min(std::max(int(std::floor(decal.y + (el.y1 + el.y2) / 2)), 0), gridY - 1);
+                density[std::make_pair(tx, ty)]++;
+            }
+            switch (el.style) {
+            case GraphicElement::STYLE_FRAME:
+            case GraphicElement::STYLE_ACTIVE:
+            case GraphicElement::STYLE_INACTIVE:
+                renderGraphicElement(out.gfxByStyle[el.style], bb, el, decal.x, decal.y);
+                break;
+            default:
+                break;
+            }
         }
     }
+
+    for (auto &tile : density) {
+        int count = tile.second;
+        // Levels for 1-3, 4-15, 16-63 and 64 or more active graphics. Fixed thresholds rather than scaling to the
+        // busiest tile, so that changing one chunk never means redrawing the others.
+        int level = 0;
+        while (level < lodLevels_ - 1 && count >= (4 << (2 * level)))
+            level++;
+        // Drawn as a horizontal line through the middle of the tile, as thick as the tile is tall.
+        float x = tile.first.first, y = tile.first.second + 0.5f;
+        PolyLine(x, y, x + 1.0f, y).build(out.gfxDensity[level]);
+    }
+
+    for (auto &gfx : out.gfxByStyle)
+        gfx.last_render = ++renderCounter_;
+    for (auto &gfx : out.gfxDensity)
+        gfx.last_render = ++renderCounter_;
 }
 
 QMatrix4x4 FPGAViewWidget::getProjection(void)
@@ -326,9 +377,21 @@ void FPGAViewWidget::paintGL()
 
     // Render Arch graphics.
     lineShader_.draw(GraphicElement::STYLE_FRAME, colors_.frame, thick11Px, matrix);
-    lineShader_.draw(GraphicElement::STYLE_HIDDEN, colors_.hidden, thick11Px, matrix);
-    lineShader_.draw(GraphicElement::STYLE_INACTIVE, colors_.inactive, thick11Px, matrix);
-    lineShader_.draw(GraphicElement::STYLE_ACTIVE, colors_.active, thick11Px, matrix);
+    if (1.0f / thick1Px < lodTilePixels_) {
+        // Zoomed too far out to make out individual wires and pips: shade each tile by how much is in use instead.
+        for (int level = 0; level < lodLevels_; level++) {
+            float t = float(level + 1) / lodLevels_;
+            QColor inactive = colors_.inactive, active = colors_.active;
+            QColor color = QColor::fromRgbF(inactive.redF() + t * (active.redF() - inactive.redF()),
+                                            inactive.greenF() + t * (active.greenF() - inactive.greenF()),
+                                            inactive.blueF() + t * (active.blueF() - inactive.blueF()));
+            lineShader_.draw(GraphicElement::STYLE_MAX + level, color, 0.9f, matrix);
+        }
+    } else {
+        lineShader_.draw(GraphicElement::STYLE_HIDDEN, colors_.hidden, thick11Px, matrix);
+        lineShader_.draw(GraphicElement::STYLE_INACTIVE, colors_.inactive, thick11Px, matrix);
+        lineShader_.draw(GraphicElement::STYLE_ACTIVE, colors_.active, thick11Px, matrix);
+    }
 
     // Draw highlighted items.
     for (int i = 0; i < 8; i++) {
@@ -388,47 +451,58 @@ void FPGAViewWidget::renderLines(void)
     if (ctx_ == nullptr)
         return;
 
-    // Data from Context needed to render all decals.
+    DecalCache &cache = decalCache_;
+
+    // Data from Context needed to render all decals, on a full reload.
     std::vector<std::pair<DecalXY, BelId>> belDecals;
     std::vector<std::pair<DecalXY, WireId>> wireDecals;
     std::vector<std::pair<DecalXY, PipId>> pipDecals;
     std::vector<std::pair<DecalXY, GroupId>> groupDecals;
-    bool decalsChanged = false;
+    bool fullReload = false;
+    // Otherwise, the new decals of the elements that the Context says have changed.
+    std::vector<std::pair<int, DecalXY>> changedDecals;
     {
         // Take the UI/Normal mutex on the Context, copy over all we need as
         // fast as we can.
         std::lock_guard<std::mutex> lock_ui(ctx_->ui_mutex);
         std::lock_guard<std::mutex> lock(ctx_->mutex);
 
-        // For now, collapse any decal changes into change of all decals.
-        // TODO(q3k): fix this
-        if (ctx_->allUiReload) {
+        bool displayChanged = cache.bels != displayBel_ || cache.wires != displayWire_ || cache.pips != displayPip_ ||
+                              cache.groups != displayGroup_;
+        if (ctx_->allUiReload || ctx_->frameUiReload || !cache.valid || displayChanged) {
             ctx_->allUiReload = false;
-            decalsChanged = true;
-        }
-        if (ctx_->frameUiReload) {
             ctx_->frameUiReload = false;
-            decalsChanged = true;
-        }
-        if (ctx_->belUiReload.size() > 0) {
-            ctx_->belUiReload.clear();
-            decalsChanged = true;
-        }
-        if (ctx_->wireUiReload.size() > 0) {
-            ctx_->wireUiReload.clear();
-            decalsChanged = true;
-        }
-        if (ctx_->pipUiReload.size() > 0) {
-            ctx_->pipUiReload.clear();
-            decalsChanged = true;
-        }
-        if (ctx_->groupUiReload.size() > 0) {
-            ctx_->groupUiReload.clear();
-            decalsChanged = true;
+            fullReload = true;
+        } else {
+            // Only look up the decals that changed; elements that aren't displayed won't be in the cache.
+            for (auto bel : ctx_->belUiReload) {
+                auto found = cache.belIndex.find(bel);
+                if (found != cache.belIndex.end())
+                    changedDecals.emplace_back(found->second, ctx_->getBelDecal(bel));
+            }
+            for (auto wire : ctx_->wireUiReload) {
+                auto found = cache.wireIndex.find(wire);
+                if (found != cache.wireIndex.end())
+                    changedDecals.emplace_back(found->second, ctx_->getWireDecal(wire));
+            }
+            for (auto pip : ctx_->pipUiReload) {
+                auto found = cache.pipIndex.find(pip);
+                if (found != cache.pipIndex.end())
+                    changedDecals.emplace_back(found->second, ctx_->getPipDecal(pip));
+            }
+            for (auto group : ctx_->groupUiReload) {
+                auto found = cache.groupIndex.find(group);
+                if (found != cache.groupIndex.end())
+                    changedDecals.emplace_back(found->second, ctx_->getGroupDecal(group));
+            }
         }
+        ctx_->belUiReload.clear();
+        ctx_->wireUiReload.clear();
+        ctx_->pipUiReload.clear();
+        ctx_->groupUiReload.clear();
 
         // Local copy of decals, taken as fast as possible to not block the P&R.
-        if (decalsChanged) {
+        if (fullReload) {
             if (displayBel_) {
                 for (auto bel : ctx_->getBels()) {
                     belDecals.push_back({ctx_->getBelDecal(bel), bel});
@@ -474,43 +548,47 @@ void FPGAViewWidget::renderLines(void)
         rendererArgs_->gridChanged = false;
     }
 
-    // Render decals if necessary.
-    if (decalsChanged) {
-        int last_render[GraphicElement::STYLE_HIGHLIGHTED0];
-        {
-            QMutexLocker locker(&rendererDataLock_);
-            for (int i = 0; i < GraphicElement::STYLE_HIGHLIGHTED0; i++)
-                last_render[i] = rendererData_->gfxByStyle[(enum GraphicElement::style_t)i].last_render;
-        }
+    if (fullReload) {
+        // Rebuild the cache of what is drawn where.
+        cache = DecalCache();
+        cache.bels = displayBel_;
+        cache.wires = displayWire_;
+        cache.pips = displayPip_;
+        cache.groups = displayGroup_;
+        cache.chunksX = std::max(1, (ctx_->getGridDimX() + chunkTiles_ - 1) / chunkTiles_);
+        cache.chunksY = std::max(1, (ctx_->getGridDimY() + chunkTiles_ - 1) / chunkTiles_);
+        cache.chunkElements.resize(cache.chunksX * cache.chunksY);
+
+        auto addElement = [&](const DecalXY &decal, const PickedElement &element) {
+            int idx = int(cache.elements.size());
+            int chunk = chunkAt(decal);
+            cache.elements.push_back(element);
+            cache.decals.push_back(decal);
+            cache.elementChunk.push_back(chunk);
+            cache.chunkElements.at(chunk).push_back(idx);
+            return idx;
+        };
+        for (auto const &decal : belDecals)
+            cache.belIndex[decal.second] =
+                    addElement(decal.first, PickedElement::fromBel(decal.second, decal.first.x, decal.first.y));
+        for (auto const &decal : wireDecals)
+            cache.wireIndex[decal.second] =
+                    addElement(decal.first, PickedElement::fromWire(decal.second, decal.first.x, decal.first.y));
+        for (auto const &decal : pipDecals)
+            cache.pipIndex[decal.second] =
+                    addElement(decal.first, PickedElement::fromPip(decal.second, decal.first.x, decal.first.y));
+        for (auto const &decal : groupDecals)
+            cache.groupIndex[decal.second] =
+                    addElement(decal.first, PickedElement::fromGroup(decal.second, decal.first.x, decal.first.y));
 
         auto data = std::unique_ptr<FPGAViewWidget::RendererData>(new FPGAViewWidget::RendererData);
         // Reset bounding box.
         data->bbGlobal.clear();
 
-        // Draw Bels.
-        if (displayBel_) {
-            for (auto const &decal : belDecals) {
-                renderArchDecal(data->gfxByStyle, data->bbGlobal, decal.first);
-            }
-        }
-        // Draw Wires.
-        if (displayWire_) {
-            for (auto const &decal : wireDecals) {
-                renderArchDecal(data->gfxByStyle, data->bbGlobal, decal.first);
-            }
-        }
-        // Draw Pips.
-        if (displayPip_) {
-            for (auto const &decal : pipDecals) {
-                renderArchDecal(data->gfxByStyle, data->bbGlobal, decal.first);
-            }
-        }
-        // Draw Groups.
-        if (displayGroup_) {
-            for (auto const &decal : groupDecals) {
-                renderArchDecal(data->gfxByStyle, data->bbGlobal, decal.first);
-            }
-        }
+        // Draw every chunk.
+        data->chunks.resize(cache.chunkElements.size());
+        for (int i = 0; i < int(data->chunks.size()); i++)
+            renderChunk(i, data->chunks.at(i), data->bbGlobal);
 
         // Bounding box should be calculated by now.
         NPNR_ASSERT(data->bbGlobal.w() != 0);
@@ -527,22 +605,11 @@ void FPGAViewWidget::renderLines(void)
 
         // Populate picking quadtree.
         data->qt = std::unique_ptr<PickQuadTree>(new PickQuadTree(bb));
-        for (auto const &decal : belDecals) {
-            populateQuadTree(data.get(), decal.first,
-                             PickedElement::fromBel(decal.second, decal.first.x, decal.first.y));
-        }
-        for (auto const &decal : wireDecals) {
-            populateQuadTree(data.get(), decal.first,
-                             PickedElement::fromWire(decal.second, decal.first.x, decal.first.y));
-        }
-        for (auto const &decal : pipDecals) {
-            populateQuadTree(data.get(), decal.first,
-                             PickedElement::fromPip(decal.second, decal.first.x, decal.first.y));
-        }
-        for (auto const &decal : groupDecals) {
-            populateQuadTree(data.get(), decal.first,
-                             PickedElement::fromGroup(decal.second, decal.first.x, decal.first.y));
+        for (int i = 0; i < int(cache.elements.size()); i++) {
+            if (!populateQuadTree(data.get(), cache.decals.at(i), cache.elements.at(i)))
+                NPNR_ASSERT_FALSE("populateQuadTree: could not insert element");
         }
+        cache.valid = true;
 
         // Swap over.
         {
@@ -557,10 +624,81 @@ void FPGAViewWidget::renderLines(void)
                 for (int i = 0; i < 8; i++)
                     data->gfxHighlighted[i] = rendererData_->gfxHighlighted[i];
             }
-            for (int i = 0; i < GraphicElement::STYLE_HIGHLIGHTED0; i++)
-                data->gfxByStyle[(enum GraphicElement::style_t)i].last_render = ++last_render[i];
             rendererData_ = std::move(data);
         }
+    } else if (!changedDecals.empty()) {
+        // Only re-render the chunks with elements whose decal changed.
+        std::vector<int> changedElements;
+        std::vector<int> dirtyChunks;
+        std::vector<bool> isDirty(cache.chunkElements.size(), false);
+        auto markDirty = [&](int chunk) {
+            if (!isDirty.at(chunk)) {
+                isDirty.at(chunk) = true;
+                dirtyChunks.push_back(chunk);
+            }
+        };
+        // Whether two decals put their graphics in the same places, whatever their styles
+        auto samePlace = [&](const DecalXY &a, const DecalXY &b) {
+            if (a == b)
+                return true;
+            if (a.x != b.x || a.y != b.y)
+                return false;
+            auto ga = ctx_->getDecalGraphics(a.decal), gb = ctx_->getDecalGraphics(b.decal);
+            if (ga.size() != gb.size())
+                return false;
+            for (size_t i = 0; i < ga.size(); i++) {
+                if (ga[i].type != gb[i].type || ga[i].x1 != gb[i].x1 || ga[i].y1 != gb[i].y1 ||
+                    ga[i].x2 != gb[i].x2 || ga[i].y2 != gb[i].y2)
+                    return false;
+            }
+            return true;
+        };
+        for (auto &change : changedDecals) {
+            int idx = change.first;
+            int oldChunk = cache.elementChunk.at(idx);
+            markDirty(oldChunk);
+            // Binding or unbinding usually only restyles an element (some arches, e.g. ice40 wires, only flip
+            // DecalId::active, which DecalId::operator== ignores). The chunk still has to be redrawn, but an
+            // element that hasn't moved stays in its chunk and needs no new quadtree entry.
+            bool unmoved = samePlace(cache.decals.at(idx), change.second);
+            cache.decals.at(idx) = change.second;
+            if (unmoved)
+                continue;
+            changedElements.push_back(idx);
+            int newChunk = chunkAt(change.second);
+            if (newChunk != oldChunk) {
+                auto &oldElements = cache.chunkElements.at(oldChunk);
+                oldElements.erase(std::find(oldElements.begin(), oldElements.end(), idx));
+                cache.chunkElements.at(newChunk).push_back(idx);
+                cache.elementChunk.at(idx) = newChunk;
+                markDirty(newChunk);
+            }
+        }
+
+        std::vector<ChunkData> chunkData(dirtyChunks.size());
+        PickQuadTree::BoundingBox bb;
+        for (int i = 0; i < int(dirtyChunks.size()); i++)
+            renderChunk(dirtyChunks.at(i), chunkData.at(i), bb);
+
+        {
+            QMutexLocker lock(&rendererDataLock_);
+            for (int i = 0; i < int(dirtyChunks.size()); i++)
+                rendererData_->chunks.at(dirtyChunks.at(i)) = std::move(chunkData.at(i));
+
+            // Picking works out the distance to an element from its current decal, so all the quadtree has to do is
+            // cover where the element's graphics now are. The old entries can stay.
+            for (int idx : changedElements) {
+                if (!populateQuadTree(rendererData_.get(), cache.decals.at(idx), cache.elements.at(idx))) {
+                    // Drawn outside the bounds of the tree.
+                    cache.valid = false;
+                    break;
+                }
+                cache.quadTreeAdded++;
+            }
+        }
+        // Once the tree holds as many stale entries as live ones, the next run rebuilds everything from scratch.
+        if (cache.quadTreeAdded > int(cache.elements.size()))
+            cache.valid = false;
     }
     if (gridChanged) {
         QMutexLocker locker(&rendererDataLock_);
@@ -950,8 +1088,17 @@ void FPGAViewWidget::update_vbos()
 {
     lineShader_.update_vbos(GraphicElement::STYLE_GRID, rendererData_->gfxGrid);
 
+    int chunks = int(rendererData_->chunks.size());
     for (int style = GraphicElement::STYLE_FRAME; style < GraphicElement::STYLE_HIGHLIGHTED0; style++) {
-        lineShader_.update_vbos((enum GraphicElement::style_t)(style), rendererData_->gfxByStyle[style]);
+        lineShader_.set_chunk_count(style, chunks);
+        for (int c = 0; c < chunks; c++)
+            lineShader_.update_vbos(style, rendererData_->chunks.at(c).gfxByStyle[style], c);
+    }
+    for (int level = 0; level < lodLevels_; level++) {
+        int slot = GraphicElement::STYLE_MAX + level;
+        lineShader_.set_chunk_count(slot, chunks);
+        for (int c = 0; c < chunks; c++)
+            lineShader_.update_vbos(slot, rendererData_->chunks.at(c).gfxDensity[level], c);
     }
 
     for (int i = 0; i < 8; i++) {
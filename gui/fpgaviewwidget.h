@@ -135,6 +135,16 @@ class FPGAViewWidget : public QOpenGLWidget, protected QOpenGLFunctions
     const float zoomLvl1_ = 1.0f;
     const float zoomLvl2_ = 5.0f;
 
+    // Arch graphics are split by location into square chunks of this many
+    // tiles across, each with its own vertex buffers, so that a change to a
+    // few bels, wires or pips only re-renders and re-uploads their chunks.
+    static constexpr int chunkTiles_ = 16;
+    // When tiles are drawn smaller than this many pixels across, individual
+    // wires and pips can't be made out anyway. Instead of them each tile is
+    // drawn filled in, shaded by how many of its graphics are active.
+    static constexpr float lodTilePixels_ = 8.0f;
+    static constexpr int lodLevels_ = 4;
+
     struct PickedElement
     {
         ElementType type;
@@ -274,10 +284,17 @@ class FPGAViewWidget : public QOpenGLWidget, protected QOpenGLFunctions
     std::unique_ptr<RendererArgs> rendererArgs_;
     QMutex rendererArgsLock_;
 
+    struct ChunkData
+    {
+        LineShaderData gfxByStyle[GraphicElement::STYLE_HIGHLIGHTED0];
+        // Filled in tiles, by how many active graphics they have.
+        LineShaderData gfxDensity[lodLevels_];
+    };
+
     struct RendererData
     {
         LineShaderData gfxGrid;
-        LineShaderData gfxByStyle[GraphicElement::STYLE_MAX];
+        std::vector<ChunkData> chunks;
         LineShaderData gfxSelected;
         LineShaderData gfxHovered;
         LineShaderData gfxHighlighted[8];
@@ -291,6 +308,36 @@ class FPGAViewWidget : public QOpenGLWidget, protected QOpenGLFunctions
     std::unique_ptr<RendererData> rendererData_;
     QMutex rendererDataLock_;
 
+    // Every arch element the renderer has drawn, with the decal it was drawn
+    // with, so that only the elements the Context reports as changed need to
+    // be looked at again. Only used by the renderer thread.
+    struct DecalCache
+    {
+        bool valid = false;
+        // Which kinds of element are included.
+        bool bels = false, wires = false, pips = false, groups = false;
+
+        std::vector<PickedElement> elements;
+        std::vector<DecalXY> decals;
+        std::vector<int> elementChunk;
+        dict<BelId, int> belIndex;
+        dict<WireId, int> wireIndex;
+        dict<PipId, int> pipIndex;
+        dict<GroupId, int> groupIndex;
+
+        int chunksX = 1, chunksY = 1;
+        std::vector<std::vector<int>> chunkElements;
+
+        // Elements added to the picking quadtree since it was built. Changed
+        // elements are added again rather than moved, so it is rebuilt from
+        // scratch once this gets too large.
+        int quadTreeAdded = 0;
+    };
+    DecalCache decalCache_;
+    // Stamped onto each LineShaderData as it is rendered, so the LineShader
+    // knows to upload it.
+    int renderCounter_ = 0;
+
     void clampZoom();
     void zoomToBB(const PickQuadTree::BoundingBox &bb, float margin, bool clamp);
     void zoom(int level);
@@ -298,9 +345,9 @@ class FPGAViewWidget : public QOpenGLWidget, protected QOpenGLFunctions
     void renderGraphicElement(LineShaderData &out, PickQuadTree::BoundingBox &bb, const GraphicElement &el, float x,
                               float y);
     void renderDecal(LineShaderData &out, PickQuadTree::BoundingBox &bb, const DecalXY &decal);
-    void renderArchDecal(LineShaderData out[GraphicElement::STYLE_MAX], PickQuadTree::BoundingBox &bb,
-                         const DecalXY &decal);
-    void populateQuadTree(RendererData *data, const DecalXY &decal, const PickedElement &element);
+    bool populateQuadTree(RendererData *data, const DecalXY &decal, const PickedElement &element);
+    int chunkAt(const DecalXY &decal) const;
+    void renderChunk(int chunk, ChunkData &out, PickQuadTree::BoundingBox &bb);
     boost::optional<PickedElement> pickElement(float worldx, float worldy);
     QVector4D mouseToWorldCoordinates(int x, int y);
     QVector4D mouseToWorldDimensions(float x, float y);
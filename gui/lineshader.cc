@@ -171,97 +171,121 @@ bool LineShader::compile(void)
     uniforms_.color = program_->uniformLocation("color");
     program_->release();
 
-    for (int style = 0; style < GraphicElement::STYLE_MAX; style++) {
-        buffers_[style].position = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-        buffers_[style].normal = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-        buffers_[style].miter = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-        buffers_[style].index = QOpenGLBuffer(QOpenGLBuffer::IndexBuffer);
-
-        if (!buffers_[style].vao.create())
-            log_abort();
-        buffers_[style].vao.bind();
-
-        if (!buffers_[style].position.create())
-            log_abort();
-        if (!buffers_[style].normal.create())
-            log_abort();
-        if (!buffers_[style].miter.create())
-            log_abort();
-        if (!buffers_[style].index.create())
-            log_abort();
-
-        buffers_[style].position.setUsagePattern(QOpenGLBuffer::StaticDraw);
-        buffers_[style].normal.setUsagePattern(QOpenGLBuffer::StaticDraw);
-        buffers_[style].miter.setUsagePattern(QOpenGLBuffer::StaticDraw);
-        buffers_[style].index.setUsagePattern(QOpenGLBuffer::StaticDraw);
-
-        buffers_[style].position.bind();
-        buffers_[style].normal.bind();
-        buffers_[style].miter.bind();
-        buffers_[style].index.bind();
-
-        buffers_[style].vao.release();
-    }
-
     return true;
 }
 
-void LineShader::update_vbos(enum GraphicElement::style_t style, const LineShaderData &line)
+LineShader::Buffers &LineShader::buffers(int slot, int chunk)
+{
+    if (slot >= int(buffers_.size()))
+        buffers_.resize(slot + 1);
+    auto &chunks = buffers_[slot];
+    if (chunk >= int(chunks.size()))
+        chunks.resize(chunk + 1);
+    if (chunks[chunk] != nullptr)
+        return *chunks[chunk];
+
+    chunks[chunk] = std::unique_ptr<Buffers>(new Buffers);
+    Buffers &buf = *chunks[chunk];
+    buf.position = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+    buf.normal = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+    buf.miter = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+    buf.index = QOpenGLBuffer(QOpenGLBuffer::IndexBuffer);
+
+    if (!buf.vao.create())
+        log_abort();
+    buf.vao.bind();
+
+    if (!buf.position.create())
+        log_abort();
+    if (!buf.normal.create())
+        log_abort();
+    if (!buf.miter.create())
+        log_abort();
+    if (!buf.index.create())
+        log_abort();
+
+    buf.position.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    buf.normal.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    buf.miter.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    buf.index.setUsagePattern(QOpenGLBuffer::StaticDraw);
+
+    buf.position.bind();
+    buf.normal.bind();
+    buf.miter.bind();
+    buf.index.bind();
+
+    buf.vao.release();
+    return buf;
+}
+
+void LineShader::set_chunk_count(int slot, int count)
 {
-    if (buffers_[style].last_vbo_update == line.last_render)
+    if (slot < int(buffers_.size()) && int(buffers_[slot].size()) > count)
+        buffers_[slot].resize(count);
+}
+
+void LineShader::update_vbos(int slot, const LineShaderData &line, int chunk)
+{
+    Buffers &buf = buffers(slot, chunk);
+    if (buf.last_vbo_update == line.last_render)
         return;
-    buffers_[style].last_vbo_update = line.last_render;
+    buf.last_vbo_update = line.last_render;
 
-    buffers_[style].indices = line.indices.size();
-    if (buffers_[style].indices == 0)
+    buf.indices = line.indices.size();
+    if (buf.indices == 0)
         return;
 
-    buffers_[style].position.bind();
-    buffers_[style].position.allocate(&line.vertices[0], sizeof(Vertex2DPOD) * line.vertices.size());
+    buf.position.bind();
+    buf.position.allocate(&line.vertices[0], sizeof(Vertex2DPOD) * line.vertices.size());
 
-    buffers_[style].normal.bind();
-    buffers_[style].normal.allocate(&line.normals[0], sizeof(Vertex2DPOD) * line.normals.size());
+    buf.normal.bind();
+    buf.normal.allocate(&line.normals[0], sizeof(Vertex2DPOD) * line.normals.size());
 
-    buffers_[style].miter.bind();
-    buffers_[style].miter.allocate(&line.miters[0], sizeof(GLfloat) * line.miters.size());
+    buf.miter.bind();
+    buf.miter.allocate(&line.miters[0], sizeof(GLfloat) * line.miters.size());
 
-    buffers_[style].index.bind();
-    buffers_[style].index.allocate(&line.indices[0], sizeof(GLuint) * line.indices.size());
+    buf.index.bind();
+    buf.index.allocate(&line.indices[0], sizeof(GLuint) * line.indices.size());
 }
 
-void LineShader::draw(enum GraphicElement::style_t style, const QColor &color, float thickness,
-                      const QMatrix4x4 &projection)
+void LineShader::draw(int slot, const QColor &color, float thickness, const QMatrix4x4 &projection)
 {
     auto gl = QOpenGLContext::currentContext()->functions();
-    if (buffers_[style].indices == 0)
+    if (slot >= int(buffers_.size()))
         return;
     program_->bind();
-    buffers_[style].vao.bind();
 
     program_->setUniformValue(uniforms_.projection, projection);
     program_->setUniformValue(uniforms_.thickness, thickness);
     program_->setUniformValue(uniforms_.color, color.redF(), color.greenF(), color.blueF(), color.alphaF());
 
-    buffers_[style].position.bind();
-    program_->enableAttributeArray(attributes_.position);
-    program_->setAttributeBuffer(attributes_.position, GL_FLOAT, 0, 2);
+    for (auto &chunk : buffers_[slot]) {
+        if (chunk == nullptr || chunk->indices == 0)
+            continue;
+        Buffers &buf = *chunk;
+        buf.vao.bind();
 
-    buffers_[style].normal.bind();
-    program_->enableAttributeArray(attributes_.normal);
-    program_->setAttributeBuffer(attributes_.normal, GL_FLOAT, 0, 2);
+        buf.position.bind();
+        program_->enableAttributeArray(attributes_.position);
+        program_->setAttributeBuffer(attributes_.position, GL_FLOAT, 0, 2);
 
-    buffers_[style].miter.bind();
-    program_->enableAttributeArray(attributes_.miter);
-    program_->setAttributeBuffer(attributes_.miter, GL_FLOAT, 0, 1);
+        buf.normal.bind();
+        program_->enableAttributeArray(attributes_.normal);
+        program_->setAttributeBuffer(attributes_.normal, GL_FLOAT, 0, 2);
 
-    buffers_[style].index.bind();
-    gl->glDrawElements(GL_TRIANGLES, buffers_[style].indices, GL_UNSIGNED_INT, (void *)0);
+        buf.miter.bind();
+        program_->enableAttributeArray(attributes_.miter);
+        program_->setAttributeBuffer(attributes_.miter, GL_FLOAT, 0, 1);
 
-    program_->disableAttributeArray(attributes_.position);
-    program_->disableAttributeArray(attributes_.normal);
-    program_->disableAttributeArray(attributes_.miter);
+        buf.index.bind();
+        gl->glDrawElements(GL_TRIANGLES, buf.indices, GL_UNSIGNED_INT, (void *)0);
 
-    buffers_[style].vao.release();
+        program_->disableAttributeArray(attributes_.position);
+        program_->disableAttributeArray(attributes_.normal);
+        program_->disableAttributeArray(attributes_.miter);
+
+        buf.vao.release();
+    }
     program_->release();
 }
 
@@ -25,7 +25,8 @@
 #include <QOpenGLShaderProgram>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWidget>
-#include <array>
+#include <memory>
+#include <vector>
 
 #include "log.h"
 #include "nextpnr.h"
@@ -95,6 +96,10 @@ class PolyLine
 
 // LineShader is an OpenGL shader program that renders LineShaderData on the
 // GPU.
+// Lines are uploaded into numbered slots - one for each GraphicElement style,
+// followed by any extra slots the user needs - and each slot can be split
+// into chunks with their own buffers, so that changing a small part of a
+// large drawing only has to upload that part again.
 // The LineShader expects two vertices per line point. It will push those
 // vertices along the given normal * miter. This is used to 'stretch' the line
 // to be as wide as the given thickness. The normal and miter are calculated
@@ -155,7 +160,10 @@ class LineShader
 
         int last_vbo_update = 0;
     };
-    std::array<Buffers, GraphicElement::STYLE_MAX> buffers_;
+    // Indexed by slot, then by chunk. Created on first use.
+    std::vector<std::vector<std::unique_ptr<Buffers>>> buffers_;
+
+    Buffers &buffers(int slot, int chunk);
 
     // GL uniform locations.
     struct
@@ -194,10 +202,16 @@ class LineShader
     // Must be called on initialization.
     bool compile(void);
 
-    void update_vbos(enum GraphicElement::style_t style, const LineShaderData &line);
+    // Upload a chunk of a slot's lines, if they were rendered again since the last upload.
+    // Must be called from a thread holding the OpenGL context.
+    void update_vbos(int slot, const LineShaderData &line, int chunk = 0);
+
+    // Free the buffers of a slot's chunks from count onwards.
+    // Must be called from a thread holding the OpenGL context.
+    void set_chunk_count(int slot, int count);
 
-    // Render a LineShaderData with a given M/V/P transformation.
-    void draw(enum GraphicElement::style_t style, const QColor &color, float thickness, const QMatrix4x4 &projection);
+    // Render all chunks of a slot with a given M/V/P transformation.
+    void draw(int slot, const QColor &color, float thickness, const QMatrix4x4 &projection);
 };
 
 NEXTPNR_NAMESPACE_END
@@ -72,6 +72,7 @@ void Arch::load_chipdb(const std::string &path)
         blob_file.open(db_path);
         if (db_path.empty() || !blob_file.is_open())
             log_error("Unable to read chipdb %s\n", db_path.c_str());
+        chipdb_path = db_path;
         const char *blob = reinterpret_cast<const char *>(blob_file.data());
         chip_info = get_chip_info(reinterpret_cast<const RelPtr<ChipInfoPOD> *>(blob));
     } catch (...) {
@@ -129,6 +130,9 @@ void Arch::set_package(const std::string &package)
 
 void Arch::init_tiles()
 {
+    tile_type_names.resize(chip_info->tile_types.size());
+    tile_type_names_once.reset(new std::once_flag[chip_info->tile_types.size()]);
+    dict<std::pair<int32_t, int32_t>, int32_t> type_shape2remap;
     for (int y = 0; y < chip_info->height; y++) {
         for (int x = 0; x < chip_info->width; x++) {
             int tile = y * chip_info->width + x;
@@ -137,13 +141,66 @@ void Arch::init_tiles()
             NPNR_ASSERT(int(tile_name.size()) == tile);
             tile_name.push_back(name);
             tile_name2idx[name] = tile;
+            auto remap_key = std::make_pair(inst.type, inst.shape);
+            auto fnd_remap = type_shape2remap.find(remap_key);
+            if (fnd_remap == type_shape2remap.end()) {
+                std::vector<int32_t> remap;
+                int32_t count = 0;
+                for (int32_t i = 0; i < chip_tile_info(chip_info, tile).wires.ssize(); i++)
+                    remap.push_back((normalise_wire(tile, i) == WireId(tile, i)) ? count++ : -1);
+                fnd_remap = type_shape2remap.emplace(remap_key, int32_t(wire_remaps.size())).first;
+                wire_remaps.push_back(std::move(remap));
+            }
+            tile_wire_remap.push_back(fnd_remap->second);
+            wire_tile_vecidx.push_back(wire_vecidx_count);
+            bel_tile_vecidx.push_back(bel_vecidx_count);
+            bel_vecidx_count += chip_tile_info(chip_info, tile).bels.ssize();
+            for (int32_t idx : wire_remaps.at(fnd_remap->second))
+                if (idx != -1)
+                    ++wire_vecidx_count;
         }
     }
 }
 
+const Arch::TileTypeNameIndex &Arch::get_tile_type_names(int tile) const
+{
+    int type = chip_info->tile_insts[tile].type;
+    std::call_once(tile_type_names_once[type], [&]() {
+        const auto &tdata = chip_info->tile_types[type];
+        auto &index = tile_type_names.at(type);
+        // emplace keeps the first of any duplicate names, matching the linear search this replaces
+        index.bels.reserve(tdata.bels.size());
+        for (int bel = 0; bel < tdata.bels.ssize(); bel++)
+            index.bels.emplace(IdString(tdata.bels[bel].name), bel);
+        index.wires.reserve(tdata.wires.size());
+        for (int wire = 0; wire < tdata.wires.ssize(); wire++)
+            index.wires.emplace(IdString(tdata.wires[wire].name), wire);
+        for (int group = 0; group < tdata.groups.ssize(); group++)
+            index.groups.emplace(IdString(tdata.groups[group].name), group);
+        index.pips.reserve(tdata.pips.size());
+        for (int pip = 0; pip < tdata.pips.ssize(); pip++) {
+            const auto &pdata = tdata.pips[pip];
+            index.pips[std::make_pair(IdString(tdata.wires[pdata.dst_wire].name),
+                                      IdString(tdata.wires[pdata.src_wire].name))]
+                    .push_back(pip);
+        }
+    });
+    return tile_type_names.at(type);
+}
+
 void Arch::late_init()
 {
-    BaseArch::init_cell_types();
+    // The set of bel types is read from the tile types that are actually used, rather than visiting every bel
+    pool<int32_t> used_tile_types;
+    for (const auto &tile_inst : chip_info->tile_insts)
+        used_tile_types.insert(tile_inst.type);
+    pool<IdString> bel_types;
+    for (int32_t type : used_tile_types)
+        for (const auto &bel : chip_info->tile_types[type].bels)
+            bel_types.insert(IdString(bel.bel_type));
+    cell_types.assign(bel_types.begin(), bel_types.end());
+    std::sort(cell_types.begin(), cell_types.end());
+    cell_types_initialised = true;
     BaseArch::init_bel_buckets();
 }
 
@@ -151,12 +208,11 @@ BelId Arch::getBelByName(IdStringList name) const
 {
     NPNR_ASSERT(name.size() == 2);
     int tile = tile_name2idx.at(name[0]);
-    const auto &tdata = chip_tile_info(chip_info, tile);
-    for (int bel = 0; bel < tdata.bels.ssize(); bel++) {
-        if (IdString(tdata.bels[bel].name) == name[1])
-            return BelId(tile, bel);
-    }
-    return BelId();
+    const auto &names = get_tile_type_names(tile).bels;
+    auto fnd = names.find(name[1]);
+    if (fnd == names.end())
+        return BelId();
+    return BelId(tile, fnd->second);
 }
 
 IdStringList Arch::getBelName(BelId bel) const
@@ -209,6 +265,8 @@ bool Arch::place()
 {
     bool retVal = false;
     uarch->prePlace();
+    // Built here, rather than by the first estimateDelay call, so that no placer or router thread stalls on it
+    uarch->initLookahead();
     std::string placer = str_or_default(settings, id("placer"), defaultPlacer);
     if (placer == "heap") {
         PlacerHeapCfg cfg(getCtx());
@@ -229,6 +287,7 @@ bool Arch::place()
 bool Arch::route()
 {
     set_fast_pip_delays(true);
+    uarch->initLookahead();
     uarch->preRoute();
     std::string router = str_or_default(settings, id("router"), defaultRouter);
     bool result;
@@ -270,12 +329,11 @@ WireId Arch::getWireByName(IdStringList name) const
 {
     NPNR_ASSERT(name.size() == 2);
     int tile = tile_name2idx.at(name[0]);
-    const auto &tdata = chip_tile_info(chip_info, tile);
-    for (int wire = 0; wire < tdata.wires.ssize(); wire++) {
-        if (IdString(tdata.wires[wire].name) == name[1])
-            return normalise_wire(tile, wire);
-    }
-    return WireId();
+    const auto &names = get_tile_type_names(tile).wires;
+    auto fnd = names.find(name[1]);
+    if (fnd == names.end())
+        return WireId();
+    return normalise_wire(tile, fnd->second);
 }
 
 IdStringList Arch::getWireName(WireId wire) const
@@ -287,15 +345,14 @@ PipId Arch::getPipByName(IdStringList name) const
 {
     NPNR_ASSERT(name.size() == 3 || (name.size() == 4 && name[3] == id("INV")));
     const int tile = tile_name2idx.at(name[0]);
-    const auto &tdata = chip_tile_info(chip_info, tile);
-    for (int pip = 0; pip < tdata.pips.ssize(); pip++) {
-        if (IdString(tdata.wires[tdata.pips[pip].dst_wire].name) == name[1] &&
-            IdString(tdata.wires[tdata.pips[pip].src_wire].name) == name[2]) {
-
-            const auto tmp_pip = PipId(tile, pip);
-            if ((name.size() == 3 && !isPipInverting(tmp_pip)) || (name.size() == 4 && isPipInverting(tmp_pip))) {
-                return tmp_pip;
-            }
+    const auto &names = get_tile_type_names(tile).pips;
+    auto fnd = names.find(std::make_pair(name[1], name[2]));
+    if (fnd == names.end())
+        return PipId();
+    for (int32_t pip : fnd->second) {
+        const auto tmp_pip = PipId(tile, pip);
+        if ((name.size() == 3 && !isPipInverting(tmp_pip)) || (name.size() == 4 && isPipInverting(tmp_pip))) {
+            return tmp_pip;
         }
     }
     return PipId();
@@ -319,12 +376,11 @@ GroupId Arch::getGroupByName(IdStringList name) const
 {
     NPNR_ASSERT(name.size() == 2);
     int tile = tile_name2idx.at(name[0]);
-    const auto &tdata = chip_tile_info(chip_info, tile);
-    for (int group = 0; group < tdata.groups.ssize(); group++) {
-        if (IdString(tdata.groups[group].name) == name[1])
-            return GroupId(tile, group);
-    }
-    return GroupId();
+    const auto &names = get_tile_type_names(tile).groups;
+    auto fnd = names.find(name[1]);
+    if (fnd == names.end())
+        return GroupId();
+    return GroupId(tile, fnd->second);
 }
 
 IdStringList Arch::getGroupName(GroupId group) const
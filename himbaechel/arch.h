@@ -23,10 +23,12 @@
 
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <iostream>
+#include <mutex>
 
 #include "base_arch.h"
 #include "chipdb.h"
 #include "himbaechel_api.h"
+#include "lookahead.h"
 #include "nextpnr_namespaces.h"
 #include "nextpnr_types.h"
 
@@ -479,6 +481,7 @@ struct Arch : BaseArch<ArchRanges>
 
     // Database references
     boost::iostreams::mapped_file_source blob_file;
+    std::string chipdb_path;
     const ChipInfoPOD *chip_info;
     const PackageInfoPOD *package_info = nullptr;
     const SpeedGradePOD *speed_grade = nullptr;
@@ -544,6 +547,15 @@ struct Arch : BaseArch<ArchRanges>
         return IdString(chip_wire_info(chip_info, wire).const_value);
     }
     WireRange getWires() const override { return WireRange(chip_info); }
+    int getWireIndexCount() const override { return wire_vecidx_count; }
+    // Indices are per node, so are only defined for the canonical wire of each node, as returned by the arch API.
+    // Tile wires that belong to a node rooted in another tile must go through normalise_wire first.
+    int getWireIndex(WireId wire) const override
+    {
+        int32_t idx = wire_remaps[tile_wire_remap[wire.tile]][wire.index];
+        NPNR_ASSERT(idx != -1);
+        return wire_tile_vecidx[wire.tile] + idx;
+    }
     bool checkWireAvail(WireId wire) const override
     {
         if (!uarch->checkWireAvail(wire))
@@ -695,6 +707,8 @@ struct Arch : BaseArch<ArchRanges>
     {
         return cell_info->cell_bel_pins.at(pin);
     }
+    int getBelIndexCount() const override { return bel_vecidx_count; }
+    int getBelIndex(BelId bel) const override { return bel_tile_vecidx[bel.tile] + bel.index; }
     void update_cell_bel_pins(CellInfo *cell);
 
     // ------------------------------------------------
@@ -702,13 +716,13 @@ struct Arch : BaseArch<ArchRanges>
     void bindBel(BelId bel, CellInfo *cell, PlaceStrength strength) override
     {
         uarch->notifyBelChange(bel, cell);
-        BaseArch::bindBel(bel, cell, strength); // TODO: faster?
+        BaseArch::bindBel(bel, cell, strength);
     }
 
     void unbindBel(BelId bel) override
     {
         uarch->notifyBelChange(bel, nullptr);
-        BaseArch::unbindBel(bel); // TODO: faster?
+        BaseArch::unbindBel(bel);
         // TODO: fast tile status and bind
     }
 
@@ -889,6 +903,30 @@ struct Arch : BaseArch<ArchRanges>
     void set_fast_pip_delays(bool fast_mode);
     std::vector<IdString> tile_name;
     dict<IdString, int> tile_name2idx;
+    // Dense wire index: the offset of each tile's first wire, plus the position of each tile type wire among the
+    // wires that are canonical in that tile (-1 for wires of a node rooted elsewhere). The latter is shared between
+    // all tiles with the same type and routing shape.
+    std::vector<int32_t> wire_tile_vecidx;
+    std::vector<int32_t> tile_wire_remap;
+    std::vector<std::vector<int32_t>> wire_remaps;
+    int32_t wire_vecidx_count = 0;
+    // Dense bel index: the offset of each tile's first bel
+    std::vector<int32_t> bel_tile_vecidx;
+    int32_t bel_vecidx_count = 0;
+
+    // Routing lookahead backing the default HimbaechelAPI::estimateDelay, built by HimbaechelAPI::initLookahead
+    HimbaechelLookahead lookahead;
+
+    // Per tile type name lookup tables for the get*ByName functions, built the first time a tile of that type is
+    // queried. Pips are keyed by their (dst, src) wire names, which an inverting and non-inverting pip may share.
+    struct TileTypeNameIndex
+    {
+        dict<IdString, int32_t> bels, wires, groups;
+        dict<std::pair<IdString, IdString>, std::vector<int32_t>> pips;
+    };
+    mutable std::vector<TileTypeNameIndex> tile_type_names;
+    mutable std::unique_ptr<std::once_flag[]> tile_type_names_once;
+    const TileTypeNameIndex &get_tile_type_names(int tile) const;
 
     // -------------------------------------------------
     IdString get_tile_type(int tile) const;
@@ -41,13 +41,13 @@ bool HimbaechelAPI::isValidBelForCellType(IdString cell_type, BelId bel) const
     return ctx->getBelType(bel) == cell_type;
 }
 
+void HimbaechelAPI::initLookahead() { ctx->lookahead.ensure_init(ctx); }
+
 delay_t HimbaechelAPI::estimateDelay(WireId src, WireId dst) const
 {
-    // TODO: configurable lookahead
-    int sx, sy, dx, dy;
-    tile_xy(ctx->chip_info, src.tile, sx, sy);
-    tile_xy(ctx->chip_info, dst.tile, dx, dy);
-    return 100 * (std::abs(dx - sx) + std::abs(dy - sy) + 2);
+    // Normally already done by initLookahead; this only covers estimates made outside of place and route
+    ctx->lookahead.ensure_init(ctx);
+    return ctx->lookahead.estimate(ctx, src, dst);
 }
 
 delay_t HimbaechelAPI::predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const
@@ -92,6 +92,10 @@ struct HimbaechelAPI
     virtual bool isPipInverting(PipId pip) const { return false; }
 
     // --- Route lookahead ---
+    // The default estimateDelay uses a table precomputed from the routing graph (see lookahead.h), which
+    // initLookahead sets up before placement and before routing. Uarches with their own estimateDelay should
+    // override initLookahead to do nothing.
+    virtual void initLookahead();
     virtual delay_t estimateDelay(WireId src, WireId dst) const;
     virtual delay_t predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const;
     virtual BoundingBox getRouteBoundingBox(WireId src, WireId dst) const;
@@ -27,3 +27,92 @@ class BBAWriter:
 		print(f"u32 {n} {comment}", file=self.f)
 	def pop(self):
 		print("pop", file=self.f)
+
+class _BinaryStream:
+	def __init__(self, name):
+		self.name = name
+		self.data = bytearray()
+		self.label_defs = [] # (offset, label)
+		self.refs = [] # (offset, label)
+		# what the stream's start must be modulo 4 (or 2) for its u32 (or u16) values to be aligned
+		self.phase4 = None
+		self.phase2 = None
+
+	def align(self, attr, n):
+		phase = -len(self.data) % n
+		assert getattr(self, attr) in (None, phase), f"misaligned u{8*n} in stream {self.name}"
+		setattr(self, attr, phase)
+
+class BinaryWriter:
+	# Drop-in replacement for BBAWriter that assembles the database itself, producing exactly what bbasm would from
+	# the equivalent .bba. Values are packed into bytes as they are written, so neither the text nor a list of tokens
+	# is ever held in memory. Call finish() once everything has been written.
+	def __init__(self, f, big_endian=False):
+		self.f = f
+		self.byteorder = "big" if big_endian else "little"
+		self.streams = []
+		self.stream_index = {}
+		self.stack = []
+		self.strings = _BinaryStream("strings")
+	def pre(self, s):
+		pass # only used when bbasm writes C source
+	def post(self, s):
+		pass
+	def push(self, s):
+		if s not in self.stream_index:
+			self.stream_index[s] = len(self.streams)
+			self.streams.append(_BinaryStream(s))
+		self.stack.append(self.streams[self.stream_index[s]])
+	def ref(self, r, comment=""):
+		s = self.stack[-1]
+		s.refs.append((len(s.data), r))
+		s.data += bytes(4)
+	def slice(self, r, size, comment=""):
+		self.ref(r)
+		self.u32(size)
+	def str(self, s, comment=""):
+		label = f"str:{s}"
+		self.ref(label)
+		self.strings.label_defs.append((len(self.strings.data), label))
+		self.strings.data += s.encode() + b"\0"
+	def label(self, s):
+		st = self.stack[-1]
+		st.label_defs.append((len(st.data), s))
+	def u8(self, n, comment=""):
+		assert isinstance(n, int), n
+		self.stack[-1].data.append(n & 0xFF)
+	def u16(self, n, comment=""):
+		assert isinstance(n, int), n
+		s = self.stack[-1]
+		s.align("phase2", 2)
+		s.data += (n & 0xFFFF).to_bytes(2, self.byteorder)
+	def u32(self, n, comment=""):
+		assert isinstance(n, int), n
+		s = self.stack[-1]
+		s.align("phase4", 4)
+		s.data += (n & 0xFFFFFFFF).to_bytes(4, self.byteorder)
+	def pop(self):
+		self.stack.pop()
+	def finish(self):
+		assert not self.stack
+		streams = self.streams + [self.strings]
+		# lay the streams out one after another; a label defined more than once ends up at its last definition
+		labels = {}
+		starts = []
+		cursor = 0
+		for s in streams:
+			assert s.phase4 in (None, cursor % 4), f"misaligned stream {s.name}"
+			assert s.phase2 in (None, cursor % 2), f"misaligned stream {s.name}"
+			starts.append(cursor)
+			for offset, label in s.label_defs:
+				labels[label] = cursor + offset
+			cursor += len(s.data)
+		# references are relative to their own position
+		for s, start in zip(streams, starts):
+			for offset, label in s.refs:
+				assert label in labels, f"undefined label {label}"
+				rel = (labels[label] - (start + offset)) & 0xFFFFFFFF
+				s.data[offset:offset+4] = rel.to_bytes(4, self.byteorder)
+			self.f.write(s.data)
+			s.data = None
+		return cursor
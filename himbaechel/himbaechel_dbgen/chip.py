@@ -1,9 +1,10 @@
 from dataclasses import dataclass, field
-from .bba import BBAWriter
+from .bba import BBAWriter, BinaryWriter
 from enum import Enum
 from typing import Optional
 import abc
 import struct, hashlib
+import sys, time
 
 """
 This provides a semi-flattened routing graph that is built into a deduplicated one.
@@ -789,6 +790,9 @@ class Chip:
         self.extra_data = None
         self.timing = TimingPool(self.strs)
         self.gfx_wire_ids = dict()
+        self.start_time = time.monotonic()
+        # print build time and peak memory once the database is written
+        self.verbose = False
     def create_tile_type(self, name: str):
         tt = TileType(self.strs, self.gfx_wire_ids, self.timing, self.strs.id(name))
         self.tile_type_idx[name] = len(self.tile_types)
@@ -944,17 +948,52 @@ class Chip:
         else:
             bba.u32(0)
 
+    def write_db(self, bba):
+        bba.pre('#include \"nextpnr.h\"')
+        bba.pre('NEXTPNR_NAMESPACE_BEGIN')
+        bba.post('NEXTPNR_NAMESPACE_END')
+        bba.push('chipdb_blob')
+        bba.ref('chip_info')
+        self.serialise(bba)
+        bba.pop()
+
+    def report_stats(self, what):
+        # time since the Chip was created, and the peak memory of the generator
+        if not self.verbose:
+            return
+        msg = f"{self.uarch} {self.name}: wrote {what} in {time.monotonic() - self.start_time:.2f}s"
+        try:
+            import resource
+            peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+            peak_mb = peak / (1024 * 1024) if sys.platform == "darwin" else peak / 1024
+            msg += f", peak memory {peak_mb:.1f} MB"
+        except ImportError:
+            pass
+        print(msg, file=sys.stderr)
+
     def write_bba(self, filename):
         self.timing.finalise()
         with open(filename, "w") as f:
-            bba = BBAWriter(f)
-            bba.pre('#include \"nextpnr.h\"')
-            bba.pre('NEXTPNR_NAMESPACE_BEGIN')
-            bba.post('NEXTPNR_NAMESPACE_END')
-            bba.push('chipdb_blob')
-            bba.ref('chip_info')
-            self.serialise(bba)
-            bba.pop()
+            self.write_db(BBAWriter(f))
+        self.report_stats(filename)
+
+    def write_bin(self, filename, big_endian=False):
+        # writes the assembled database directly, identical to running bbasm on the output of write_bba
+        self.timing.finalise()
+        with open(filename, "wb") as f:
+            bba = BinaryWriter(f, big_endian)
+            self.write_db(bba)
+            size = bba.finish()
+        self.report_stats(f"{filename} ({size / (1024 * 1024):.2f} MB)")
+
+    def write(self, filename):
+        # picks the output format from the file name, so the build system decides whether bbasm is needed;
+        # an extra .new suffix (used by the build for atomic updates) is ignored
+        name = filename[:-4] if filename.endswith(".new") else filename
+        if name.endswith(".bin"):
+            self.write_bin(filename)
+        else:
+            self.write_bba(filename)
 
     def read_gfxids(self, filename):
         idx = 1
@@ -0,0 +1,347 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2024  The nextpnr Authors.
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "lookahead.h"
+
+#include <algorithm>
+#include <cctype>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <random>
+
+#include "log.h"
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+NPNR_PACKED_STRUCT(struct LookaheadCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t db_size;
+    int64_t db_mtime;
+    int32_t radius;
+    int32_t samples;
+    int32_t class_count;
+    int32_t per_tile_delay[2];
+    int32_t quantum;
+    // Delays depend on the speed grade as well as the chipdb; empty if none was selected
+    char speed_grade[64];
+});
+
+static constexpr uint32_t cache_magic = 0x4b4c4e48; // "HNLK"
+static constexpr uint32_t cache_version = 5;
+
+// Like Context::setting, but without storing the default; this may be called from a router thread
+template <typename T> T setting_or_default(const Context *ctx, const char *name, T default_value)
+{
+    auto fnd = ctx->settings.find(ctx->id(name));
+    if (fnd == ctx->settings.end())
+        return default_value;
+    return boost::lexical_cast<T>(fnd->second.is_string ? fnd->second.as_string()
+                                                        : std::to_string(fnd->second.as_int64()));
+}
+
+struct QueuedWire
+{
+    delay_t delay;
+    WireId wire;
+    bool operator>(const QueuedWire &other) const { return delay > other.delay; }
+};
+} // namespace
+
+void HimbaechelLookahead::setup_classes(const Context *ctx)
+{
+    const ChipInfoPOD *chip = ctx->chip_info;
+    dict<std::pair<int32_t, int32_t>, int32_t> type2class;
+    wire_class.resize(chip->tile_types.size());
+    wire_is_sink.resize(chip->tile_types.size());
+    for (int i = 0; i < chip->tile_types.ssize(); i++) {
+        auto &tt = chip->tile_types[i];
+        wire_class.at(i).reserve(tt.wires.size());
+        wire_is_sink.at(i).reserve(tt.wires.size());
+        for (auto &wire : tt.wires) {
+            // Only the wire's own pins are considered; a node with pins elsewhere just gets the weaker estimate
+            wire_is_sink.at(i).push_back(wire.bel_pins.size() > 0);
+            auto key = std::make_pair(i, wire.wire_type);
+            auto fnd = type2class.find(key);
+            if (fnd == type2class.end())
+                fnd = type2class.emplace(key, int32_t(type2class.size())).first;
+            wire_class.at(i).push_back(fnd->second);
+        }
+    }
+    class_count = int32_t(type2class.size());
+}
+
+void HimbaechelLookahead::build(const Context *ctx, int samples)
+{
+    const ChipInfoPOD *chip = ctx->chip_info;
+    int dim = 2 * radius + 1;
+    // Exact delays while searching; quantised once the searches are done
+    std::vector<delay_t> exact(2 * size_t(class_count) * dim * dim, std::numeric_limits<delay_t>::max());
+
+    // Pick the sample wires of each class closest to the centre of the device, so the window is mostly on-chip
+    std::vector<int> tiles(chip->tile_insts.size());
+    for (int i = 0; i < int(tiles.size()); i++)
+        tiles.at(i) = i;
+    auto centre_dist = [&](int tile) {
+        int x, y;
+        tile_xy(chip, tile, x, y);
+        return std::abs(2 * x - chip->width) + std::abs(2 * y - chip->height);
+    };
+    std::stable_sort(tiles.begin(), tiles.end(), [&](int a, int b) { return centre_dist(a) < centre_dist(b); });
+    std::vector<std::vector<WireId>> class_samples(class_count);
+    for (int tile : tiles) {
+        int type = chip->tile_insts[tile].type;
+        for (int i = 0; i < int(wire_class.at(type).size()); i++) {
+            auto &cs = class_samples.at(wire_class.at(type).at(i));
+            if (int(cs.size()) >= samples)
+                continue;
+            WireId wire(tile, i);
+            if (ctx->normalise_wire(tile, i) != wire)
+                continue;
+            // Wires with no downhill pips (e.g. cell inputs) never start a route
+            auto downhill = ctx->getPipsDownhill(wire);
+            if (!(downhill.begin() != downhill.end()))
+                continue;
+            cs.push_back(wire);
+        }
+    }
+
+    std::vector<delay_t> dist(ctx->getWireIndexCount(), std::numeric_limits<delay_t>::max());
+    std::vector<int> visited;
+    std::priority_queue<QueuedWire, std::vector<QueuedWire>, std::greater<QueuedWire>> queue;
+    int searches = 0;
+    for (int cls = 0; cls < class_count; cls++) {
+        for (WireId src : class_samples.at(cls)) {
+            int sx, sy;
+            tile_xy(chip, src.tile, sx, sy);
+            dist.at(ctx->getWireIndex(src)) = 0;
+            visited.push_back(ctx->getWireIndex(src));
+            queue.push(QueuedWire{0, src});
+            while (!queue.empty()) {
+                auto curr = queue.top();
+                queue.pop();
+                if (curr.delay > dist.at(ctx->getWireIndex(curr.wire)))
+                    continue;
+                // Routes usually end at a bel pin, and recording those separately includes the cost of the last few
+                // hops inside the destination tile in their estimate
+                int x, y;
+                tile_xy(chip, curr.wire.tile, x, y);
+                auto bel_pins = ctx->getWireBelPins(curr.wire);
+                bool sink = bel_pins.begin() != bel_pins.end();
+                for (int t = 0; t <= int(sink); t++) {
+                    delay_t &entry = exact.at(table_index(t, cls, x - sx, y - sy));
+                    entry = std::min(entry, curr.delay);
+                }
+                for (PipId pip : ctx->getPipsDownhill(curr.wire)) {
+                    WireId dst = ctx->getPipDstWire(pip);
+                    int dx, dy;
+                    tile_xy(chip, dst.tile, dx, dy);
+                    if (std::abs(dx - sx) > radius || std::abs(dy - sy) > radius)
+                        continue;
+                    delay_t next = curr.delay + ctx->getPipDelay(pip).maxDelay() +
+                                   ctx->getWireDelay(dst).maxDelay() + ctx->getDelayEpsilon();
+                    int dst_idx = ctx->getWireIndex(dst);
+                    if (next >= dist.at(dst_idx))
+                        continue;
+                    if (dist.at(dst_idx) == std::numeric_limits<delay_t>::max())
+                        visited.push_back(dst_idx);
+                    dist.at(dst_idx) = next;
+                    queue.push(QueuedWire{next, dst});
+                }
+            }
+            for (int idx : visited)
+                dist.at(idx) = std::numeric_limits<delay_t>::max();
+            visited.clear();
+            ++searches;
+        }
+    }
+
+    // The cheapest delay per tile of manhattan distance, observed at the edge of the window, is used to extrapolate
+    // beyond it
+    for (int t = 0; t < 2; t++) {
+        delay_t tile_delay = std::numeric_limits<delay_t>::max();
+        for (int cls = 0; cls < class_count; cls++) {
+            for (int dy = -radius; dy <= radius; dy++) {
+                for (int dx = -radius; dx <= radius; dx++) {
+                    int manhattan = std::abs(dx) + std::abs(dy);
+                    delay_t value = exact.at(table_index(t, cls, dx, dy));
+                    if (manhattan < radius || value == std::numeric_limits<delay_t>::max())
+                        continue;
+                    tile_delay = std::min<delay_t>(tile_delay, value / manhattan);
+                }
+            }
+        }
+        if (tile_delay == std::numeric_limits<delay_t>::max())
+            tile_delay = ctx->getDelayEpsilon();
+        per_tile_delay[t] = std::max<int32_t>(int32_t(tile_delay), 1);
+    }
+
+    // Pick the smallest quantum that fits the largest delay below the unreachable marker, then round entries down
+    delay_t max_delay = 0;
+    for (delay_t value : exact)
+        if (value != std::numeric_limits<delay_t>::max())
+            max_delay = std::max(max_delay, value);
+    quantum = std::max<int32_t>(1, int32_t((int64_t(max_delay) + unreachable - 2) / (unreachable - 1)));
+    owned_table.resize(exact.size());
+    for (size_t i = 0; i < exact.size(); i++)
+        owned_table.at(i) = (exact.at(i) == std::numeric_limits<delay_t>::max()) ? unreachable
+                                                                                   : uint16_t(exact.at(i) / quantum);
+    table = owned_table.data();
+    if (ctx->verbose)
+        log_info("    %d Dijkstra searches over %d wire classes\n", searches, class_count);
+}
+
+bool HimbaechelLookahead::load_cache(const std::string &path, uint64_t db_size, int64_t db_mtime, int samples,
+                                     const std::string &speed)
+{
+    try {
+        cache_file.open(path);
+    } catch (...) {
+        return false;
+    }
+    if (!cache_file.is_open() || cache_file.size() < sizeof(LookaheadCacheHeader))
+        return false;
+    LookaheadCacheHeader hdr;
+    memcpy(&hdr, cache_file.data(), sizeof(hdr));
+    int dim = 2 * radius + 1;
+    if (hdr.magic != cache_magic || hdr.version != cache_version || hdr.db_size != db_size ||
+        hdr.db_mtime != db_mtime || hdr.radius != radius || hdr.samples != samples ||
+        hdr.class_count != class_count || strncmp(hdr.speed_grade, speed.c_str(), sizeof(hdr.speed_grade)) != 0 ||
+        hdr.quantum < 1 || cache_file.size() != sizeof(hdr) + 2 * size_t(class_count) * dim * dim * sizeof(uint16_t)) {
+        cache_file.close();
+        return false;
+    }
+    per_tile_delay[0] = hdr.per_tile_delay[0];
+    per_tile_delay[1] = hdr.per_tile_delay[1];
+    quantum = hdr.quantum;
+    table = reinterpret_cast<const uint16_t *>(cache_file.data() + sizeof(hdr));
+    return true;
+}
+
+void HimbaechelLookahead::save_cache(const std::string &path, uint64_t db_size, int64_t db_mtime, int samples,
+                                     const std::string &speed) const
+{
+    LookaheadCacheHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = cache_magic;
+    hdr.version = cache_version;
+    hdr.db_size = db_size;
+    hdr.db_mtime = db_mtime;
+    hdr.radius = radius;
+    hdr.samples = samples;
+    hdr.class_count = class_count;
+    hdr.per_tile_delay[0] = per_tile_delay[0];
+    hdr.per_tile_delay[1] = per_tile_delay[1];
+    hdr.quantum = quantum;
+    strncpy(hdr.speed_grade, speed.c_str(), sizeof(hdr.speed_grade));
+    // Write to a temporary file and rename, so concurrent runs never see a partial cache
+    std::string tmp_path = stringf("%s.%08x.tmp", path.c_str(), unsigned(std::random_device()()));
+    {
+        std::ofstream out(tmp_path, std::ios::binary);
+        if (!out) {
+            log_info("    unable to write lookahead cache %s\n", path.c_str());
+            return;
+        }
+        out.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+        out.write(reinterpret_cast<const char *>(owned_table.data()), owned_table.size() * sizeof(uint16_t));
+        if (!out) {
+            log_info("    unable to write lookahead cache %s\n", path.c_str());
+            std::remove(tmp_path.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        log_info("    unable to write lookahead cache %s\n", path.c_str());
+        std::remove(tmp_path.c_str());
+    }
+}
+
+void HimbaechelLookahead::ensure_init(const Context *ctx)
+{
+    std::call_once(init_flag, [&]() {
+        enabled = setting_or_default<bool>(ctx, "lookahead/enable", true);
+        if (!enabled)
+            return;
+        auto start = std::chrono::high_resolution_clock::now();
+        radius = std::max(1, setting_or_default<int>(ctx, "lookahead/radius", 12));
+        int samples = std::max(1, setting_or_default<int>(ctx, "lookahead/samples", 4));
+        bool use_cache = setting_or_default<bool>(ctx, "lookahead/cache", true) && !ctx->chipdb_path.empty();
+        setup_classes(ctx);
+
+        // A rebuilt chipdb is detected by its size and modification time, rather than reading the whole file
+        uint64_t db_size = 0;
+        int64_t db_mtime = 0;
+        if (use_cache) {
+            boost::system::error_code ec;
+            db_size = boost::filesystem::file_size(ctx->chipdb_path, ec);
+            if (!ec)
+                db_mtime = int64_t(boost::filesystem::last_write_time(ctx->chipdb_path, ec));
+            use_cache = !ec;
+        }
+        // Each speed grade gets its own file, named after it with anything unsafe in a file name replaced. The full
+        // name is also checked against the header, in case two names come out the same.
+        std::string speed = ctx->speed_grade ? IdString(ctx->speed_grade->name).str(ctx) : std::string();
+        std::string cache_path = ctx->chipdb_path;
+        if (!speed.empty()) {
+            cache_path += '.';
+            for (char c : speed)
+                cache_path += (std::isalnum(static_cast<unsigned char>(c)) || c == '-') ? c : '_';
+        }
+        cache_path += ".lookahead";
+        if (speed.size() >= sizeof(LookaheadCacheHeader::speed_grade))
+            use_cache = false;
+        bool loaded = use_cache && load_cache(cache_path, db_size, db_mtime, samples, speed);
+        if (!loaded) {
+            log_info("Building routing lookahead...\n");
+            build(ctx, samples);
+            if (use_cache)
+                save_cache(cache_path, db_size, db_mtime, samples, speed);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        log_info("%s routing lookahead (%d classes, radius %d) in %.02fs\n", loaded ? "Loaded" : "Built",
+                 class_count, radius, std::chrono::duration<float>(end - start).count());
+    });
+}
+
+delay_t HimbaechelLookahead::estimate(const Context *ctx, WireId src, WireId dst) const
+{
+    int sx, sy, dx, dy;
+    tile_xy(ctx->chip_info, src.tile, sx, sy);
+    tile_xy(ctx->chip_info, dst.tile, dx, dy);
+    int ox = dx - sx, oy = dy - sy;
+    if (!enabled)
+        return 100 * (std::abs(ox) + std::abs(oy) + 2);
+    int cx = std::min(std::max(ox, -radius), radius), cy = std::min(std::max(oy, -radius), radius);
+    int excess = (std::abs(ox) - std::abs(cx)) + (std::abs(oy) - std::abs(cy));
+    int32_t cls = wire_class.at(ctx->chip_info->tile_insts[src.tile].type).at(src.index);
+    bool sink = wire_is_sink.at(ctx->chip_info->tile_insts[dst.tile].type).at(dst.index);
+    uint16_t value = table[table_index(sink, cls, cx, cy)];
+    if (value == unreachable)
+        return delay_t(per_tile_delay[sink]) * (std::abs(ox) + std::abs(oy));
+    return delay_t(value) * quantum + delay_t(per_tile_delay[sink]) * excess;
+}
+
+NEXTPNR_NAMESPACE_END
@@ -0,0 +1,100 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2024  The nextpnr Authors.
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef HIMBAECHEL_LOOKAHEAD_H
+#define HIMBAECHEL_LOOKAHEAD_H
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <mutex>
+#include <vector>
+
+#include "archdefs.h"
+#include "nextpnr_namespaces.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+struct Context;
+
+/*
+Generic routing lookahead for Himbächel arches, used by the default HimbaechelAPI::estimateDelay.
+
+Wires are grouped into classes by the tile type and wire type of their node's root wire. For a few sample wires of
+each class near the centre of the device, a Dijkstra search over the routing graph (limited to a window of
+lookahead/radius tiles) records the minimum delay to reach a bel pin wire at each (dx, dy) tile offset, and separately
+the minimum delay to reach any wire. The first table is used when the destination is a bel pin wire, the second for
+any other destination, which is much less likely to overestimate. As only a few wires of each class are sampled, this
+is a heuristic rather than a strict lower bound. Estimates outside the window are extrapolated using the cheapest
+observed delay per tile.
+
+Entries are quantised to 16 bits, in units of a per-table quantum chosen so the largest delay fits, rounding down.
+
+The table only depends on the chipdb and speed grade, so it is cached next to the .bin file (as .bin.lookahead, or
+.bin.<speed>.lookahead when a speed grade is selected, keyed by the size and modification time of the .bin) and
+memory-mapped on later runs. It is set up at the start of Arch::place and
+Arch::route, before any worker threads start estimating. Setting lookahead/enable to false falls back to a plain
+manhattan distance estimate.
+*/
+
+struct HimbaechelLookahead
+{
+    // Build, or load from the cache, if not done already. Thread safe.
+    void ensure_init(const Context *ctx);
+    delay_t estimate(const Context *ctx, WireId src, WireId dst) const;
+
+  private:
+    static constexpr uint16_t unreachable = 0xFFFF;
+
+    std::once_flag init_flag;
+    // If disabled, a simple manhattan distance estimate is used instead
+    bool enabled = false;
+
+    // Per tile type, per tile wire: lookahead class
+    std::vector<std::vector<int32_t>> wire_class;
+    // Per tile type, per tile wire: whether the wire itself has bel pins
+    std::vector<std::vector<bool>> wire_is_sink;
+    int32_t class_count = 0;
+
+    int32_t radius = 0;
+    // [sink]: extrapolation delay per tile, for any wire and for bel pin wires
+    int32_t per_tile_delay[2] = {0, 0};
+    // Delay represented by one step of a table entry
+    int32_t quantum = 1;
+
+    // [sink][class][dy + radius][dx + radius]; either owned or pointing into the mapped cache file
+    std::vector<uint16_t> owned_table;
+    boost::iostreams::mapped_file_source cache_file;
+    const uint16_t *table = nullptr;
+
+    void setup_classes(const Context *ctx);
+    void build(const Context *ctx, int samples);
+    bool load_cache(const std::string &path, uint64_t db_size, int64_t db_mtime, int samples,
+                    const std::string &speed);
+    void save_cache(const std::string &path, uint64_t db_size, int64_t db_mtime, int samples,
+                    const std::string &speed) const;
+
+    size_t table_index(bool sink, int32_t cls, int dx, int dy) const
+    {
+        int dim = 2 * radius + 1;
+        return ((size_t(sink) * class_count + cls) * dim + (dy + radius)) * dim + (dx + radius);
+    }
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif
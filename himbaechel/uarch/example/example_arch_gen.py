@@ -261,7 +261,7 @@ def main():
     # Create nodes between tiles
     create_nodes(ch)
     set_timings(ch)
-    ch.write_bba(sys.argv[1])
+    ch.write(sys.argv[1])
 
 if __name__ == '__main__':
     main()
@@ -45,6 +45,7 @@ struct GateMateImpl : HimbaechelAPI
     void postRoute() override;
 
     bool isBelLocationValid(BelId bel, bool explain_invalid = false) const override;
+    void initLookahead() override {}
     delay_t estimateDelay(WireId src, WireId dst) const override;
     bool getCellDelay(const CellInfo *cell, IdString fromPort, IdString toPort, DelayQuad &delay) const override;
     TimingPortClass getPortTimingClass(const CellInfo *cell, IdString port, int &clockInfoCount) const override;
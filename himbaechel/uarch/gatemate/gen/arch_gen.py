@@ -34,7 +34,8 @@ MUX_CONFIG = 4
 parser = argparse.ArgumentParser()
 parser.add_argument("--lib", help="Project Peppercorn python database script path", type=str, required=True)
 parser.add_argument("--device", help="name of device to export", type=str, required=True)
-parser.add_argument("--bba", help="bba file to write", type=str, required=True)
+parser.add_argument("--bba", help="bba file to write (or .bin, for the assembled database)", type=str, required=True)
+parser.add_argument("--verbose", help="print build time and peak memory", action="store_true")
 args = parser.parse_args()
 
 sys.path.append(os.path.expanduser(args.lib))
@@ -200,6 +201,7 @@ def main():
     # they are starting from -2 instead of zero required for nextpnr
     dev = chip.get_device(args.device)
     ch = Chip("gatemate", args.device, dev.max_col() + 3, dev.max_row() + 3)
+    ch.verbose = args.verbose
     # Init constant ids
     ch.strs.read_constids(path.join(path.dirname(__file__), "..", "constids.inc"))
     ch.read_gfxids(path.join(path.dirname(__file__), "..", "gfxids.inc"))
@@ -284,7 +286,7 @@ def main():
             pp = pkg.create_pad(pad.name, f"X{pad.x+2}Y{pad.y+2}", pad.bel, pad.function, pad.bank, pad.flags)
             pp.extra_data = PadExtraData(pad.ddr.x+2, pad.ddr.y+2, 4 if pad.ddr.z==0 else 5)
 
-    ch.write_bba(args.bba)
+    ch.write(args.bba)
 
 if __name__ == '__main__':
     main()
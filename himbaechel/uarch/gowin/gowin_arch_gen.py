@@ -1572,6 +1572,7 @@ def main():
     parser = argparse.ArgumentParser(description='Make Gowin BBA')
     parser.add_argument('-d', '--device', required=True)
     parser.add_argument('-o', '--output', default="out.bba")
+    parser.add_argument('-v', '--verbose', action='store_true', help="print build time and peak memory")
 
     args = parser.parse_args()
 
@@ -1610,6 +1611,7 @@ def main():
     Y = db.rows;
 
     ch = Chip("gowin", device, X, Y)
+    ch.verbose = args.verbose
 
     # Init constant ids
     ch.strs.read_constids(path.join(path.dirname(__file__), "constids.inc"))
@@ -1654,6 +1656,6 @@ def main():
     create_nodes(ch, db)
     create_extra_data(ch, db, chip_flags)
     create_timing_info(ch, db)
-    ch.write_bba(args.output)
+    ch.write(args.output)
 if __name__ == '__main__':
     main()
@@ -626,7 +626,8 @@ def main():
     parser.add_argument("--db", help="Project Beyond device database path (e.g. ../prjbeyond/database)", type=str, required=True)
     parser.add_argument("--device", help="name of device to export", type=str, required=True)
     parser.add_argument("--constids", help="name of nextpnr constids file to read", type=str, default=path.join(xlbase, "constids.inc"))
-    parser.add_argument("--bba", help="bba file to write", type=str, required=True)
+    parser.add_argument("--bba", help="bba file to write (or .bin, for the assembled database)", type=str, required=True)
+    parser.add_argument("--verbose", help="print build time and peak memory", action="store_true")
     args = parser.parse_args()
 
     with open(path.join(args.db, "devices.json")) as f:
@@ -637,6 +638,7 @@ def main():
     packages = devices["families"][args.device]["packages"]
 
     ch = Chip("ng-ultra",args.device, width, height)
+    ch.verbose = args.verbose
     ch.strs.read_constids(path.join(path.dirname(__file__), "..", "constids.inc"))
 
     # Data that is depending of location
@@ -720,7 +722,7 @@ def main():
     for package in packages:
         import_package(ch, package, bels, tilegrid)
 
-    ch.write_bba(args.bba)
+    ch.write(args.bba)
 
 if __name__ == '__main__':
     main()
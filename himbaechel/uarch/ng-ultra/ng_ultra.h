@@ -62,6 +62,7 @@ struct NgUltraImpl : HimbaechelAPI
                            std::vector<std::pair<CellInfo *, BelId>> &placement) const;
 
     BoundingBox getRouteBoundingBox(WireId src, WireId dst) const override;
+    void initLookahead() override {}
     delay_t estimateDelay(WireId src, WireId dst) const override;
     delay_t predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const override;
 
@@ -269,7 +269,8 @@ def main():
     parser.add_argument("--metadata", help="nextpnr-xilinx site metadata root", type=str, default=path.join(xlbase, "meta", "artix7"))
     parser.add_argument("--device", help="name of device to export", type=str, required=True)
     parser.add_argument("--constids", help="name of nextpnr constids file to read", type=str, default=path.join(xlbase, "constids.inc"))
-    parser.add_argument("--bba", help="bba file to write", type=str, required=True)
+    parser.add_argument("--bba", help="bba file to write (or .bin, for the assembled database)", type=str, required=True)
+    parser.add_argument("--verbose", help="print build time and peak memory", action="store_true")
     args = parser.parse_args()
 
     # Init database paths
@@ -288,6 +289,7 @@ def main():
     d = xilinx_device.import_device(args.device, xraydb_root, metadata_root)
     # Init constant ids
     ch = Chip("xilinx", args.device, d.width, d.height)
+    ch.verbose = args.verbose
     ch.strs.read_constids(path.join(path.dirname(__file__), args.constids))
     ch.set_speed_grades(["DEFAULT", ]) # TODO: figure out how speed grades are supposed to work in prjxray
     # Import tile types
@@ -383,7 +385,7 @@ def main():
             pkg.create_pad(pin, f"X{site_data.tile.x}Y{site_data.tile.y}",
             f"{site_data.rel_name()}.{bel_name}",
             "", 0) # TODO: bank
-    ch.write_bba(args.bba)
+    ch.write(args.bba)
 
 if __name__ == '__main__':
     main()
@@ -173,6 +173,7 @@ struct XilinxImpl : HimbaechelAPI
     bool is_general_routing(WireId wire) const;
     void find_source_sink_locs();
 
+    void initLookahead() override {}
     delay_t estimateDelay(WireId src, WireId dst) const override;
     BoundingBox getRouteBoundingBox(WireId src, WireId dst) const override;
 
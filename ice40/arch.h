@@ -540,6 +540,9 @@ struct Arch : BaseArch<ArchRanges>
     IdString getWireType(WireId wire) const override;
     std::vector<std::pair<IdString, std::string>> getWireAttrs(WireId wire) const override;
 
+    int getWireIndexCount() const override { return chip_info->wire_data.ssize(); }
+    int getWireIndex(WireId wire) const override { return wire.index; }
+
     void bindWire(WireId wire, NetInfo *net, PlaceStrength strength) override
     {
         NPNR_ASSERT(wire != WireId());
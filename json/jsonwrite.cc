@@ -18,13 +18,16 @@
  */
 
 #include "jsonwrite.h"
-#include <assert.h>
+#include <algorithm>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <charconv>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <iterator>
 #include <log.h>
-#include <map>
 #include <string>
+#include <string_view>
 #include "nextpnr.h"
 #include "version.h"
 
@@ -32,27 +35,121 @@ NEXTPNR_NAMESPACE_BEGIN
 
 namespace JsonWriter {
 
-std::string get_string(std::string str)
+// Accumulates output in a fixed buffer and hands it to the stream in large blocks, so that writing a value never
+// needs a temporary string. Routed designs have a ROUTING attribute on every net that can add up to gigabytes, so
+// this matters more than it might appear.
+struct Writer
 {
-    std::string newstr = "\"";
-    for (char c : str) {
-        if (c == '\\')
-            newstr += c;
-        newstr += c;
+    explicit Writer(std::ostream &f) : f(f) {};
+    ~Writer() { flush(); }
+
+    Writer(const Writer &) = delete;
+    Writer &operator=(const Writer &) = delete;
+
+    void flush()
+    {
+        f.write(buf, used);
+        used = 0;
+    }
+
+    Writer &put(char c)
+    {
+        if (used == sizeof(buf))
+            flush();
+        buf[used++] = c;
+        return *this;
+    }
+
+    Writer &put(const char *s, size_t len)
+    {
+        if (len > sizeof(buf) - used) {
+            flush();
+            if (len >= sizeof(buf)) {
+                f.write(s, len);
+                return *this;
+            }
+        }
+        std::memcpy(buf + used, s, len);
+        used += len;
+        return *this;
+    }
+
+    Writer &put(const char *s) { return put(s, std::strlen(s)); }
+    Writer &put(std::string_view s) { return put(s.data(), s.size()); }
+
+    Writer &put_int(int64_t value)
+    {
+        char tmp[24];
+        auto res = std::to_chars(tmp, tmp + sizeof(tmp), value);
+        return put(tmp, res.ptr - tmp);
+    }
+
+    // A quoted string. Only backslashes are escaped, as yosys does the same for its names.
+    Writer &put_string(const char *s, size_t len)
+    {
+        put('"');
+        const char *end = s + len;
+        while (s != end) {
+            const char *bs = static_cast<const char *>(std::memchr(s, '\\', end - s));
+            if (bs == nullptr) {
+                put(s, end - s);
+                break;
+            }
+            put(s, bs + 1 - s);
+            put('\\');
+            s = bs + 1;
+        }
+        return put('"');
     }
-    return newstr + "\"";
-}
 
-std::string get_name(IdString name, Context *ctx) { return get_string(name.c_str(ctx)); }
+    Writer &put_string(std::string_view s) { return put_string(s.data(), s.size()); }
 
-void write_parameters(std::ostream &f, Context *ctx, const dict<IdString, Property> &parameters,
+    Writer &put_name(IdString name, const Context *ctx) { return put_string(name.view(ctx)); }
+
+    // Equivalent to put_string(prop.to_string())
+    Writer &put_property(const Property &prop)
+    {
+        if (!prop.is_string) {
+            put('"');
+            for (auto it = prop.str.rbegin(); it != prop.str.rend(); ++it)
+                put(*it);
+            return put('"');
+        }
+        // Literal strings that look like binary strings, optionally followed by spaces, get an extra space
+        int state = 0;
+        for (char c : prop.str) {
+            if (state == 0) {
+                if (c == '0' || c == '1' || c == 'x' || c == 'z')
+                    state = 0;
+                else if (c == ' ')
+                    state = 1;
+                else
+                    state = 2;
+            } else if (state == 1 && c != ' ')
+                state = 2;
+            if (state == 2)
+                break;
+        }
+        if (state == 2)
+            return put_string(prop.str);
+        // Strings of [01xz ] never contain a backslash
+        return put('"').put(prop.str).put(" \"");
+    }
+
+  private:
+    std::ostream &f;
+    size_t used = 0;
+    char buf[1 << 16];
+};
+
+void write_parameters(Writer &w, const Context *ctx, const dict<IdString, Property> &parameters,
                       bool for_module = false)
 {
     bool first = true;
     for (auto &param : parameters) {
-        f << stringf("%s\n", first ? "" : ",");
-        f << stringf("        %s%s: ", for_module ? "" : "    ", get_name(param.first, ctx).c_str());
-        f << get_string(param.second.to_string());
+        w.put(first ? "\n" : ",\n");
+        w.put(for_module ? "        " : "            ").put_name(param.first, ctx).put(": ");
+        w.put_property(param.second);
         first = false;
     }
 }
@@ -71,17 +168,17 @@ std::vector<PortGroup> group_ports(Context *ctx, const dict<IdString, PortInfo>
     std::vector<PortGroup> groups;
     dict<std::string, size_t> base_to_group;
     for (auto &pair : ports) {
-        std::string name = pair.second.name.str(ctx);
-        if ((name.back() != ']') || (name.find('[') == std::string::npos)) {
+        std::string_view name = pair.second.name.view(ctx);
+        if ((name.back() != ']') || (name.find('[') == std::string_view::npos)) {
             groups.push_back(
-                    {name,
+                    {std::string(name),
                      {{0, (is_cell ? (pair.second.net ? pair.second.net->name.index : -1) : pair.first.index)}},
                      {},
                      pair.second.type});
         } else {
             int off1 = int(name.find_last_of('['));
-            std::string basename = name.substr(0, off1);
-            int index = std::stoi(name.substr(off1 + 1, name.size() - (off1 + 2)));
+            std::string basename(name.substr(0, off1));
+            int index = std::stoi(std::string(name.substr(off1 + 1, name.size() - (off1 + 2))));
 
             if (!base_to_group.count(basename)) {
                 base_to_group[basename] = groups.size();
@@ -108,125 +205,125 @@ std::vector<PortGroup> group_ports(Context *ctx, const dict<IdString, PortInfo>
     return groups;
 }
 
-std::string format_port_bits(const PortGroup &port, int &dummy_idx)
+void write_port_bits(Writer &w, const PortGroup &port, int &dummy_idx)
 {
-    std::stringstream s;
-    s << "[ ";
+    w.put("[ ");
     bool first = true;
     if (port.bits.size() != 1 || port.bits.at(0) != -1) // skip single disconnected ports
         for (auto bit : port.bits) {
             if (!first)
-                s << ", ";
-            if (bit == -1)
-                s << (++dummy_idx);
-            else
-                s << bit;
+                w.put(", ");
+            w.put_int((bit == -1) ? ++dummy_idx : bit);
             first = false;
         }
-    s << " ]";
-    return s.str();
+    w.put(" ]");
 }
 
-void write_module(std::ostream &f, Context *ctx)
+const char *port_dir_str(PortType dir)
+{
+    return (dir == PORT_IN) ? "input" : (dir == PORT_INOUT) ? "inout" : "output";
+}
+
+void write_module(Writer &w, Context *ctx)
 {
     auto val = ctx->attrs.find(ctx->id("module"));
-    int dummy_idx = int(ctx->idstring_idx_to_str->size()) + 1000;
+    int dummy_idx = ctx->idstring_db.size() + 1000;
+    w.put("    ");
     if (val != ctx->attrs.end())
-        f << stringf("    %s: {\n", get_string(val->second.as_string()).c_str());
+        w.put_string(val->second.as_string());
     else
-        f << stringf("    %s: {\n", get_string("top").c_str());
-    f << stringf("      \"settings\": {");
-    write_parameters(f, ctx, ctx->settings, true);
-    f << stringf("\n      },\n");
-    f << stringf("      \"attributes\": {");
-    write_parameters(f, ctx, ctx->attrs, true);
-    f << stringf("\n      },\n");
-    f << stringf("      \"ports\": {");
+        w.put_string("top");
+    w.put(": {\n");
+    w.put("      \"settings\": {");
+    write_parameters(w, ctx, ctx->settings, true);
+    w.put("\n      },\n");
+    w.put("      \"attributes\": {");
+    write_parameters(w, ctx, ctx->attrs, true);
+    w.put("\n      },\n");
+    w.put("      \"ports\": {");
 
     auto ports = group_ports(ctx, ctx->ports);
     bool first = true;
     for (auto &port : ports) {
-        f << stringf("%s\n", first ? "" : ",");
-        f << stringf("        %s: {\n", get_string(port.name).c_str());
-        f << stringf("          \"direction\": \"%s\",\n", port.dir == PORT_IN      ? "input"
-                                                           : port.dir == PORT_INOUT ? "inout"
-                                                                                    : "output");
-        if (port.offset != 0) {
-            f << stringf("          \"offset\": %d,\n", port.offset);
-        }
-        f << stringf("          \"bits\": %s\n", format_port_bits(port, dummy_idx).c_str());
-        f << stringf("        }");
+        w.put(first ? "\n" : ",\n");
+        w.put("        ").put_string(port.name).put(": {\n");
+        w.put("          \"direction\": \"").put(port_dir_str(port.dir)).put("\",\n");
+        if (port.offset != 0)
+            w.put("          \"offset\": ").put_int(port.offset).put(",\n");
+        w.put("          \"bits\": ");
+        write_port_bits(w, port, dummy_idx);
+        w.put("\n        }");
         first = false;
     }
-    f << stringf("\n      },\n");
+    w.put("\n      },\n");
 
-    f << stringf("      \"cells\": {");
+    w.put("      \"cells\": {");
     first = true;
     for (auto &pair : ctx->cells) {
         auto &c = pair.second;
         auto cell_ports = group_ports(ctx, c->ports, true);
-        f << stringf("%s\n", first ? "" : ",");
-        f << stringf("        %s: {\n", get_name(c->name, ctx).c_str());
-        f << stringf("          \"hide_name\": %s,\n", c->name.c_str(ctx)[0] == '$' ? "1" : "0");
-        f << stringf("          \"type\": %s,\n", get_name(c->type, ctx).c_str());
-        f << stringf("          \"parameters\": {");
-        write_parameters(f, ctx, c->params);
-        f << stringf("\n          },\n");
-        f << stringf("          \"attributes\": {");
-        write_parameters(f, ctx, c->attrs);
-        f << stringf("\n          },\n");
-        f << stringf("          \"port_directions\": {");
+        w.put(first ? "\n" : ",\n");
+        w.put("        ").put_name(c->name, ctx).put(": {\n");
+        w.put("          \"hide_name\": ").put(c->name.c_str(ctx)[0] == '$' ? "1" : "0").put(",\n");
+        w.put("          \"type\": ").put_name(c->type, ctx).put(",\n");
+        w.put("          \"parameters\": {");
+        write_parameters(w, ctx, c->params);
+        w.put("\n          },\n");
+        w.put("          \"attributes\": {");
+        write_parameters(w, ctx, c->attrs);
+        w.put("\n          },\n");
+        w.put("          \"port_directions\": {");
         bool first2 = true;
         for (auto &pg : cell_ports) {
-            std::string direction = (pg.dir == PORT_IN) ? "input" : (pg.dir == PORT_OUT) ? "output" : "inout";
-            f << stringf("%s\n", first2 ? "" : ",");
-            f << stringf("            %s: \"%s\"", get_string(pg.name).c_str(), direction.c_str());
+            w.put(first2 ? "\n" : ",\n");
+            w.put("            ").put_string(pg.name).put(": \"").put(port_dir_str(pg.dir)).put('"');
             first2 = false;
         }
-        f << stringf("\n          },\n");
-        f << stringf("          \"connections\": {");
+        w.put("\n          },\n");
+        w.put("          \"connections\": {");
         first2 = true;
         for (auto &pg : cell_ports) {
-            f << stringf("%s\n", first2 ? "" : ",");
-            f << stringf("            %s: %s", get_string(pg.name).c_str(), format_port_bits(pg, dummy_idx).c_str());
+            w.put(first2 ? "\n" : ",\n");
+            w.put("            ").put_string(pg.name).put(": ");
+            write_port_bits(w, pg, dummy_idx);
             first2 = false;
         }
-        f << stringf("\n          }\n");
+        w.put("\n          }\n");
 
-        f << stringf("        }");
+        w.put("        }");
         first = false;
     }
 
-    f << stringf("\n      },\n");
+    w.put("\n      },\n");
 
-    f << stringf("      \"netnames\": {");
+    w.put("      \"netnames\": {");
     first = true;
     for (auto &pair : ctx->nets) {
-        auto &w = pair.second;
-        f << stringf("%s\n", first ? "" : ",");
-        f << stringf("        %s: {\n", get_name(w->name, ctx).c_str());
-        f << stringf("          \"hide_name\": %s,\n", w->name.c_str(ctx)[0] == '$' ? "1" : "0");
-        f << stringf("          \"bits\": [ %d ] ,\n", pair.first.index);
-        f << stringf("          \"attributes\": {");
-        write_parameters(f, ctx, w->attrs);
-        f << stringf("\n          }\n");
-        f << stringf("        }");
+        auto &ni = pair.second;
+        w.put(first ? "\n" : ",\n");
+        w.put("        ").put_name(ni->name, ctx).put(": {\n");
+        w.put("          \"hide_name\": ").put(ni->name.c_str(ctx)[0] == '$' ? "1" : "0").put(",\n");
+        w.put("          \"bits\": [ ").put_int(pair.first.index).put(" ] ,\n");
+        w.put("          \"attributes\": {");
+        write_parameters(w, ctx, ni->attrs);
+        w.put("\n          }\n");
+        w.put("        }");
         first = false;
     }
 
-    f << stringf("\n      }\n");
-    f << stringf("    }");
+    w.put("\n      }\n");
+    w.put("    }");
 }
 
 void write_context(std::ostream &f, Context *ctx)
 {
-    f << stringf("{\n");
-    f << stringf("  \"creator\": %s,\n",
-                 get_string("Next Generation Place and Route (Version " GIT_DESCRIBE_STR ")").c_str());
-    f << stringf("  \"modules\": {\n");
-    write_module(f, ctx);
-    f << stringf("\n  }");
-    f << stringf("\n}\n");
+    Writer w(f);
+    w.put("{\n");
+    w.put("  \"creator\": ").put_string("Next Generation Place and Route (Version " GIT_DESCRIBE_STR ")").put(",\n");
+    w.put("  \"modules\": {\n");
+    write_module(w, ctx);
+    w.put("\n  }");
+    w.put("\n}\n");
 }
 
 }; // End Namespace JsonWriter
@@ -245,4 +342,22 @@ bool write_json_file(std::ostream &f, std::string &filename, Context *ctx)
     }
 }
 
+bool write_json_file(std::string &filename, Context *ctx)
+{
+    std::ofstream out(filename, std::ios::binary);
+    if (filename.size() > 3 && filename.compare(filename.size() - 3, 3, ".gz") == 0) {
+        namespace io = boost::iostreams;
+        if (!out)
+            return write_json_file(out, filename, ctx);
+        io::filtering_ostream f;
+        f.push(io::gzip_compressor());
+        f.push(out);
+        bool result = write_json_file(f, filename, ctx);
+        // Flushes the compressor and writes the gzip trailer
+        f.reset();
+        return result;
+    }
+    return write_json_file(out, filename, ctx);
+}
+
 NEXTPNR_NAMESPACE_END
@@ -27,6 +27,8 @@
 NEXTPNR_NAMESPACE_BEGIN
 
 extern bool write_json_file(std::ostream &, std::string &, Context *);
+// Writes to the named file, gzip compressed if the name ends in .gz
+extern bool write_json_file(std::string &, Context *);
 
 NEXTPNR_NAMESPACE_END
 
@@ -703,6 +703,9 @@ struct Arch : BaseArch<ArchRanges>
         return i;
     }
 
+    int getWireIndexCount() const override { return int(wire2net.size()); }
+    int getWireIndex(WireId wire) const override { return get_wire_vecidx(wire); }
+
     void bindWire(WireId wire, NetInfo *net, PlaceStrength strength) override
     {
         NPNR_ASSERT(wire != WireId());
@@ -41,7 +41,7 @@ struct TCLEntity
     TCLEntity(EntityType type, IdString name) : type(type), name(name) {}
     TCLEntity(EntityType type, IdString name, IdString pin) : type(type), name(name), pin(pin) {}
 
-    const std::string &to_string(Context *ctx) { return name.str(ctx); }
+    std::string to_string(Context *ctx) { return name.str(ctx); }
 
     CellInfo *get_cell(Context *ctx) const
     {
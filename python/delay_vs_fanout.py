@@ -1,10 +1,16 @@
+users = ctx.getNetUserTable()
+nets = ctx.getNetTable()
+cells = ctx.getCellTable()
+fanout = memoryview(nets["users"])
+driver = memoryview(nets["driver_cell"])
+delay = memoryview(users["route_delay"])
+cell_type = ctx.getIdStrings(cells["type"])
+
 with open("delay_vs_fanout.csv", "w") as f:
     print("fanout,delay", file=f)
-    for net_name, net in ctx.nets:
-        if net.driver.cell is None:
+    for i, net in enumerate(memoryview(users["net"])):
+        if driver[net] == -1:
             continue
-        if net.driver.cell.type == "DCCA":
+        if cell_type[driver[net]] == "DCCA":
             continue # ignore global clocks
-        for user in net.users:
-            print(f"{len(net.users)},{ctx.getNetinfoRouteDelay(net, user)}", file=f)
-
+        print(f"{fanout[net]},{delay[i]}", file=f)